@@ -13,6 +13,8 @@ using json = nlohmann::json;
 extern int maxSpeed;
 extern int etcsDialMaxSpeed;
 extern std::string stm_layout_file;
+extern int target_fps;
+extern bool log_frame_stats;
 void load_config(std::string serie)
 {
 #ifdef __ANDROID__
@@ -33,6 +35,12 @@ void load_config(std::string serie)
         if (cfg.contains("STMLayout")) {
             stm_layout_file = cfg["STMLayout"];
         }
+        if (cfg.contains("FrameRate")) {
+            target_fps = cfg["FrameRate"];
+        }
+        if (cfg.contains("FrameStatistics")) {
+            log_frame_stats = cfg["FrameStatistics"];
+        }
     }
     maxSpeed = etcsDialMaxSpeed;
 }
\ No newline at end of file
@@ -63,120 +63,188 @@ void setup_areas()
     areas["G12"] = {397, 415, 120, 50};
     areas["G13"] = {517, 415, 63, 50};
 }
-ntc_window::ntc_window(int nid_stm) : nid_stm(nid_stm)
+/*
+ * STM layouts are read from stm_layout_file once, and each one is only
+ * converted, with its sounds loaded, when its STM first shows a window.
+ */
+static customized_dmi *get_customized_dmi(int nid_stm)
 {
-    #ifdef __ANDROID__
-    extern std::string filesDir;
-    std::ifstream file(filesDir+"/"+stm_layout_file);
+    static bool loaded = false;
+    static std::map<int, json> layouts;
+    static std::map<int, customized_dmi*> customized;
+    if (!loaded)
+    {
+        loaded = true;
+#ifdef __ANDROID__
+        extern std::string filesDir;
+        std::ifstream file(filesDir+"/"+stm_layout_file);
 #else
-    std::ifstream file(stm_layout_file);
+        std::ifstream file(stm_layout_file);
 #endif
-    json j;
-    file >> j;
-    for (json &stm : j["STM"])
-    {
-        if (stm["nid_stm"].get<int>() == nid_stm)
+        json j;
+        file >> j;
+        for (json &stm : j["STM"])
         {
-            customized = new customized_dmi(stm);
-            break;
+            int nid = stm["nid_stm"].get<int>();
+            if (layouts.find(nid) == layouts.end())
+                layouts[nid] = stm;
         }
     }
-    constructfun = [this](window *w) {construct_main(w, customized != nullptr);};
+    auto it = customized.find(nid_stm);
+    if (it != customized.end())
+        return it->second;
+    auto layout = layouts.find(nid_stm);
+    customized_dmi *c = layout == layouts.end() ? nullptr : new customized_dmi(layout->second);
+    customized[nid_stm] = c;
+    return c;
 }
-void ntc_window::display_indicator(int id, int position, int icon, std::string text, int properties, bool isButton)
+ntc_window::ntc_window(int nid_stm) : nid_stm(nid_stm)
 {
-    auto it = indicators.find((isButton ? 256 : 0) + id);
-    if (it != indicators.end()) {
-        remove(it->second);
-        delete it->second;
-        indicators.erase(it);
+    customized = get_customized_dmi(nid_stm);
+    constructfun = [this](window *w) {
+        construct_main(w, customized != nullptr);
+        // Reconstructing the window must not lose the indicators being shown
+        for (auto &kvp : indicators)
+        {
+            if (kvp.second.shown)
+                addToLayout(kvp.second.comp, new RelativeAlignment(nullptr, kvp.second.pos[0], kvp.second.pos[1]));
+        }
+    };
+}
+bool ntc_window::indicator_position(int position, bool isButton, std::vector<int> &pos)
+{
+    if (customized != nullptr)
+    {
+        auto &positions = isButton ? customized->button_positions : customized->positions;
+        auto it = positions.find(position);
+        if (it == positions.end())
+            return false;
+        pos = it->second;
+        return true;
     }
+    std::string area;
+    if (position < 4)
+        area = "B"+std::to_string(position+2);
+    else if (position == 4)
+        area = "H1";
+    else if (position < 10)
+        area = "C"+std::to_string(position-3);
+    else if (position < 20)
+        area = "G"+std::to_string(position-9);
+    /*{
+        if (position < 3)
+            area = "F"+std::to_string(position+7);
+        else if (position < 8)
+            area = "C"+std::to_string(position-1);
+        else if (position < 18)
+            area = "G"+std::to_string(position-7);
+    }*/
+    auto it = areas.find(area);
+    if (it == areas.end())
+        return false;
+    pos = it->second;
+    return true;
+}
+std::shared_ptr<sdl_texture> ntc_window::get_text_texture(int key, const std::string &text, int properties, float size, Color fg, int align)
+{
+    auto k = std::make_tuple(key, text, properties);
+    auto it = text_textures.find(k);
+    if (it != text_textures.end())
+        return it->second;
+    // Captions only take a few values per indicator, so this is rarely hit
+    if (text_textures.size() >= 256)
+        text_textures.clear();
+    auto tex = Component::getTextGraphic(text, size, fg, 0, align);
+    text_textures[k] = tex;
+    return tex;
+}
+void ntc_window::display_indicator(int id, int position, int icon, std::string text, int properties, bool isButton)
+{
+    int key = (isButton ? 256 : 0) + id;
+    auto it = indicators.find(key);
     bool displayed = (properties>>9)&1;
-    if (!displayed)
-        return;
     std::vector<int> pos;
-    if (customized != nullptr)
+    if (!displayed || !indicator_position(position, isButton, pos))
     {
-        if (isButton)
+        if (it != indicators.end() && it->second.shown)
         {
-            if (customized->button_positions.find(position) == customized->button_positions.end())
-                return;
-            pos = customized->button_positions[position];
-        }
-        else
-        {
-            if (customized->positions.find(position) == customized->positions.end())
-                return;
-            pos = customized->positions[position];
+            remove(it->second.comp);
+            it->second.shown = false;
         }
+        return;
+    }
+    stm_indicator &ind = indicators[key];
+    if (ind.shown && ind.position == position && ind.icon == icon && ind.properties == properties && ind.text == text)
+        return;
+    Component *c = ind.comp;
+    if (c == nullptr)
+    {
+        if (isButton) c = new Button(pos[2], pos[3]);
+        else c = new Component(pos[2],pos[3]);
+        ind.comp = c;
     }
     else
     {
-        std::string area;
-        if (position < 4)
-            area = "B"+std::to_string(position+2);
-        else if (position == 4)
-            area = "H1";
-        else if (position < 10)
-            area = "C"+std::to_string(position-3);
-        else if (position < 20)
-            area = "G"+std::to_string(position-9);
-        /*{
-            if (position < 3)
-                area = "F"+std::to_string(position+7);
-            else if (position < 8)
-                area = "C"+std::to_string(position-1);
-            else if (position < 18)
-                area = "G"+std::to_string(position-7);
-        }*/
-        if (areas.find(area) == areas.end())
-            return;
-        pos = areas[area];
+        c->clear();
+        c->setSize(pos[2], pos[3]);
     }
-    Component *c;
-    if (isButton) c = new Button(pos[2], pos[3]);
-    else c = new Component(pos[2],pos[3]);
+    ind.position = position;
+    ind.icon = icon;
+    ind.properties = properties;
+    ind.text = text;
     Color bg = get_color((properties>>3)&7, true);
     Color fg = get_color(properties&7, false);
     c->setBackgroundColor(bg);
     c->setForegroundColor(fg);
-    bool text_also;
     if (customized != nullptr)
     {
         bool text_also = true;
-        if (icon > 0 && customized->icons.find(icon) != customized->icons.end())
+        auto ic = icon > 0 ? customized->icons.find(icon) : customized->icons.end();
+        if (ic != customized->icons.end())
         {
-            auto &ic = customized->icons[icon];
-            text_also = ic.text_also;
-            c->addImage("symbols/STM/"+ic.file);
+            text_also = ic->second.text_also;
+            std::string path = "symbols/STM/"+ic->second.file;
+            auto tex = icons.find(icon);
+            if (tex == icons.end())
+                tex = icons.insert({icon, Component::getImageGraphic(path)}).first;
+            if (tex->second != nullptr)
+                c->addImage(tex->second, path);
         }
         if (text_also && text.size() > 0)
         {
-            customized_dmi::indicator ind;
-            ind.font_size = 12;
-            ind.align = CENTER;
-            if (customized != nullptr)
-            {
-                if (!isButton && customized->indicators.find(id) != customized->indicators.end()) ind = customized->indicators[id];
-                else if (isButton && customized->buttons.find(id) != customized->buttons.end()) ind = customized->buttons[id];
-            }
-            c->addText(text, 0, 0, ind.font_size, fg, ind.align);
+            customized_dmi::indicator style;
+            style.font_size = 12;
+            style.align = CENTER;
+            auto &styles = isButton ? customized->buttons : customized->indicators;
+            auto custom = styles.find(id);
+            if (custom != styles.end()) style = custom->second;
+            c->addText(get_text_texture(key, text, properties, style.font_size, fg, style.align), text, 0, 0, style.font_size, fg, style.align);
         }
     }
     else
     {
         if (text.size() > 0)
-            c->addText(text, 0, 0, 12, fg);
+            c->addText(get_text_texture(key, text, properties, 12, fg, CENTER), text, 0, 0, 12, fg);
     }
     bool counterflash = (properties>>8)&1;
     int flash = (properties>>6)&3;
+    c->flash_style = 0;
     if (flash != 0)
     {
         c->flash_style = (flash-1) | (counterflash<<1);
         if (customized != nullptr && customized->flash_style == 1) c->flash_style |= 4;
     }
-    indicators[id] = c;
-    addToLayout(c, new RelativeAlignment(nullptr, pos[0], pos[1]));
+    if (ind.shown && ind.pos != pos)
+    {
+        remove(c);
+        ind.shown = false;
+    }
+    if (!ind.shown)
+    {
+        ind.pos = pos;
+        ind.shown = true;
+        addToLayout(c, new RelativeAlignment(nullptr, pos[0], pos[1]));
+    }
 }
 void ntc_window::display_text(int id, bool ack, std::string text, int properties)
 {
@@ -242,20 +310,7 @@ void parse_stm_message(const stm_message &message)
             STMButtonRequest &buttons = *((STMButtonRequest*)pack.get());
             for (auto &button : buttons.elements)
             {
-                std::string text;
-                for (int i=0; i<button.X_CAPTION.size(); i++)
-                {
-                    unsigned char c = button.X_CAPTION[i];
-                    if (button.X_CAPTION[i] < 0x80)
-                    {
-                        text += c;
-                    }
-                    else
-                    {
-                        text += 0xc2+(c>0xbf);
-                        text += (c&0x3f)+0x80;
-                    }
-                }
+                std::string text = X_CAPTION_t::getUTF8(button.X_CAPTION);
                 window->display_indicator(button.NID_BUTTON, button.NID_BUTPOS, button.NID_ICON, text, button.M_BUT_ATTRIB, true);
             }
             /*for (auto &var : r.log_entries)
@@ -268,20 +323,7 @@ void parse_stm_message(const stm_message &message)
             STMIconRequest &icons = *((STMIconRequest*)pack.get());
             for (auto &icon : icons.elements)
             {
-                std::string text;
-                for (int i=0; i<icon.X_CAPTION.size(); i++)
-                {
-                    unsigned char c = icon.X_CAPTION[i];
-                    if (icon.X_CAPTION[i] < 0x80)
-                    {
-                        text += c;
-                    }
-                    else
-                    {
-                        text += 0xc2+(c>0xbf);
-                        text += (c&0x3f)+0x80;
-                    }
-                }
+                std::string text = X_CAPTION_t::getUTF8(icon.X_CAPTION);
                 window->display_indicator(icon.NID_INDICATOR, icon.NID_INDPOS, icon.NID_ICON, text, icon.M_IND_ATTRIB, false);
             }
             /*for (auto &var : r.log_entries)
@@ -292,20 +334,7 @@ void parse_stm_message(const stm_message &message)
         else if (pack->NID_PACKET == 38)
         {
             STMTextMessage &msg = *((STMTextMessage*)pack.get());
-            std::string text;
-            for (int i=0; i<msg.X_TEXT.size(); i++)
-            {
-                unsigned char c = msg.X_TEXT[i];
-                if (msg.X_TEXT[i] < 0x80)
-                {
-                    text += c;
-                }
-                else
-                {
-                    text += 0xc2+(c>0xbf);
-                    text += (c&0x3f)+0x80;
-                }
-            }
+            std::string text = X_TEXT_t::getUTF8(msg.X_TEXT);
             window->display_text(msg.NID_XMESSAGE.rawdata, msg.Q_ACK == Q_ACK_t::AcknowledgementRequired, text, msg.M_XATTRIBUTE.rawdata);
         }
         else if (pack->NID_PACKET == 39)
@@ -325,14 +354,13 @@ void parse_stm_message(const stm_message &message)
                 {
                     if (window->customized != nullptr && window->customized->sounds.find(snd.NID_SOUND) != window->customized->sounds.end())
                     {
-                        stopSound(window->customized->sounds[snd.NID_SOUND]);
+                        stopSound(window->customized->sounds[snd.NID_SOUND], window);
                     }
                     for (auto it = window->generated_sounds.begin(); it != window->generated_sounds.end();)
                     {
                         if (it->first == snd.NID_SOUND)
                         {
-                            stopSound(it->second);
-                            delete it->second;
+                            stopSound(it->second, window);
                             it = window->generated_sounds.erase(it);
                             continue;
                         }
@@ -349,9 +377,11 @@ void parse_stm_message(const stm_message &message)
                     else
                     {
                         s = loadSound(snd);
+                        // Tones are shared, a retriggered one must not be stopped as an old one
+                        window->generated_sounds.remove_if([s](const std::pair<int, sdlsounddata*> &gen) { return gen.second == s; });
                         window->generated_sounds.push_front({snd.NID_SOUND, s});
                     }
-                    play(s, snd.Q_SOUND == Q_SOUND_t::PlayContinuously);
+                    play(s, snd.Q_SOUND == Q_SOUND_t::PlayContinuously, window);
                 }
             }
             int count = 0;
@@ -360,8 +390,7 @@ void parse_stm_message(const stm_message &message)
                 count++;
                 if (count > 2)
                 {
-                    stopSound(it->second);
-                    delete it->second;
+                    stopSound(it->second, window);
                     it = window->generated_sounds.erase(it);
                     continue;
                 }
@@ -8,6 +8,7 @@
  */
 #pragma once
 #include <list>
+#include <tuple>
 #include "../graphics/color.h"
 #include "../graphics/button.h"
 #include "../graphics/component.h"
@@ -142,11 +143,28 @@ struct customized_dmi
         }
     }
 };
+/*
+ * Indicators and buttons are kept while the window exists and updated
+ * in place, so repeating an unchanged request does nothing.
+ */
+struct stm_indicator
+{
+    Component *comp = nullptr;
+    bool shown = false;
+    int position = -1;
+    int icon = -1;
+    int properties = -1;
+    std::string text;
+    std::vector<int> pos;
+};
 class ntc_window : public window
 {
     int nid_stm;
-    std::map<int, Component*> indicators;
+    std::map<int, stm_indicator> indicators;
     std::map<int, std::shared_ptr<sdl_texture>> icons;
+    std::map<std::tuple<int, std::string, int>, std::shared_ptr<sdl_texture>> text_textures;
+    bool indicator_position(int position, bool isButton, std::vector<int> &pos);
+    std::shared_ptr<sdl_texture> get_text_texture(int key, const std::string &text, int properties, float size, Color fg, int align);
     public:
     stm_state state;
     int64_t last_time;
@@ -184,18 +202,26 @@ class ntc_window : public window
     {
         for (auto &it : indicators)
         {
-            delete it.second;
+            delete it.second.comp;
         }
         for (auto &it : messages)
         {
             revokeMessage(it.second.Id);
         }
+        // Sounds may be shared with other windows, only those started
+        // by this one are stopped
         for (auto &snd : generated_sounds)
         {
-            stopSound(snd.second);
-            delete snd.second;
+            stopSound(snd.second, this);
+        }
+        // The layout is shared by all the windows of this STM
+        if (customized != nullptr)
+        {
+            for (auto &kvp : customized->sounds)
+            {
+                stopSound(kvp.second, this);
+            }
         }
-        if (customized != nullptr) delete customized;
     }
 };
 extern ntc_window *active_ntc_window;
@@ -94,9 +94,14 @@ class Component
     void add(graphic* g) { graphics.push_back(g); }
     void addText(std::string text, float x=0, float y=0, float size=12, Color col=White, int align=CENTER, int aspect=0);
     text_graphic *getText(std::string text, float x=0, float y=0, float size=12, Color col=White, int align=CENTER, int aspect=0);
+    // Same as above with an already rendered texture
+    void addText(std::shared_ptr<sdl_texture> tex, std::string text, float x=0, float y=0, float size=12, Color col=White, int align=CENTER, int aspect=0);
+    text_graphic *getText(std::shared_ptr<sdl_texture> tex, std::string text, float x=0, float y=0, float size=12, Color col=White, int align=CENTER, int aspect=0);
     static std::shared_ptr<sdl_texture> getTextGraphic(std::string text, float size, Color col, int aspect, int align=CENTER);
     void addImage(std::string path, float cx=0, float cy=0, float sx=0, float sy=0);
     image_graphic *getImage(std::string path, float cx=0, float cy=0, float sx=0, float sy=0);
+    void addImage(std::shared_ptr<sdl_texture> tex, std::string path, float cx=0, float cy=0, float sx=0, float sy=0);
+    image_graphic *getImage(std::shared_ptr<sdl_texture> tex, std::string path, float cx=0, float cy=0, float sx=0, float sy=0);
     static std::shared_ptr<sdl_texture> getImageGraphic(std::string path);
     void setBackgroundColor(Color c);
     void setForegroundColor(Color c);
@@ -25,7 +25,6 @@ extern Color renderColor;
 int getScale(float val);
 float getAntiScale(float val);
 void startDisplay(bool fullscreen);
-void display();
 void quitDisplay();
 void clear();
 void setColor(Color color);
@@ -33,4 +32,6 @@ TTF_Font *openFont(std::string text, float size);
 void getFontSize(TTF_Font *font, const char *str, float *width, float *height);
 void init_video();
 void loop_video();
+extern int target_fps;
+extern bool log_frame_stats;
 #endif
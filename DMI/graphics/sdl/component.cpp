@@ -222,7 +222,16 @@ void Component::addText(string text, float x, float y, float size, Color col, in
     if(text=="") return;
     add(getText(text, x, y, size, col, align, aspect));
 }
+void Component::addText(std::shared_ptr<sdl_texture> tex, string text, float x, float y, float size, Color col, int align, int aspect)
+{
+    if(text=="") return;
+    add(getText(tex, text, x, y, size, col, align, aspect));
+}
 text_graphic* Component::getText(string text, float x, float y, float size, Color col, int align, int aspect)
+{
+    return getText(getTextGraphic(text, size, col, aspect, align), text, x, y, size, col, align, aspect);
+}
+text_graphic* Component::getText(std::shared_ptr<sdl_texture> tex, string text, float x, float y, float size, Color col, int align, int aspect)
 {
     text_graphic *t = new text_graphic();
     t->text = text;
@@ -232,8 +241,7 @@ text_graphic* Component::getText(string text, float x, float y, float size, Colo
     t->color = col;
     t->alignment = align;
     t->aspect = aspect;
-    int v = text.find('\n');
-    t->tex = getTextGraphic(text, size, col, aspect, align);
+    t->tex = tex;
     float sx = t->tex == nullptr ? 0 : getAntiScale(t->tex->width);
     float sy = t->tex == nullptr ? 0 : getAntiScale(t->tex->height);
     if (align & UP) y = y + sy / 2;
@@ -267,11 +275,19 @@ void Component::addImage(string path, float cx, float cy, float sx, float sy)
 {
     add(getImage(path, cx, cy, sx, sy));
 }
+void Component::addImage(std::shared_ptr<sdl_texture> tex, string path, float cx, float cy, float sx, float sy)
+{
+    add(getImage(tex, path, cx, cy, sx, sy));
+}
 image_graphic *Component::getImage(string path, float cx, float cy, float sx, float sy)
+{
+    return getImage(getImageGraphic(path), path, cx, cy, sx, sy);
+}
+image_graphic *Component::getImage(std::shared_ptr<sdl_texture> tex, string path, float cx, float cy, float sx, float sy)
 {
     image_graphic *ig = new image_graphic();
     ig->path = path;
-    ig->tex = getImageGraphic(ig->path);
+    ig->tex = tex;
     if(sx > 0 && sy > 0)
     {
         ig->width = sx;
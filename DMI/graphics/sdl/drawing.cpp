@@ -58,83 +58,151 @@ void init_video()
     }
     start_sound();
 }
+/*
+ * Frame scheduling. Input is handled as soon as it arrives while waiting
+ * for the next frame, pending commands are applied once right before
+ * drawing, and frames start at a fixed period. A late frame skips the
+ * periods it overran instead of slowing down all the following ones.
+ */
+int target_fps = 20;
+bool log_frame_stats = false;
+// Time between vertical blanks, or zero if unknown or vsync is off
+static std::chrono::microseconds vsync_period(0);
+struct frame_statistics
+{
+    int frames = 0;
+    int late = 0;
+    int64_t events = 0;
+    double update_ms = 0;
+    double render_ms = 0;
+    double present_ms = 0;
+    double max_frame_ms = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+static frame_statistics frame_stats;
+static void report_frame_stats()
+{
+    frame_statistics &s = frame_stats;
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - s.start).count();
+    if (log_frame_stats && s.frames > 0)
+    {
+        printf("DMI frames: %.1f fps (target %d), %d late, %lld events; update %.2f ms, render %.2f ms, present %.2f ms, max frame %.2f ms\n",
+            s.frames/elapsed, target_fps, s.late, (long long)s.events, s.update_ms/s.frames, s.render_ms/s.frames, s.present_ms/s.frames, s.max_frame_ms);
+    }
+    s = frame_statistics();
+}
+static void handle_event(SDL_Event &ev)
+{
+    frame_stats.events++;
+    if(ev.type == SDL_QUIT || ev.type == SDL_WINDOWEVENT_CLOSE)
+    {
+        quit();
+        return;
+    }
+    if (ev.type == SDL_MOUSEBUTTONDOWN || ev.type == SDL_MOUSEBUTTONUP || ev.type == SDL_MOUSEMOTION /*|| ev.type == SDL_FINGERDOWN || ev.type == SDL_FINGERUP || ev.type == SDL_FINGERMOTION*/) {
+        float scrx;
+        float scry;
+        bool pressed;
+        if (ev.type == SDL_FINGERDOWN || ev.type == SDL_FINGERUP || ev.type == SDL_FINGERMOTION)
+        {
+            SDL_TouchFingerEvent tfe = ev.tfinger;
+            if (ev.type == SDL_FINGERMOTION) pressed = tfe.pressure>0;
+            else pressed = ev.type == SDL_FINGERDOWN;
+            scrx = tfe.x;
+            scry = tfe.y;
+        }
+        else if (ev.type == SDL_MOUSEMOTION)
+        {
+            SDL_MouseMotionEvent mme = ev.motion;
+            pressed = mme.state == SDL_PRESSED;
+            scrx = mme.x;
+            scry = mme.y;
+        }
+        else
+        {
+            SDL_MouseButtonEvent mbe = ev.button;
+            pressed = mbe.state == SDL_PRESSED;
+            scrx = mbe.x;
+            scry = mbe.y;
+        }
+        float x = (scrx - offset[0]) / scale;
+        float y = scry / scale;
+        vector<window *> windows;
+        unique_lock<mutex> lck(draw_mtx);
+        for (auto it = active_windows.begin(); it != active_windows.end(); ++it)
+        {
+            windows.push_back(*it);
+        }
+        for (int i = 0; i < windows.size(); i++)
+        {
+            if (windows[i]->active) windows[i]->event(pressed, x, y);
+            else windows[i]->event(0, -100, -100);
+        }
+    }
+}
 void loop_video()
 {
+    using clock = std::chrono::steady_clock;
+    auto next_frame = clock::now();
     while(running)
     {
-        auto prev = std::chrono::system_clock::now();
         SDL_Event ev;
-        while(SDL_PollEvent(&ev) != 0)
+        while (running)
         {
-			if(ev.type == SDL_QUIT || ev.type == SDL_WINDOWEVENT_CLOSE)
-            {
-                quit();
+            auto now = clock::now();
+            if (now >= next_frame)
                 break;
+            int wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_frame - now).count() + 1;
+            if (SDL_WaitEventTimeout(&ev, wait))
+            {
+                handle_event(ev);
+                while (running && SDL_PollEvent(&ev) != 0)
+                    handle_event(ev);
             }
-            if (ev.type == SDL_MOUSEBUTTONDOWN || ev.type == SDL_MOUSEBUTTONUP || ev.type == SDL_MOUSEMOTION /*|| ev.type == SDL_FINGERDOWN || ev.type == SDL_FINGERUP || ev.type == SDL_FINGERMOTION*/) {
-				float scrx;
-				float scry;
-				bool pressed;
-				if (ev.type == SDL_FINGERDOWN || ev.type == SDL_FINGERUP || ev.type == SDL_FINGERMOTION)
-				{
-					SDL_TouchFingerEvent tfe = ev.tfinger;
-					if (ev.type == SDL_FINGERMOTION) pressed = tfe.pressure>0;
-					else pressed = ev.type == SDL_FINGERDOWN;
-					scrx = tfe.x;
-					scry = tfe.y;
-				}
-				else if (ev.type == SDL_MOUSEMOTION)
-				{
-					SDL_MouseMotionEvent mme = ev.motion;
-					pressed = mme.state == SDL_PRESSED;
-					scrx = mme.x;
-					scry = mme.y;
-				}
-				else
-				{
-					SDL_MouseButtonEvent mbe = ev.button;
-					pressed = mbe.state == SDL_PRESSED;
-					scrx = mbe.x;
-					scry = mbe.y;
-				}
-				extern float scale;
-				extern float offset[2];
-				float x = (scrx - offset[0]) / scale;
-				float y = scry / scale;
-				vector<window *> windows;
-				unique_lock<mutex> lck(draw_mtx);
-				for (auto it = active_windows.begin(); it != active_windows.end(); ++it)
-				{
-					windows.push_back(*it);
-				}
-				for (int i = 0; i < windows.size(); i++)
-				{
-					if (windows[i]->active) windows[i]->event(pressed, x, y);
-                    else windows[i]->event(0, -100, -100);
-				}
-			}
         }
+        while (running && SDL_PollEvent(&ev) != 0)
+            handle_event(ev);
         if (!running) break;
+        auto frame_start = clock::now();
         void update_stm_windows();
+        void update_planning();
         unique_lock<mutex> lck(draw_mtx);
         updateDrawCommands();
         update_stm_windows();
+        update_planning();
         lck.unlock();
-        display();
+        auto updated = clock::now();
+        clear();
+        lck.lock();
+        displayETCS();
+        lck.unlock();
+        auto rendered = clock::now();
+        SDL_RenderPresent(sdlren);
+        auto presented = clock::now();
+
+        frame_statistics &s = frame_stats;
+        s.frames++;
+        s.update_ms += std::chrono::duration<double, std::milli>(updated - frame_start).count();
+        s.render_ms += std::chrono::duration<double, std::milli>(rendered - updated).count();
+        s.present_ms += std::chrono::duration<double, std::milli>(presented - rendered).count();
+        s.max_frame_ms = std::max(s.max_frame_ms, std::chrono::duration<double, std::milli>(presented - frame_start).count());
+        if (presented - s.start > std::chrono::seconds(10))
+            report_frame_stats();
 
-        std::chrono::duration<double> diff = std::chrono::system_clock::now() - prev;
-        int d = std::chrono::duration_cast<std::chrono::duration<int, std::milli>>(diff).count();
-        int time = 50 - d;
-        if (time < 30)
+        auto period = std::chrono::microseconds(1000000/std::max(target_fps, 1));
+        if (period <= vsync_period)
         {
-            time = 125 - d;
-            if (time < 60)
-            {
-                time = 250 - d;
-                if (time < 100) time = 2*d;
-            }
+            // Presenting already waits for the display
+            next_frame = presented;
+            continue;
+        }
+        next_frame += period;
+        if (next_frame < presented)
+        {
+            s.late++;
+            while (next_frame < presented)
+                next_frame += period;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(time));
     }
     quitDisplay();
 }
@@ -157,6 +225,10 @@ void startDisplay(bool fullscreen)
         running = false;
         return;
     }
+    SDL_RendererInfo info;
+    SDL_DisplayMode dm;
+    if (SDL_GetRendererInfo(sdlren, &info) == 0 && (info.flags & SDL_RENDERER_PRESENTVSYNC) && SDL_GetWindowDisplayMode(sdlwin, &dm) == 0 && dm.refresh_rate > 0)
+        vsync_period = std::chrono::microseconds(1000000/dm.refresh_rate);
     int w,h;
     SDL_GetWindowSize(sdlwin, &w, &h);
     float scrsize[] = {(float)w,(float)h};
@@ -165,14 +237,6 @@ void startDisplay(bool fullscreen)
     scale = scrsize[1]/480.0;
     //SDL_SetWindowBordered(sdlwin, SDL_FALSE);
 }
-void display()
-{
-    clear();
-    unique_lock<mutex> lck(draw_mtx);
-    displayETCS();
-    lck.unlock();
-    SDL_RenderPresent(sdlren);
-}
 void quitDisplay()
 {
     SDL_DestroyRenderer(sdlren);
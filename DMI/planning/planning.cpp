@@ -10,6 +10,8 @@
 #include "../graphics/component.h"
 #include "../monitor.h"
 #include <string>
+#include <map>
+#include <cmath>
 #include "../graphics/icon_button.h"
 #include "../window/window.h"
 #include "../graphics/display.h"
@@ -30,12 +32,24 @@ extern bool showSpeeds;
 void displayScaleUp();
 void displayScaleDown();
 void speedLines();
+// Scale being displayed, which follows planning_scale during a zoom transition
+static float shown_scale = 1;
+static float zoom_from = 1;
+static int64_t zoom_start = -1;
+const int zoom_duration = 250;
+int64_t get_milliseconds();
+static void build_planning_lut(float scale);
+static void start_zoom()
+{
+    zoom_from = shown_scale;
+    zoom_start = get_milliseconds();
+}
 void zoominp()
 {
     if(planning_scale>1)
     {
         planning_scale/=2;
-        speedLines();
+        start_zoom();
     }
 }
 void zoomoutp()
@@ -43,12 +57,14 @@ void zoomoutp()
     if(planning_scale<=16)
     {
         planning_scale*=2;
-        speedLines();
+        start_zoom();
     }
 }
 IconButton zoomin("symbols/Navigation/NA_03.bmp",40,15,zoominp);
 IconButton zoomout("symbols/Navigation/NA_04.bmp",40,15,zoomoutp);
 std::vector<planning_element> planning_elements;
+// Furthest distance shown at the current scale
+static float planning_range = divs[8];
 void displayPlanning()
 {
     for(int i=0; i<9; i++)
@@ -65,12 +81,12 @@ void displayObjects()
     for(int i = 0; i < planning_elements.size(); i++)
     {
         planning_element p = planning_elements[i];
-        if(p.distance>divs[8]*planning_scale || p.distance<0 || (i>2 && getPlanningHeight(planning_elements[i-3].distance)-getPlanningHeight(p.distance) < 20)) continue;
+        if(p.distance>planning_range || p.distance<0 || (i>2 && planning_elements[i-3].height-p.height < 20)) continue;
         if (object_textures.find(p.condition) == object_textures.end()) {
             std::string name = std::string("symbols/Planning/PL_") + (p.condition < 10 ? "0" : "") + std::to_string(p.condition)+".bmp";
             object_textures[p.condition] = Component::getImageGraphic(name);
         }
-        planning_distance.drawTexture(object_textures[p.condition],object_pos[i%3],getPlanningHeight(p.distance)-5,20,20);
+        planning_distance.drawTexture(object_textures[p.condition],object_pos[i%3],p.height-5,20,20);
     }
 }
 std::vector<gradient_element> gradient_elements;
@@ -91,11 +107,11 @@ void displayGradient()
     for(int i=0; i+1<gradient_elements.size(); i++)
     {
         gradient_element &e = gradient_elements[i];
-        if(e.distance>divs[8]*planning_scale || e.distance<0) continue;
+        if(e.distance>planning_range || e.distance<0) continue;
         float max = gradient_elements[i+1].distance;
-        float minp = getPlanningHeight(max)-15;
-        float maxp = getPlanningHeight(e.distance)-15;
-        if(max>divs[8]*planning_scale) minp = 0;
+        float minp = gradient_elements[i+1].height-15;
+        float maxp = e.height-15;
+        if(max>planning_range) minp = 0;
         float size = maxp-minp;
         planning_gradient.drawRectangle(0, minp, 18, size, e.val>=0 ? Grey : DarkGrey);
         planning_gradient.drawLine(0, minp, 17, minp, e.val>=0 ? White : Grey);
@@ -118,8 +134,8 @@ bool check_spdov(int i, int j)
 {
     speed_element &cur = speed_elements[i];
     speed_element &chk = speed_elements[j];
-    float a = getPlanningHeight(cur.distance)-15;
-    float b = getPlanningHeight(chk.distance)-15;
+    float a = cur.height-15;
+    float b = chk.height-15;
     if(abs(a-b)>18) return false;
     return chk==imarker.element || (cur!=imarker.element && (cur.speed>chk.speed || (cur.speed == chk.speed && cur.distance > chk.distance)));
 }
@@ -142,16 +158,16 @@ void displayPASP()
         speed_element cur = speed_elements[i];
         speed_element prev = speed_elements[i-1];
         if (cur.distance < 0) continue;
-        if(cur.distance>divs[8]*planning_scale)
+        if(cur.distance>planning_range)
         {
-            PASP.drawRectangle(14, 0, 93*red, getPlanningHeight(prev_pasp.distance)-15, PASPlight);
+            PASP.drawRectangle(14, 0, 93*red, prev_pasp.height-15, PASPlight);
             end = true;
             break;
         }
         if(prev_pasp.speed>cur.speed && (!oth2||cur.speed==0))
         {
             oth1 = true;
-            PASP.drawRectangle(14, getPlanningHeight(cur.distance)-15, 93*red, getPlanningHeight(prev_pasp.distance)-getPlanningHeight(cur.distance), PASPlight);
+            PASP.drawRectangle(14, cur.height-15, 93*red, prev_pasp.height-cur.height, PASPlight);
             float v = cur.speed/spd;
             if(v>0.74) red = 3.0/4;
             else if(v>0.49) red = 1.0/2;
@@ -165,7 +181,7 @@ void displayPASP()
         }
         if(oth1 && prev.speed<cur.speed) oth2 = true;
     }
-    if(imarker.start_distance>0 && imarker.start_distance <= divs[8]*planning_scale) PASP.drawRectangle(14, getPlanningHeight(imarker.start_distance)-15, 93, 2, Yellow);
+    if(imarker.start_distance>0 && imarker.start_distance <= planning_range) PASP.drawRectangle(14, imarker.start_height-15, 93, 2, Yellow);
 }
 std::shared_ptr<sdl_texture> pl21;
 std::shared_ptr<sdl_texture> pl22;
@@ -198,8 +214,8 @@ void displaySpeed()
         if (cur.distance < 0) continue;
         ld = i;
         bool im = imarker.start_distance>0 && (cur==imarker.element);
-        if(cur.distance>divs[8]*planning_scale) break;
-        float a = getPlanningHeight(cur.distance)-15;
+        if(cur.distance>planning_range) break;
+        float a = cur.height-15;
         if(im || prev.speed>cur.speed || cur.speed == 0)
         {
             planning_speed.drawTexture(im ? pl23 : pl22, 14, a+7, 20, 20);
@@ -213,14 +229,25 @@ void displaySpeed()
         if (cur.speed == 0) return;
     }
 }
+// Distance labels of each scale, rendered once
+std::map<int, std::vector<std::shared_ptr<sdl_texture>>> scale_labels;
 void speedLines()
 {
+    std::vector<std::shared_ptr<sdl_texture>> &labels = scale_labels[planning_scale];
+    if (labels.empty())
+    {
+        for(int i=0; i<9; i++)
+        {
+            if(i==0||i>4) labels.push_back(Component::getTextGraphic(std::to_string(divs[i]*planning_scale), 10, White, 0, RIGHT));
+            else labels.push_back(nullptr);
+        }
+    }
     planning_distance.clear();
     for(int i=0; i<9; i++)
     {
         if(i==0||i>4)
         {
-            planning_distance.addText(std::to_string(divs[i]*planning_scale), 208, posy[i]-150, 10, White, RIGHT);
+            planning_distance.addText(labels[i], std::to_string(divs[i]*planning_scale), 208, posy[i]-150, 10, White, RIGHT);
         }
     }
 }
@@ -247,11 +274,77 @@ void planningConstruct(window *w)
     /*planning_elements.push_back({1,500});
     planning_elements.push_back({3,1000});
     planning_elements.push_back({32,930});*/
+    build_planning_lut(planning_scale);
     speedLines();
 }
+// Scale factors of the linear and logarithmic parts for the shown scale
+static float first_line = divs[1];
+static float linear_factor = (posy[0]-posy[1])/first_line;
+static float log_factor = (posy[1]-posy[8])/log10(divs[8]/first_line);
+/*
+ * Heights sampled at evenly spaced distances over the shown range. The
+ * curve is smooth enough that linear interpolation between samples stays
+ * well below a pixel, and mapping an element is then a multiply and a
+ * lookup instead of a logarithm.
+ */
+const int lut_size = 1024;
+static float height_lut[lut_size+1];
+static float lut_factor;
 float getPlanningHeight(float dist)
 {
-    float first_line = divs[1]*planning_scale;
-    if(dist<first_line) return posy[0]-((posy[0]-posy[1])/first_line)*dist;
-    else return posy[1]-(posy[1]-posy[8])/log10(divs[8]*planning_scale/first_line)*log10(dist/first_line);
+    if(dist<first_line) return posy[0]-linear_factor*dist;
+    else return posy[1]-log_factor*log10(dist/first_line);
+}
+static void build_planning_lut(float scale)
+{
+    shown_scale = scale;
+    planning_range = divs[8]*scale;
+    first_line = divs[1]*scale;
+    linear_factor = (posy[0]-posy[1])/first_line;
+    log_factor = (posy[1]-posy[8])/log10(planning_range/first_line);
+    for (int i=0; i<=lut_size; i++)
+        height_lut[i] = getPlanningHeight(planning_range*i/lut_size);
+    lut_factor = lut_size/planning_range;
+    update_planning_heights();
+}
+static inline float lookup_height(float dist)
+{
+    float x = dist*lut_factor;
+    if (!(x >= 0 && x < lut_size))
+        return getPlanningHeight(dist);
+    int i = (int)x;
+    float f = x-i;
+    return height_lut[i]+(height_lut[i+1]-height_lut[i])*f;
+}
+template<typename T>
+static void map_heights(std::vector<T> &elements)
+{
+    T *e = elements.data();
+    size_t n = elements.size();
+    for (size_t i=0; i<n; i++)
+        e[i].height = lookup_height(e[i].distance);
+}
+void update_planning_heights()
+{
+    map_heights(planning_elements);
+    map_heights(gradient_elements);
+    map_heights(speed_elements);
+    imarker.start_height = lookup_height(imarker.start_distance);
+}
+void update_planning()
+{
+    if (zoom_start < 0)
+        return;
+    float t = (get_milliseconds()-zoom_start)/(float)zoom_duration;
+    if (t >= 1)
+    {
+        zoom_start = -1;
+        build_planning_lut(planning_scale);
+        speedLines();
+        return;
+    }
+    // Eased interpolation in the logarithm of the scale, so that every
+    // step looks like the same amount of zoom
+    t = t*t*(3-2*t);
+    build_planning_lut(zoom_from*pow(planning_scale/zoom_from, t));
 }
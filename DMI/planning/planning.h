@@ -13,16 +13,19 @@ struct planning_element
 {
     int condition;
     float distance;
+    float height;
 };
 struct gradient_element
 {
     int val;
     float distance;
+    float height;
 };
 struct speed_element
 {
     int speed;
     float distance;
+    float height;
     bool operator==(speed_element e)
     {
         return (e.speed == speed) && (e.distance == distance);
@@ -35,6 +38,7 @@ struct speed_element
 struct indication_marker
 {
     float start_distance;
+    float start_height;
     speed_element element;
 };
 extern std::vector<planning_element> planning_elements;
@@ -47,5 +51,14 @@ void displayGradient();
 void displaySpeed();
 void displayPASP();
 float getPlanningHeight(float dist);
+/*
+ * Recomputes the cached vertical positions of the planning elements. To be
+ * called whenever the elements or the planning scale change.
+ */
+void update_planning_heights();
+/*
+ * Advances the zoom transition, if any. Called once per frame.
+ */
+void update_planning();
 void drawObjects(int num, int distance);
 #endif
@@ -12,6 +12,9 @@
 #include <string>
 #include <ctime>
 #include <math.h>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 using namespace std;
 sdlsounddata sinfo;
 sdlsounddata swarn;
@@ -20,9 +23,90 @@ sdlsounddata click;
 SDL_AudioSpec deviceSpec;
 SDL_AudioDeviceID deviceId;
 time_t last_sinfo;
-void start_sound()
+// 256 samples at 44.1 kHz bound the onset latency of a sound to about 6 ms
+static const int mixer_freq = 44100;
+static const int mixer_samples = 256;
+static const int max_voices = 8;
+struct voice
+{
+    sdlsounddata *sound;
+    uint32_t position;
+    bool loop;
+    uint32_t order;
+    const void *owner;
+};
+// Only accessed with the audio device locked, or from the callback
+static voice voices[max_voices];
+static uint32_t voice_order;
+static void mix(void *userdata, Uint8 *stream, int len)
+{
+    Sint16 *out = (Sint16*)stream;
+    int n = len/2;
+    int32_t acc[mixer_samples];
+    for (int start=0; start<n; start+=mixer_samples) {
+        int count = std::min(n-start, mixer_samples);
+        for (int i=0; i<count; i++)
+            acc[i] = 0;
+        for (int v=0; v<max_voices; v++) {
+            voice &vc = voices[v];
+            if (vc.sound == nullptr)
+                continue;
+            const Sint16 *samples = (const Sint16*)vc.sound->wavBuffer;
+            uint32_t length = vc.sound->wavLength/2;
+            for (int i=0; i<count;) {
+                if (vc.position >= length) {
+                    if (!vc.loop || length == 0) {
+                        vc.sound = nullptr;
+                        break;
+                    }
+                    vc.position = 0;
+                }
+                int chunk = std::min<uint32_t>(count-i, length-vc.position);
+                for (int j=0; j<chunk; j++)
+                    acc[i+j] += samples[vc.position+j];
+                vc.position += chunk;
+                i += chunk;
+            }
+        }
+        for (int i=0; i<count; i++)
+            out[start+i] = std::max(std::min(acc[i], (int32_t)32767), (int32_t)-32768);
+    }
+}
+/*
+ * Converts loaded samples to the mixer format, taking ownership of them.
+ */
+static void convert_sound(sdlsounddata *snd, SDL_AudioSpec &spec, Uint8 *buffer, Uint32 length)
+{
+    SDL_AudioCVT cvt;
+    if (buffer == nullptr || SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq, AUDIO_S16SYS, 1, mixer_freq) < 0) {
+        if (buffer != nullptr)
+            SDL_FreeWAV(buffer);
+        snd->wavBuffer = nullptr;
+        snd->wavLength = 0;
+        snd->freeAudio = 0;
+        return;
+    }
+    cvt.len = length;
+    cvt.buf = (Uint8*)SDL_malloc(length*cvt.len_mult);
+    memcpy(cvt.buf, buffer, length);
+    SDL_FreeWAV(buffer);
+    if (cvt.needed)
+        SDL_ConvertAudio(&cvt);
+    snd->wavBuffer = cvt.buf;
+    snd->wavLength = cvt.needed ? cvt.len_cvt : length;
+    snd->freeAudio = 1;
+}
+static void load_wav(sdlsounddata *snd, std::string file)
 {
     SDL_AudioSpec spec;
+    Uint8 *buffer = nullptr;
+    Uint32 length = 0;
+    if (SDL_LoadWAV(file.c_str(), &spec, &buffer, &length) == nullptr)
+        buffer = nullptr;
+    convert_sound(snd, spec, buffer, length);
+}
+void start_sound()
+{
     std::string soundpath;
 #ifdef __ANDROID__
     extern std::string filesDir;
@@ -30,13 +114,27 @@ void start_sound()
 #else
     soundpath = "sound/";
 #endif
-    SDL_LoadWAV((soundpath+"S2_warning.wav").c_str(), &spec, &swarn.wavBuffer, &swarn.wavLength);
-    SDL_LoadWAV((soundpath+"S_info.wav").c_str(), &spec, &sinfo.wavBuffer, &sinfo.wavLength);
-    SDL_LoadWAV((soundpath+"S1_toofast.wav").c_str(), &spec, &stoofast.wavBuffer, &stoofast.wavLength);
-    SDL_LoadWAV((soundpath+"click.wav").c_str(), &spec, &click.wavBuffer, &click.wavLength);
+    load_wav(&swarn, soundpath+"S2_warning.wav");
+    load_wav(&sinfo, soundpath+"S_info.wav");
+    load_wav(&stoofast, soundpath+"S1_toofast.wav");
+    load_wav(&click, soundpath+"click.wav");
+    stoofast.priority = 3;
+    swarn.priority = 2;
+    sinfo.priority = 1;
+    click.priority = 0;
 
+    SDL_AudioSpec spec;
+    SDL_zero(spec);
+    spec.freq = mixer_freq;
+    spec.format = AUDIO_S16SYS;
+    spec.channels = 1;
+    spec.samples = mixer_samples;
+    spec.callback = mix;
+    // Without allowed changes SDL converts to the hardware format itself
     deviceId = SDL_OpenAudioDevice(NULL, 0, &spec, &deviceSpec, 0);
     last_sinfo = time(nullptr)-1;
+    if (deviceId != 0)
+        SDL_PauseAudioDevice(deviceId, 0);
 }
 sdlsounddata* loadSound(std::string file)
 {
@@ -47,71 +145,112 @@ sdlsounddata* loadSound(std::string file)
     file = "sound/"+file;
 #endif
     auto *snd = new sdlsounddata();
-    snd->freeAudio = 1;
-    SDL_AudioSpec spec;
-    SDL_LoadWAV(file.c_str(), &spec, &snd->wavBuffer, &snd->wavLength);
+    load_wav(snd, file);
     //snd->duration = snd->wavLength * 500 / spec.freq;
     return snd;
 }
+// Sine period of the tone synthesizer, indexed by the top bits of the phase
+static const int sine_bits = 10;
+static Sint16 sine_table[1<<sine_bits];
+// STM tones by their (M_FREQ, T_SOUND) parts, shared by all STMs
+static std::map<std::vector<std::pair<int,int>>, sdlsounddata*> tone_cache;
 sdlsounddata* loadSound(STMSoundDefinition &def)
 {
-    std::vector<Uint16> buff;
-    //int64_t duration = 0;
+    std::vector<std::pair<int,int>> key;
     for (auto &part : def.parts)
     {
-        float freq = (float)part.M_FREQ.get_value();
-        int nsteps = deviceSpec.freq * part.T_SOUND.get_value();
-        float factor = 2*M_PI*freq/deviceSpec.freq;
-        for (int i=0; i<nsteps; i++)
+        key.push_back({(int)part.M_FREQ.rawdata, (int)part.T_SOUND.rawdata});
+    }
+    auto it = tone_cache.find(key);
+    if (it != tone_cache.end())
+        return it->second;
+    if (sine_table[1<<(sine_bits-2)] == 0)
+    {
+        for (int i=0; i<(1<<sine_bits); i++)
         {
-            buff.push_back(freq == 0 ? 0 : 28000*sinf(i * factor));
+            sine_table[i] = 28000*sin(2*M_PI*i/(1<<sine_bits));
         }
-        //duration += part.T_SOUND.rawdata * 100;
+    }
+    size_t total = 0;
+    for (auto &part : def.parts)
+    {
+        total += (int)(mixer_freq * part.T_SOUND.get_value());
     }
     auto *snd = new sdlsounddata();
-    snd->wavLength = buff.size() * 2;
-    snd->wavBuffer = new Uint8[snd->wavLength];
+    snd->wavLength = total * 2;
+    snd->wavBuffer = new Uint8[std::max<size_t>(snd->wavLength, 1)];
     snd->freeAudio = 2;
-    //snd->duration = duration;
-    memcpy(snd->wavBuffer, &buff[0], snd->wavLength);
+    Sint16 *out = (Sint16*)snd->wavBuffer;
+    for (auto &part : def.parts)
+    {
+        double freq = part.M_FREQ.get_value();
+        int nsteps = mixer_freq * part.T_SOUND.get_value();
+        // Phase as a fraction of a period in 32 bit fixed point, starting at 0 for each part
+        uint32_t step = (uint32_t)(freq / mixer_freq * 4294967296.0);
+        uint32_t phase = 0;
+        for (int i=0; i<nsteps; i++)
+        {
+            out[i] = sine_table[phase >> (32-sine_bits)];
+            phase += step;
+        }
+        out += nsteps;
+    }
+    tone_cache[key] = snd;
     return snd;
 }
 sdlsounddata::~sdlsounddata()
 {
-    if (freeAudio == 1) SDL_FreeWAV(wavBuffer);
-    else if (freeAudio == 2) delete wavBuffer;
-}
-sdlsounddata *continuousSound;
-Uint32 refill(Uint32 interval, void *param)
-{
-    if(continuousSound == nullptr) return 0;
-    if(SDL_GetQueuedAudioSize(deviceId) < 3*continuousSound->wavLength) SDL_QueueAudio(deviceId, continuousSound->wavBuffer, continuousSound->wavLength);
-    return interval;
+    if (freeAudio == 1) SDL_free(wavBuffer);
+    else if (freeAudio == 2) delete[] wavBuffer;
 }
-void stopSound(sdlsounddata *d)
+void stopSound(sdlsounddata *d, const void *owner)
 {
-    if (d != nullptr && d != continuousSound) return;
-    SDL_ClearQueuedAudio(deviceId);
-    continuousSound = nullptr;
-    SDL_PauseAudioDevice(deviceId, 1);
+    SDL_LockAudioDevice(deviceId);
+    for (int v=0; v<max_voices; v++) {
+        if (owner != nullptr && voices[v].owner != owner)
+            continue;
+        if (voices[v].sound != nullptr && (d == nullptr || voices[v].sound == d))
+            voices[v].sound = nullptr;
+    }
+    SDL_UnlockAudioDevice(deviceId);
 }
-void play(sdlsounddata *d, bool loop)
+void play(sdlsounddata *d, bool loop, const void *owner)
 {
-    if(continuousSound != nullptr) stopSound(continuousSound);
-    
-    SDL_ClearQueuedAudio(deviceId);
-    int success = SDL_QueueAudio(deviceId, d->wavBuffer, d->wavLength);
-    SDL_PauseAudioDevice(deviceId, 0);
-    if(loop)
-    {
-        continuousSound = d;
-        SDL_AddTimer(50, refill, NULL);
+    if (d == nullptr || d->wavLength == 0)
+        return;
+    SDL_LockAudioDevice(deviceId);
+    int slot = -1;
+    for (int v=0; v<max_voices; v++) {
+        if (voices[v].sound == d && voices[v].owner == owner) {
+            // A sound already looping keeps its phase, otherwise it restarts
+            if (voices[v].loop && loop) {
+                SDL_UnlockAudioDevice(deviceId);
+                return;
+            }
+            slot = v;
+            break;
+        }
+    }
+    for (int v=0; v<max_voices && slot < 0; v++) {
+        if (voices[v].sound == nullptr)
+            slot = v;
+    }
+    if (slot < 0) {
+        for (int v=0; v<max_voices; v++) {
+            voice &vc = voices[v];
+            if (vc.sound->priority > d->priority)
+                continue;
+            if (slot < 0 || vc.sound->priority < voices[slot].sound->priority || (vc.sound->priority == voices[slot].sound->priority && vc.order < voices[slot].order))
+                slot = v;
+        }
     }
+    if (slot >= 0)
+        voices[slot] = {d, 0, loop, voice_order++, owner};
+    SDL_UnlockAudioDevice(deviceId);
 }
 void playSwarning()
 {
-    if (continuousSound == nullptr)
-        play(&swarn, true);
+    play(&swarn, true);
 }
 void stopSwarning()
 {
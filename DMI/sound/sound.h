@@ -10,18 +10,30 @@
 #define _SOUND_H
 #include <string>
 #include "../../EVC/Packets/STM/46.h"
+/*
+ * Sound samples in the format of the mixer (signed 16 bit, mono).
+ * When all voices are busy, a new sound replaces the voice with the
+ * lowest priority, so that clicks never cut an alarm.
+ */
 struct sdlsounddata
 {
-    uint8_t *wavBuffer;
-    uint32_t wavLength;
+    uint8_t *wavBuffer = nullptr;
+    uint32_t wavLength = 0;
     //int64_t duration;
-    int freeAudio;
+    int freeAudio = 0;
+    int priority = 1;
     ~sdlsounddata();
 };
 sdlsounddata *loadSound(std::string file);
+// Tones are synthesized once and owned by a cache, so they must not be deleted
 sdlsounddata* loadSound(STMSoundDefinition &def);
-void play(sdlsounddata *d, bool loop=false);
-void stopSound(sdlsounddata *d);
+/*
+ * Sounds may be shared, as cached tones are, so each voice remembers the
+ * owner that started it. stopSound only stops the voices of the given
+ * owner, or those of every owner if none is given.
+ */
+void play(sdlsounddata *d, bool loop=false, const void *owner=nullptr);
+void stopSound(sdlsounddata *d, const void *owner=nullptr);
 void playSinfo();
 void playTooFast();
 void playClick();
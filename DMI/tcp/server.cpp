@@ -12,6 +12,7 @@
 #include <chrono>
 #include <set>
 #include <cmath>
+#include <memory>
 #ifndef _WIN32
 #include <unistd.h>
 #include <arpa/inet.h>
@@ -33,6 +34,8 @@
 #include "../language/language.h"
 #include "../speed/gauge.h"
 #include "../Config/config.h"
+#include "../../EVC/Utils/spsc_queue.h"
+#include "../../EVC/Utils/triple_buffer.h"
 #include <mutex>
 int server;
 int clients[3];
@@ -40,9 +43,41 @@ int active_channel;
 #define BUFF_SIZE 1024
 #define PORT 5010
 static char data[BUFF_SIZE];
-std::string buffer;
-std::mutex server_mtx;
+/*
+ * Commands are framed and decoded by the socket thread and handed to the
+ * render thread, which only applies them. Status snapshots replace each
+ * other, so only the newest one is kept; every other command is queued
+ * in order. Each status records how many commands were received before
+ * it, and is applied once exactly those have been applied.
+ */
+struct dmi_command
+{
+    std::string command;
+    std::string value;
+    json data;
+    std::shared_ptr<stm_message> stm;
+};
+struct dmi_status
+{
+    json data;
+    uint64_t sequence;
+};
+static spsc_queue<dmi_command, 256> commands;
+static triple_buffer<dmi_status> status;
+// Commands queued, only used by the socket thread
+static uint64_t commands_received;
+// Commands applied and whether a newer status is waiting for them,
+// only used by the render thread
+static uint64_t commands_applied;
+static bool status_pending;
+// The EVC only sends the active window when it changes
+static json active_window;
+// Commands applied per frame, so that a burst is spread over several frames
+#define MAX_COMMANDS_FRAME 64
+// Received bytes not yet framed, only used by the socket thread
+static std::string buffer;
 static SDL_Event ev;
+extern bool running;
 #include <iostream>
 template<class T>
 void fill_non_existent(json &j, std::string str, T def)
@@ -181,11 +216,48 @@ void from_json(const json&j, planning_element &e)
     }
     e.condition = tex;
 }
-void parseData(std::string str)
+static void decode_command(const char *str, size_t size)
+{
+    std::string cmd(str, size);
+    int index = cmd.find_first_of('(');
+    dmi_command c;
+    c.command = cmd.substr(0, index);
+    c.value = cmd.substr(index+1, cmd.find_last_of(')')-index-1);
+    if (c.command == "json")
+    {
+        c.data = json::parse(c.value);
+        c.value.clear();
+        if (c.data.contains("Status"))
+        {
+            if (c.data.contains("ActiveWindow"))
+                active_window = c.data["ActiveWindow"];
+            else if (!active_window.is_null())
+                c.data["ActiveWindow"] = active_window;
+            dmi_status &s = status.write_buffer();
+            s.data = std::move(c.data);
+            s.sequence = commands_received;
+            status.publish();
+            return;
+        }
+    }
+    else if (c.command == "stmData")
+    {
+        bit_manipulator r(c.value);
+        c.stm = std::make_shared<stm_message>(r);
+    }
+    // The render thread always catches up, wait for it rather than drop
+    while (!commands.push(std::move(c)))
+    {
+        if (!running)
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    commands_received++;
+}
+static void apply_command(dmi_command &c)
 {
-    int index = str.find_first_of('(');
-    std::string command = str.substr(0, index);
-    std::string value = str.substr(index+1, str.find_last_of(')')-index-1);
+    std::string &command = c.command;
+    std::string &value = c.value;
     if (command == "setMessage")
     {
         int valsep = value.find(',');
@@ -216,9 +288,7 @@ void parseData(std::string str)
     else if (command == "playSinfo") playSinfo();
     else if (command == "stmData")
     {
-        bit_manipulator r(value);
-        stm_message msg(r);
-        parse_stm_message(msg);
+        parse_stm_message(*c.stm);
     }
     else if (command == "language")
     {
@@ -228,10 +298,14 @@ void parseData(std::string str)
     {
         load_config(value);
     }
-    if (command != "json") return;
-    json j = json::parse(value);
+    else if (command == "json")
+    {
+        setWindow(c.data);
+    }
+}
+static void apply_status(json j)
+{
     setWindow(j);
-    if (!j.contains("Status")) return;
     j = j["Status"];
     /*fill_non_existent(j, "TargetSpeedMpS", 1000);
     fill_non_existent(j, "ReleaseSpeedMpS", 0);
@@ -289,7 +363,7 @@ void parseData(std::string str)
         if (!j["IndicationMarkerTarget"].is_null()) imarker.element = j["IndicationMarkerTarget"].get<speed_element>();
         gradient_elements = j["GradientProfile"].get<std::vector<gradient_element>>();
         planning_elements = j["PlanningTrackConditions"].get<std::vector<planning_element>>();
-        
+        update_planning_heights();
     }
     {
         void updateTc(std::set<int> &syms);
@@ -297,27 +371,44 @@ void parseData(std::string str)
         updateTc(syms);
     }
 }
-extern bool running;
 int read(int channel)
 {
     int result = recv(clients[channel], ::data, BUFF_SIZE-1, 0);
     if(result>0)
     {
-        ::data[result] = 0;
-        std::unique_lock<std::mutex> lck(server_mtx);
-        buffer += ::data;
+        buffer.append(::data, result);
+        size_t pos = 0;
+        size_t end;
+        while ((end=buffer.find(';', pos))!=std::string::npos) {
+            size_t start = buffer.find_first_not_of("\n\r ;", pos);
+            if (start < end) decode_command(buffer.data()+start, end-start);
+            pos = end+1;
+        }
+        buffer.erase(0, pos);
     }
     return result;
 }
+static void update_status()
+{
+    if (status.update())
+        status_pending = true;
+    if (status_pending && status.read_buffer().sequence <= commands_applied)
+    {
+        apply_status(status.read_buffer().data);
+        status_pending = false;
+    }
+}
 void updateDrawCommands()
 {
-    std::unique_lock<std::mutex> lck(server_mtx);
-    int end;
-    while ((end=buffer.find_first_of(';'))!=std::string::npos) {
-        int start = buffer.find_first_not_of("\n\r ;");
-        std::string command = buffer.substr(start, end-start);
-        parseData(command);
-        buffer = buffer.substr(end+1);
+    dmi_command c;
+    update_status();
+    for (int count = 0; count < MAX_COMMANDS_FRAME && commands.pop(c); count++)
+    {
+        // A status received before this command is published by now
+        update_status();
+        apply_command(c);
+        commands_applied++;
+        update_status();
     }
 }
 void write_command(std::string command, std::string value)
@@ -395,6 +486,8 @@ void loopSocket()
 #endif
             clients[active_channel] = -1;
             active_channel = -1;
+            buffer.clear();
+            active_window = nullptr;
             if (running) listenChannels();
         }
     }
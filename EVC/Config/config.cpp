@@ -11,9 +11,10 @@
 #include "../Procedures/level_transition.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include "../Context/state.h"
 using json = nlohmann::json;
-extern std::string traindata_file;
-extern int data_entry_type;
+extern EVC_STATE std::string traindata_file;
+extern EVC_STATE int data_entry_type;
 void load_config(std::string serie)
 {
 #ifdef __ANDROID__
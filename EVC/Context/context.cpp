@@ -0,0 +1,155 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "context.h"
+#include "../TrainSubsystems/cold_movement.h"
+#include "../DMI/dmi.h"
+#include "../DMI/windows.h"
+#include "../DMI/track_ahead_free.h"
+#include "../Packets/messages.h"
+#include "../Packets/vbc.h"
+#include "../Supervision/supervision.h"
+#include "../Supervision/national_values.h"
+#include "../Position/distance.h"
+#include "../Position/geographical.h"
+#include "../Position/odometry.h"
+#include "../OR_interface/interface.h"
+#include "../Procedures/procedures.h"
+#include "../NationalFN/nationalfn.h"
+#include "../TrackConditions/track_condition.h"
+#include "../TrainSubsystems/subsystems.h"
+#include "../LX/level_crossing.h"
+#include "../STM/stm.h"
+#include "../STM/stm_bus.h"
+#include "../Euroradio/terminal.h"
+EVC_STATE std::mutex loop_mtx;
+EVC_STATE std::condition_variable evc_cv;
+EVC_STATE bool started=false;
+EVC_STATE int cold_movement_status;
+void initialize_evc()
+{
+    cold_movement_status = ColdMovementUnknown;
+    setup_national_values();
+    load_vbcs();
+    initialize_mode_transitions();
+    setup_stm_control();
+    set_message_filters();
+    initialize_national_functions();
+    started = true;
+}
+void update()
+{
+    update_odometry();
+    update_odometer();
+    update_geographical_position();
+    update_track_comm();
+    process_stm_bus_input();
+    update_national_values();
+    update_procedures();
+    update_stm_control();
+    update_supervision();
+    update_lx();
+    update_track_conditions();
+    update_messages();
+    update_national_functions();
+    update_train_subsystems();
+    update_dmi_windows();
+    update_track_ahead_free_request();
+    flush_stm_bus_output();
+}
+void evc_worker_pool::acquire()
+{
+    std::unique_lock<std::mutex> lck(mtx);
+    cv.wait(lck, [this] { return free_workers > 0; });
+    free_workers--;
+}
+void evc_worker_pool::release()
+{
+    std::unique_lock<std::mutex> lck(mtx);
+    free_workers++;
+    lck.unlock();
+    cv.notify_one();
+}
+void evc_context::set_input(const std::string &parameter, const std::string &value)
+{
+    std::unique_lock<std::mutex> lck(io_mtx);
+    inputs.push_back({parameter, value});
+}
+evc_outputs evc_context::get_outputs()
+{
+    std::unique_lock<std::mutex> lck(io_mtx);
+    return outputs;
+}
+evc_cycle_stats evc_context::get_stats()
+{
+    std::unique_lock<std::mutex> lck(io_mtx);
+    return stats;
+}
+void evc_context::run(evc_worker_pool &pool, std::chrono::microseconds period, const std::atomic<bool> &stop)
+{
+    thread = std::thread(&evc_context::loop, this, std::ref(pool), period, std::cref(stop));
+}
+void evc_context::join()
+{
+    if (thread.joinable())
+        thread.join();
+}
+void evc_context::loop(evc_worker_pool &pool, std::chrono::microseconds period, const std::atomic<bool> &stop)
+{
+    pool.acquire();
+    initialize_evc();
+    pool.release();
+    std::vector<std::pair<std::string, std::string>> pending;
+    auto next = std::chrono::steady_clock::now();
+    while (!stop) {
+        std::unique_lock<std::mutex> lck(io_mtx);
+        pending.swap(inputs);
+        lck.unlock();
+        pool.acquire();
+        auto prev = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> loop_lck(loop_mtx);
+        for (auto &input : pending)
+            set_parameter(input.first, input.second);
+        pending.clear();
+        update();
+        evc_outputs out;
+        out.V_est = V_est;
+        out.V_perm = V_perm;
+        out.V_sbi = V_sbi;
+        out.V_target = V_target;
+        out.D_target = D_target;
+        out.mode = (int)mode;
+        out.level = (int)level;
+        out.EB = EB_command;
+        out.SB = SB_command;
+        // Nobody reads the DMI stream of a headless train, so it is
+        // discarded instead of accumulating
+        out.dmi_output_bytes = discard_dmi_output();
+        loop_lck.unlock();
+        auto now = std::chrono::steady_clock::now();
+        pool.release();
+        int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(now - prev).count();
+        lck.lock();
+        outputs = out;
+        stats.cycles++;
+        stats.total_us += us;
+        if (us > stats.max_us)
+            stats.max_us = us;
+        if (period.count() > 0 && now > next + period)
+            stats.overruns++;
+        lck.unlock();
+        if (period.count() > 0) {
+            next += period;
+            if (next < now)
+                next = now;
+            std::this_thread::sleep_until(next);
+        }
+    }
+    // The transport thread uses the terminals of this context
+    stop_radio_transport();
+}
@@ -0,0 +1,84 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "state.h"
+extern EVC_STATE std::mutex loop_mtx;
+extern EVC_STATE std::condition_variable evc_cv;
+/*
+ * Per-train setup, everything start() does apart from launching the DMI,
+ * the simulator interface and the log server.
+ */
+void initialize_evc();
+void update();
+/*
+ * Bounds how many trains run their cycle at the same time, so that a host
+ * with many trains does not oversubscribe the machine.
+ */
+class evc_worker_pool
+{
+    std::mutex mtx;
+    std::condition_variable cv;
+    int free_workers;
+    public:
+    evc_worker_pool(int workers) : free_workers(workers) {}
+    void acquire();
+    void release();
+};
+struct evc_cycle_stats
+{
+    uint64_t cycles = 0;
+    uint64_t overruns = 0;
+    int64_t total_us = 0;
+    int64_t max_us = 0;
+};
+/*
+ * Outputs of one train, refreshed at the end of every cycle.
+ */
+struct evc_outputs
+{
+    double V_est = 0;
+    double V_perm = 0;
+    double V_sbi = 0;
+    double V_target = 0;
+    double D_target = 0;
+    int mode = 0;
+    int level = 0;
+    bool EB = false;
+    bool SB = false;
+    uint64_t dmi_output_bytes = 0;
+};
+/*
+ * One train. Its state lives in the EVC_STATE variables of the thread
+ * started by run(); inputs are queued by any thread and applied by the
+ * context at the start of its next cycle, in order.
+ */
+class evc_context
+{
+    std::mutex io_mtx;
+    std::vector<std::pair<std::string, std::string>> inputs;
+    evc_outputs outputs;
+    evc_cycle_stats stats;
+    std::thread thread;
+    void loop(evc_worker_pool &pool, std::chrono::microseconds period, const std::atomic<bool> &stop);
+    public:
+    const int id;
+    evc_context(int id) : id(id) {}
+    void set_input(const std::string &parameter, const std::string &value);
+    void run(evc_worker_pool &pool, std::chrono::microseconds period, const std::atomic<bool> &stop);
+    void join();
+    evc_outputs get_outputs();
+    evc_cycle_stats get_stats();
+};
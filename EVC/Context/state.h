@@ -0,0 +1,20 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+/*
+ * Marks variables that belong to a single train. The standalone EVC keeps
+ * them as plain globals. The multi-train host is built with
+ * EVC_MULTI_TRAIN, so every evc_context runs on its own thread with a
+ * private copy of this state.
+ */
+#ifdef EVC_MULTI_TRAIN
+#define EVC_STATE thread_local
+#else
+#define EVC_STATE
+#endif
@@ -13,6 +13,9 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <errno.h>
 #else
 #include <winsock2.h>
 #endif
@@ -40,9 +43,12 @@
 #include "../TrackConditions/track_condition.h"
 #include "track_ahead_free.h"
 #include "text_message.h"
+#include "planning.h"
 #include <orts/client.h>
 #include <orts/common.h>
 #include "windows.h"
+#include "../Context/state.h"
+#include "../Utils/byte_ring.h"
 using std::thread;
 using std::mutex;
 using std::unique_lock;
@@ -52,8 +58,8 @@ using std::list;
 using std::string;
 using std::to_string;
 using namespace ORserver;
-extern mutex loop_mtx;
-int dmi_pid;
+extern EVC_STATE mutex loop_mtx;
+EVC_STATE int dmi_pid;
 void dmi_comm();
 void start_dmi()
 {
@@ -96,32 +102,31 @@ void start_dmi()
     thread thr(dmi_comm);
     thr.detach();
 }
-extern double V_target;
-extern double V_perm;
-extern double V_est;
-extern double V_set;
-extern double V_release;
-extern double V_sbi;
-extern double D_target;
-extern double TTI;
-extern double TTP;
-extern bool EB_command;
-extern bool SB_command;
-extern MonitoringStatus monitoring;
-extern SupervisionStatus supervision;
-#ifdef WIN32
-int write(int fd, const char *buff, size_t size)
-{
-    return send(fd,buff,size,0);
-}
+extern EVC_STATE double V_target;
+extern EVC_STATE double V_perm;
+extern EVC_STATE double V_est;
+extern EVC_STATE double V_set;
+extern EVC_STATE double V_release;
+extern EVC_STATE double V_sbi;
+extern EVC_STATE double D_target;
+extern EVC_STATE double TTI;
+extern EVC_STATE double TTP;
+extern EVC_STATE bool EB_command;
+extern EVC_STATE bool SB_command;
+extern EVC_STATE MonitoringStatus monitoring;
+extern EVC_STATE SupervisionStatus supervision;
+#ifdef _WIN32
+#define poll WSAPoll
+#define close closesocket
 #endif
-static int fd;
+static int fd = -1;
 void parse_command(string str, bool lock=true)
 {
     int index = str.find_first_of('(');
     string command = str.substr(0, index);
     string value = str.substr(index+1, str.find_last_of(')')-index-1);
-    if (lock) unique_lock<mutex> lck(loop_mtx);
+    unique_lock<mutex> lck(loop_mtx, std::defer_lock);
+    if (lock) lck.lock();
     if (command == "json")
     {
         json j = json::parse(value);
@@ -158,62 +163,225 @@ void parse_command(string str, bool lock=true)
     }
     update_dialog_step(command, value);
 }
-void dmi_recv()
+/*
+ * Commands for the DMI are queued in a ring and written by the DMI thread
+ * without holding loop_mtx. The socket is non-blocking: whatever the DMI
+ * does not accept stays queued for the next attempt. If the connection
+ * is lost, the queue is discarded, since a command may have been cut
+ * halfway, and nothing is queued until the DMI thread reconnects.
+ * Commands that set up the DMI are only sent when something changes, so
+ * their last value is kept and sent again on every connection.
+ */
+#define DMI_OUTPUT_MAX (1<<20)
+EVC_STATE byte_ring dmi_output(DMI_OUTPUT_MAX);
+EVC_STATE mutex dmi_output_mtx;
+EVC_STATE size_t dmi_output_dropped;
+EVC_STATE bool dmi_connected;
+EVC_STATE map<string, string> dmi_setup;
+static bool is_setup_command(const string &command)
 {
-    char buff[500];
-    string s;
-    for (;;) {
-        int count = recv(fd, buff, sizeof(buff)-1,0);
-        if (count < 1)
-            exit(1);
-        buff[count] = 0;
-        s+=buff;
-        int end;
-        while ((end=s.find_first_of(';'))!=string::npos) {
-            int start = s.find_first_not_of("\n\r ;");
-            string command = s.substr(start, end-start);
-            parse_command(command);
-            s = s.substr(end+1);
+    return command == "language" || command == "setSerie";
+}
+static void queue_command(const string &command, const string &value)
+{
+    if (dmi_output.reserve(command.size()+value.size()+4)) {
+        dmi_output.append(command.data(), command.size());
+        dmi_output.append("(", 1);
+        dmi_output.append(value.data(), value.size());
+        dmi_output.append(");\n", 3);
+    } else if (dmi_output_dropped++ == 0) {
+        printf("DMI output queue full, dropping commands\n");
+    }
+}
+/*
+ * Inbound commands are framed in place, and the consumed part of the
+ * buffer is dropped once per read.
+ */
+struct dmi_input
+{
+    string buffer;
+    void clear()
+    {
+        buffer.clear();
+    }
+    void receive(const char *data, size_t size)
+    {
+        buffer.append(data, size);
+        size_t pos = 0;
+        size_t end;
+        while ((end=buffer.find(';', pos))!=string::npos) {
+            size_t start = buffer.find_first_not_of("\n\r ;", pos);
+            if (start < end)
+                parse_command(buffer.substr(start, end-start));
+            pos = end+1;
         }
+        buffer.erase(0, pos);
     }
-
+};
+static bool flush_dmi_output()
+{
+    unique_lock<mutex> lck(dmi_output_mtx);
+    while (fd >= 0 && !dmi_output.empty()) {
+        const char *part[2];
+        size_t len[2];
+        size_t n = dmi_output.read_parts(part, len);
+#ifdef _WIN32
+        WSABUF bufs[2];
+        for (size_t i=0; i<n; i++) {
+            bufs[i].buf = (char*)part[i];
+            bufs[i].len = len[i];
+        }
+        DWORD sent;
+        if (WSASend(fd, bufs, n, &sent, 0, nullptr, nullptr) != 0)
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        struct iovec iov[2];
+        for (size_t i=0; i<n; i++) {
+            iov[i].iov_base = (void*)part[i];
+            iov[i].iov_len = len[i];
+        }
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+#ifdef MSG_NOSIGNAL
+        ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+#else
+        ssize_t sent = sendmsg(fd, &msg, 0);
+#endif
+        if (sent < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+        dmi_output.consume(sent);
+    }
+    return true;
 }
-string lines = "";
-extern POSIXclient *s_client;
-bool sendtoor=false;
-int64_t lastor;
-void send_command(string command, string value)
+static bool dmi_output_pending()
 {
-    lines += command+"("+value+");\n";
-    if(sendtoor && s_client != nullptr && s_client->connected) s_client->WriteLine("noretain(etcs::dmi::command="+command+"("+value+"))");
+    unique_lock<mutex> lck(dmi_output_mtx);
+    return !dmi_output.empty();
 }
-double calc_ceiling_limit();
-struct speed_element
+/*
+ * The active window is only sent when it changes, the DMI keeps the last
+ * one it received.
+ */
+EVC_STATE static json dmi_active_window;
+static void disconnect_dmi()
 {
-    double Distance;
-    double Speed;
-};
-struct gradient_element
+    if (fd < 0)
+        return;
+    printf("Connection with DMI lost\n");
+    close(fd);
+    fd = -1;
+    dmi_active_window = nullptr;
+    unique_lock<mutex> lck(dmi_output_mtx);
+    dmi_output.clear();
+    dmi_connected = false;
+}
+static bool connect_dmi()
 {
-    double Distance;
-    int Gradient;
-};
-void to_json(json&j, const speed_element &e)
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(5010);
+    //std::cout<<"Ip del DMI"<<std::endl;
+    string ip="127.0.0.1";
+    //std::cin>>ip;
+    addr.sin_addr.s_addr = inet_addr(ip.c_str());
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        fd = -1;
+        return false;
+    }
+#ifdef _WIN32
+    u_long nonblocking = 1;
+    ioctlsocket(fd, FIONBIO, &nonblocking);
+#else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    unique_lock<mutex> lck(dmi_output_mtx);
+    dmi_output.clear();
+    dmi_connected = true;
+    for (auto &it : dmi_setup)
+        queue_command(it.first, it.second);
+    return true;
+}
+/*
+ * Reads everything available. Returns false if the connection was closed.
+ */
+static bool dmi_recv(dmi_input &input)
 {
-    j["DistanceToTrainM"] = e.Distance;
-    j["TargetSpeedMpS"] = e.Speed;
+    char buff[4096];
+    for (;;) {
+        int count = recv(fd, buff, sizeof(buff), 0);
+        if (count > 0) {
+            input.receive(buff, count);
+            continue;
+        }
+        if (count == 0)
+            return false;
+#ifdef _WIN32
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+    }
 }
-void to_json(json&j, const gradient_element &e)
+/*
+ * Waits until the next status is due, handling input from the DMI and
+ * writing queued output as the socket accepts it.
+ */
+static void wait_dmi(dmi_input &input, int64_t until)
+{
+    for (;;) {
+        int64_t now = get_milliseconds();
+        if (now >= until)
+            return;
+        if (fd < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(until-now));
+            return;
+        }
+        struct pollfd p;
+        p.fd = fd;
+        p.events = POLLIN;
+        if (dmi_output_pending())
+            p.events |= POLLOUT;
+        p.revents = 0;
+        // Bounded, so that output queued meanwhile by the main loop is
+        // not left waiting for a whole period
+        int timeout = until-now < 20 ? until-now : 20;
+        if (poll(&p, 1, timeout) < 0)
+            continue;
+        if ((p.revents & (POLLIN | POLLHUP | POLLERR)) && !dmi_recv(input)) {
+            disconnect_dmi();
+            return;
+        }
+        if (!flush_dmi_output()) {
+            disconnect_dmi();
+            return;
+        }
+    }
+}
+extern POSIXclient *s_client;
+EVC_STATE bool sendtoor=false;
+EVC_STATE int64_t lastor;
+void send_command(string command, string value)
 {
-    j["DistanceToTrainM"] = e.Distance;
-    j["GradientPerMille"] = e.Gradient;
+    unique_lock<mutex> lck(dmi_output_mtx);
+    if (is_setup_command(command))
+        dmi_setup[command] = value;
+    if (dmi_connected)
+        queue_command(command, value);
+    lck.unlock();
+    if(sendtoor && s_client != nullptr && s_client->connected) s_client->WriteLine("noretain(etcs::dmi::command="+command+"("+value+"))");
 }
-void to_json(json&j, const PlanningTrackCondition &e)
+size_t discard_dmi_output()
 {
-    j["DistanceToTrainM"] = e.DistanceToTrainM;
-    j["YellowColour"] = e.YellowColour;
-    j["Type"] = e.Type;
-    j["TractionSystem"] = e.TractionSystem;
+    unique_lock<mutex> lck(dmi_output_mtx);
+    size_t size = dmi_output.size();
+    dmi_output.clear();
+    return size;
 }
 void to_json(json&j, const text_message &t)
 {
@@ -223,20 +391,18 @@ void to_json(json&j, const text_message &t)
 }
 void dmi_comm()
 {
-    fd = socket(AF_INET, SOCK_STREAM, 0);
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(5010);
-    //std::cout<<"Ip del DMI"<<std::endl;
-    string ip="127.0.0.1";
-    //std::cin>>ip;
-    addr.sin_addr.s_addr = inet_addr(ip.c_str());
-    int res = connect(fd, (struct sockaddr *)&addr, sizeof(addr));
-    if (res < 0)
-        exit(1);
-    thread reading(dmi_recv);
-    reading.detach();
+    dmi_input input;
+    int64_t next_status = get_milliseconds();
     for (;;) {
+        wait_dmi(input, next_status);
+        next_status += 100;
+        if (next_status < get_milliseconds())
+            next_status = get_milliseconds() + 100;
+        if (fd < 0) {
+            if (!connect_dmi())
+                continue;
+            input.clear();
+        }
         unique_lock<mutex> lck(loop_mtx);
         sendtoor = get_milliseconds() - lastor > 250;
         if (sendtoor) lastor = get_milliseconds();
@@ -276,106 +442,7 @@ void dmi_comm()
         if (display_lssma) j["LSSMA"] = lssma;
         if (mode == Mode::FS || mode == Mode::OS)
         {
-            std::vector<speed_element> speeds;
-            double v = calc_ceiling_limit();
-            speeds.push_back({0,v});
-            std::map<::distance,double> MRSP = get_MRSP();
-            extern const target* indication_target;
-            extern double indication_distance;
-            double last_distance = MA ? MA->get_abs_end()-d_minsafefront(MA->get_abs_end()) : 0;
-            const std::list<target> &targets = get_supervised_targets();
-            for (const target &t : targets)
-            {
-                distance td = t.get_target_position();
-                double d = td - (t.is_EBD_based ? d_maxsafefront(td) : d_estfront);
-                if (t.get_target_speed() == 0 && d<last_distance)
-                    last_distance = d;
-            }
-            j["IndicationMarkerTarget"] = nullptr;
-            j["IndicationMarkerDistanceM"] = nullptr;
-            for (auto it=MRSP.begin(); it!=MRSP.end(); ++it) {
-                distance dist = it->first;
-                float safedist = dist-d_maxsafefront(dist);
-                if (safedist < 0)
-                    continue;
-                if (safedist > last_distance + 1)
-                    break;
-                if (indication_target != nullptr && indication_target->get_target_position() == dist && indication_target->get_target_speed() == it->second && indication_target->type == target_class::MRSP && monitoring == CSM) {
-                    j["IndicationMarkerTarget"]["TargetSpeedMpS"] = indication_target->get_target_speed();
-                    j["IndicationMarkerTarget"]["DistanceToTrainM"] = safedist;
-                    j["IndicationMarkerDistanceM"] = indication_distance;
-                }
-                speeds.push_back({safedist, it->second});
-            }
-            if (SvL && *SvL-d_maxsafefront(*SvL) <= last_distance + 1) {
-                if (monitoring == CSM && indication_target != nullptr && (indication_target->type == target_class::SvL || indication_target->type == target_class::EoA)){
-                    j["IndicationMarkerTarget"]["TargetSpeedMpS"] = 0;
-                    j["IndicationMarkerTarget"]["DistanceToTrainM"] = *SvL-d_maxsafefront(*SvL);
-                    j["IndicationMarkerDistanceM"] = indication_distance;
-                }
-                speeds.push_back({*SvL-d_maxsafefront(*SvL), 0});
-                last_distance = *SvL-d_maxsafefront(*SvL);
-            }
-            else if (EoA && *EoA-d_estfront <= last_distance + 1) {
-                if (monitoring == CSM && indication_target != nullptr && (indication_target->type == target_class::SvL || indication_target->type == target_class::EoA)) {
-                    j["IndicationMarkerTarget"]["TargetSpeedMpS"] = 0;
-                    j["IndicationMarkerTarget"]["DistanceToTrainM"] = *EoA-d_estfront;
-                    j["IndicationMarkerDistanceM"] = indication_distance;
-                }
-                speeds.push_back({*EoA-d_estfront, 0});
-                last_distance = *EoA-d_estfront;
-            }
-            if (LoA && LoA->first-d_maxsafefront(LoA->first) <= last_distance + 1) {
-                if (monitoring == CSM && indication_target != nullptr && (indication_target->type == target_class::LoA)) {
-                    j["IndicationMarkerTarget"]["TargetSpeedMpS"] = LoA->second;
-                    j["IndicationMarkerTarget"]["DistanceToTrainM"] = LoA->first-d_maxsafefront(LoA->first);
-                    j["IndicationMarkerDistanceM"] = indication_distance;
-                }
-                speeds.push_back({LoA->first-d_maxsafefront(LoA->first), LoA->second});
-                last_distance = LoA->first-d_maxsafefront(LoA->first);
-            }
-            j["SpeedTargets"] = speeds;
-            std::map<::distance,double> gradient = get_gradient();
-            std::vector<gradient_element> grad;
-            grad.push_back({0, (int)((--gradient.upper_bound(d_estfront))->second*1000)});
-            for (auto it=gradient.upper_bound(d_estfront); it!=gradient.end(); ++it) {
-                float dist = it->first-d_estfront;
-                if (it == --gradient.end() || dist >= last_distance + 1)
-                    break;
-                grad.push_back({dist,(int)(it->second*1000)});
-            }
-            grad.push_back({std::max(last_distance, 0.0),0});
-            j["GradientProfile"] = grad;
-            std::vector<PlanningTrackCondition> objs;
-            for (auto it = track_conditions.begin(); it != track_conditions.end(); ++it) {
-                track_condition *tc = it->get();
-                double start = tc->announce_distance;
-                double end = tc->get_end_distance_to_train();
-                tc->start_symbol.DistanceToTrainM = start;
-                tc->end_symbol.DistanceToTrainM = end;
-                if (tc->start_symbol.Type != TrackConditionType_DMI::None && start > 0 && start <= last_distance + 1) {
-                    objs.push_back(tc->start_symbol);
-                }
-                if (tc->end_symbol.Type != TrackConditionType_DMI::None && end > 0 && end <= last_distance + 1) {
-                    objs.push_back(tc->end_symbol);
-                }
-            }
-            std::sort(objs.begin(), objs.end(), [](PlanningTrackCondition x, PlanningTrackCondition y) {return x.DistanceToTrainM < y.DistanceToTrainM;});
-            j["PlanningTrackConditions"] = objs;
-            std::set<int> active_symbols;
-            for (auto it = track_conditions.begin(); it != track_conditions.end(); ++it) {
-                track_condition *tc = it->get();
-                if (tc->active_symbol != -1 && tc->order)
-                    active_symbols.insert(tc->active_symbol);
-                else if (tc->announcement_symbol != -1 && tc->announce)
-                    active_symbols.insert(tc->announcement_symbol);
-                else if (tc->end_active_symbol != -1 && tc->display_end) {
-                    active_symbols.insert(tc->end_active_symbol);
-                }
-            }
-            extern bool inform_lx;
-            if (inform_lx) active_symbols.insert(100);
-            j["ActiveTrackConditions"] = active_symbols;
+            update_planning_information(j);
         }
         else
         {
@@ -386,17 +453,18 @@ void dmi_comm()
         }
         json j2;
         j2["Status"] = j;
-        j2["ActiveWindow"] = active_window_dmi;
+        if (sendtoor || active_window_dmi != dmi_active_window) {
+            j2["ActiveWindow"] = active_window_dmi;
+            dmi_active_window = active_window_dmi;
+        }
         send_command("json", j2.dump());
         /*
         send_command("setVset", to_string(V_set*3.6));
         send_command("setGeoPosition", valid_geo_reference ? to_string(valid_geo_reference->get_position(d_estfront)) : "-1");
         auto m = mode;
         */
-        if (write(fd, lines.c_str(), lines.size()) < 0)
-            exit(1);
-        lines = "";
         lck.unlock();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (!flush_dmi_output())
+            disconnect_dmi();
     }
 }
@@ -9,6 +9,11 @@
 #ifndef _DMI_H
 #define _DMI_H
 #include <string>
+#include <cstddef>
 void start_dmi();
 void send_command(std::string command, std::string value);
+/*
+ * Drops the commands queued for the DMI, returning their size in bytes.
+ */
+size_t discard_dmi_output();
 #endif
\ No newline at end of file
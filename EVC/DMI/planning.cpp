@@ -0,0 +1,225 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "planning.h"
+#include "../Supervision/supervision.h"
+#include "../Supervision/targets.h"
+#include "../Supervision/speed_profile.h"
+#include "../Position/distance.h"
+#include "../MA/movement_authority.h"
+#include "../TrackConditions/track_condition.h"
+#include "../Context/state.h"
+#include <vector>
+#include <set>
+#include <algorithm>
+struct speed_element
+{
+    double Distance;
+    double Speed;
+};
+struct gradient_element
+{
+    double Distance;
+    int Gradient;
+};
+void to_json(json&j, const speed_element &e)
+{
+    j["DistanceToTrainM"] = e.Distance;
+    j["TargetSpeedMpS"] = e.Speed;
+}
+void to_json(json&j, const gradient_element &e)
+{
+    j["DistanceToTrainM"] = e.Distance;
+    j["GradientPerMille"] = e.Gradient;
+}
+void to_json(json&j, const PlanningTrackCondition &e)
+{
+    j["DistanceToTrainM"] = e.DistanceToTrainM;
+    j["YellowColour"] = e.YellowColour;
+    j["Type"] = e.Type;
+    j["TractionSystem"] = e.TractionSystem;
+}
+struct planning_symbol
+{
+    track_condition *tc;
+    bool end;
+    double distance;
+};
+/*
+ * Planning data kept between updates. The MRSP is flattened once per
+ * MRSP version, and the index of the first element ahead of the train
+ * only moves as the train moves. Track condition symbols keep their order
+ * from the previous update, which stays sorted while all of them shift
+ * by the same distance, so restoring the order is a single pass. The
+ * conditions are held by reference until the next update, so a removed
+ * condition cannot be mistaken for a new one allocated at its address.
+ */
+struct planning_model
+{
+    uint64_t mrsp_version = 0;
+    std::vector<std::pair<const distance*, double>> mrsp;
+    size_t mrsp_first = 0;
+    std::vector<std::shared_ptr<track_condition>> conditions;
+    std::vector<planning_symbol> symbols;
+    std::vector<speed_element> speeds;
+    std::vector<gradient_element> gradients;
+    std::vector<PlanningTrackCondition> objects;
+};
+EVC_STATE static planning_model planning;
+extern EVC_STATE MonitoringStatus monitoring;
+static float safe_distance(const distance &dist)
+{
+    return dist-d_maxsafefront(dist);
+}
+static void update_mrsp_elements()
+{
+    planning_model &p = planning;
+    if (p.mrsp_version != get_MRSP_version() || p.mrsp.empty()) {
+        p.mrsp_version = get_MRSP_version();
+        p.mrsp.clear();
+        for (auto &kvp : get_MRSP())
+            p.mrsp.push_back({&kvp.first, kvp.second});
+        p.mrsp_first = 0;
+    }
+    while (p.mrsp_first > 0 && safe_distance(*p.mrsp[p.mrsp_first-1].first) >= 0)
+        p.mrsp_first--;
+    while (p.mrsp_first < p.mrsp.size() && safe_distance(*p.mrsp[p.mrsp_first].first) < 0)
+        p.mrsp_first++;
+}
+static void update_symbols(double last_distance)
+{
+    planning_model &p = planning;
+    bool changed = p.conditions.size() != track_conditions.size();
+    size_t i = 0;
+    for (auto it = track_conditions.begin(); it != track_conditions.end() && !changed; ++it, ++i) {
+        changed = p.conditions[i] != *it;
+    }
+    if (changed) {
+        p.conditions.clear();
+        p.symbols.clear();
+        for (auto it = track_conditions.begin(); it != track_conditions.end(); ++it) {
+            track_condition *tc = it->get();
+            p.conditions.push_back(*it);
+            if (tc->start_symbol.Type != TrackConditionType_DMI::None)
+                p.symbols.push_back({tc, false, 0});
+            if (tc->end_symbol.Type != TrackConditionType_DMI::None)
+                p.symbols.push_back({tc, true, 0});
+        }
+    }
+    for (auto &tc : p.conditions) {
+        tc->start_symbol.DistanceToTrainM = tc->announce_distance;
+        tc->end_symbol.DistanceToTrainM = tc->get_end_distance_to_train();
+    }
+    for (auto &s : p.symbols) {
+        s.distance = s.end ? s.tc->end_symbol.DistanceToTrainM : s.tc->start_symbol.DistanceToTrainM;
+    }
+    // Insertion sort, linear when the order of the last update still holds
+    for (size_t i=1; i<p.symbols.size(); i++) {
+        planning_symbol s = p.symbols[i];
+        size_t j = i;
+        for (; j>0 && p.symbols[j-1].distance > s.distance; j--)
+            p.symbols[j] = p.symbols[j-1];
+        p.symbols[j] = s;
+    }
+    p.objects.clear();
+    for (auto &s : p.symbols) {
+        if (s.distance > 0 && s.distance <= last_distance + 1)
+            p.objects.push_back(s.end ? s.tc->end_symbol : s.tc->start_symbol);
+    }
+}
+void update_planning_information(json &j)
+{
+    planning_model &p = planning;
+    p.speeds.clear();
+    double v = calc_ceiling_limit();
+    p.speeds.push_back({0,v});
+    extern EVC_STATE const target* indication_target;
+    extern EVC_STATE double indication_distance;
+    double last_distance = MA ? MA->get_abs_end()-d_minsafefront(MA->get_abs_end()) : 0;
+    const std::list<target> &targets = get_supervised_targets();
+    for (const target &t : targets)
+    {
+        distance td = t.get_target_position();
+        double d = td - (t.is_EBD_based ? d_maxsafefront(td) : d_estfront);
+        if (t.get_target_speed() == 0 && d<last_distance)
+            last_distance = d;
+    }
+    j["IndicationMarkerTarget"] = nullptr;
+    j["IndicationMarkerDistanceM"] = nullptr;
+    update_mrsp_elements();
+    for (size_t i=p.mrsp_first; i<p.mrsp.size(); i++) {
+        const distance &dist = *p.mrsp[i].first;
+        double speed = p.mrsp[i].second;
+        float safedist = safe_distance(dist);
+        if (safedist < 0)
+            continue;
+        if (safedist > last_distance + 1)
+            break;
+        if (indication_target != nullptr && indication_target->get_target_position() == dist && indication_target->get_target_speed() == speed && indication_target->type == target_class::MRSP && monitoring == CSM) {
+            j["IndicationMarkerTarget"]["TargetSpeedMpS"] = indication_target->get_target_speed();
+            j["IndicationMarkerTarget"]["DistanceToTrainM"] = safedist;
+            j["IndicationMarkerDistanceM"] = indication_distance;
+        }
+        p.speeds.push_back({safedist, speed});
+    }
+    if (SvL && *SvL-d_maxsafefront(*SvL) <= last_distance + 1) {
+        if (monitoring == CSM && indication_target != nullptr && (indication_target->type == target_class::SvL || indication_target->type == target_class::EoA)){
+            j["IndicationMarkerTarget"]["TargetSpeedMpS"] = 0;
+            j["IndicationMarkerTarget"]["DistanceToTrainM"] = *SvL-d_maxsafefront(*SvL);
+            j["IndicationMarkerDistanceM"] = indication_distance;
+        }
+        p.speeds.push_back({*SvL-d_maxsafefront(*SvL), 0});
+        last_distance = *SvL-d_maxsafefront(*SvL);
+    }
+    else if (EoA && *EoA-d_estfront <= last_distance + 1) {
+        if (monitoring == CSM && indication_target != nullptr && (indication_target->type == target_class::SvL || indication_target->type == target_class::EoA)) {
+            j["IndicationMarkerTarget"]["TargetSpeedMpS"] = 0;
+            j["IndicationMarkerTarget"]["DistanceToTrainM"] = *EoA-d_estfront;
+            j["IndicationMarkerDistanceM"] = indication_distance;
+        }
+        p.speeds.push_back({*EoA-d_estfront, 0});
+        last_distance = *EoA-d_estfront;
+    }
+    if (LoA && LoA->first-d_maxsafefront(LoA->first) <= last_distance + 1) {
+        if (monitoring == CSM && indication_target != nullptr && (indication_target->type == target_class::LoA)) {
+            j["IndicationMarkerTarget"]["TargetSpeedMpS"] = LoA->second;
+            j["IndicationMarkerTarget"]["DistanceToTrainM"] = LoA->first-d_maxsafefront(LoA->first);
+            j["IndicationMarkerDistanceM"] = indication_distance;
+        }
+        p.speeds.push_back({LoA->first-d_maxsafefront(LoA->first), LoA->second});
+        last_distance = LoA->first-d_maxsafefront(LoA->first);
+    }
+    j["SpeedTargets"] = p.speeds;
+    const gradient_profile &gradient = get_gradient();
+    p.gradients.clear();
+    p.gradients.push_back({0, (int)((--gradient.upper_bound(d_estfront))->second*1000)});
+    for (auto it=gradient.upper_bound(d_estfront); it!=gradient.end(); ++it) {
+        float dist = it->first-d_estfront;
+        if (it == --gradient.end() || dist >= last_distance + 1)
+            break;
+        p.gradients.push_back({dist,(int)(it->second*1000)});
+    }
+    p.gradients.push_back({std::max(last_distance, 0.0),0});
+    j["GradientProfile"] = p.gradients;
+    update_symbols(last_distance);
+    j["PlanningTrackConditions"] = p.objects;
+    std::set<int> active_symbols;
+    for (auto it = track_conditions.begin(); it != track_conditions.end(); ++it) {
+        track_condition *tc = it->get();
+        if (tc->active_symbol != -1 && tc->order)
+            active_symbols.insert(tc->active_symbol);
+        else if (tc->announcement_symbol != -1 && tc->announce)
+            active_symbols.insert(tc->announcement_symbol);
+        else if (tc->end_active_symbol != -1 && tc->display_end) {
+            active_symbols.insert(tc->end_active_symbol);
+        }
+    }
+    extern EVC_STATE bool inform_lx;
+    if (inform_lx) active_symbols.insert(100);
+    j["ActiveTrackConditions"] = active_symbols;
+}
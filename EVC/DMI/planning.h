@@ -0,0 +1,16 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+/*
+ * Fills the speed targets, gradient profile and track conditions of the
+ * planning area, as seen from the current train position.
+ */
+void update_planning_information(json &j);
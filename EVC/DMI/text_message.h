@@ -16,6 +16,7 @@
 #include "../Euroradio/session.h"
 #include <ctime>
 #include <list>
+#include "../Context/state.h"
 enum struct text_message_type
 {
     SystemStatus,
@@ -42,7 +43,7 @@ struct text_message
     std::function<bool(text_message&)> end_condition;
     text_message(std::string text, bool fg, bool ack, int reason, std::function<bool(text_message&)> end_condition);
 };
-extern std::list<text_message> messages;
+extern EVC_STATE std::list<text_message> messages;
 text_message &add_message(text_message t);
 void add_message(PlainTextMessage m, distance ref);
 void add_message(FixedTextMessage m, distance ref);
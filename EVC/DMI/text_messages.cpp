@@ -11,7 +11,8 @@
 #include "../Supervision/supervision.h"
 #include "../language/language.h"
 #include "../Version/version.h"
-unsigned char idcount=0;
+#include "../Context/state.h"
+EVC_STATE unsigned char idcount=0;
 text_message::text_message(std::string text, bool fg, bool ack, int reason, std::function<bool(text_message&)> end_condition) 
     : text(text), firstGroup(fg), ack(ack), reason(reason), end_condition(end_condition)
 {
@@ -24,7 +25,7 @@ text_message::text_message(std::string text, bool fg, bool ack, int reason, std:
     acknowledged = false;
     shown = false;
 }
-std::list<text_message> messages;
+EVC_STATE std::list<text_message> messages;
 text_message &add_message(text_message t)
 {
     /*for (auto it = messages.begin(); it!=messages.end(); ++it) {
@@ -36,7 +37,7 @@ text_message &add_message(text_message t)
     messages.push_back(t);
     return messages.back();
 }
-extern bool sendtoor;
+extern EVC_STATE bool sendtoor;
 void send(text_message t) {
     sendtoor=true;
     send_command("setMessage", std::to_string(t.id)+","+std::to_string(t.text.size())+","+t.text+","+std::to_string(t.hour)+","+std::to_string(t.minute)+","+(t.firstGroup?"true,":"false,")+(t.ack?"true,":"false,")+std::to_string(t.reason));
@@ -9,9 +9,10 @@
 #include "../Packets/radio.h"
 #include "../Euroradio/session.h"
 #include "../Supervision/fixed_values.h"
-optional<std::pair<distance, distance>> taf_request;
-bool start_display_taf;
-bool stop_display_taf;
+#include "../Context/state.h"
+EVC_STATE optional<std::pair<distance, distance>> taf_request;
+EVC_STATE bool start_display_taf;
+EVC_STATE bool stop_display_taf;
 void request_track_ahead_free(distance start, double length)
 {
     taf_request = {start, start+length};
@@ -19,17 +19,18 @@
 #include "../STM/stm.h"
 #include "../Version/version.h"
 #include <fstream>
-dialog_sequence active_dialog;
-std::string active_dialog_step;
-json default_window = R"({"active":"default"})"_json;
-json active_window_dmi = default_window;
+#include "../Context/state.h"
+EVC_STATE dialog_sequence active_dialog;
+EVC_STATE dialog_step active_dialog_step;
+EVC_STATE json default_window = R"({"active":"default"})"_json;
+EVC_STATE json active_window_dmi = default_window;
 const json main_window_radio_wait = R"({"active":"menu_main","hour_glass":true,"enabled":{"Start":false,"Driver ID":false,"Train Data":false,"Level":false,"Train Running Number":false,"Maintain Shunting":false,"Shunting":false,"Non Leading":false,"Radio Data":false,"Exit":false}})"_json;
 const json radio_window_radio_wait = R"({"active":"menu_radio","hour_glass":true,"enabled":{"Exit":false}})"_json;
-bool pending_train_data_send = false;
-bool any_button_pressed_async = false;
-bool any_button_pressed = false;
-bool flexible_data_entry = false;
-int data_entry_type = 0;
+EVC_STATE bool pending_train_data_send = false;
+EVC_STATE bool any_button_pressed_async = false;
+EVC_STATE bool any_button_pressed = false;
+EVC_STATE bool flexible_data_entry = false;
+EVC_STATE int data_entry_type = 0;
 json build_input_field(std::string label, std::string value, std::vector<std::string> values)
 {
     json j;
@@ -297,182 +298,249 @@ json system_version_window()
     j["WindowDefinition"] = build_data_view_window(get_text("System version"), {build_field(get_text("Operated system version"), std::to_string(VERSION_X(operated_version))+"."+std::to_string(VERSION_Y(operated_version)))});
     return j;
 }
-static dialog_sequence prev_dialog;
-static std::string prev_step;
-void update_dmi_windows()
+/*
+ * Windows that do not depend on any data are built once and referenced
+ * by id. The id of the active window also selects which of its buttons
+ * have to be updated every cycle.
+ */
+enum struct window_id
 {
-    any_button_pressed = any_button_pressed_async;
-    any_button_pressed_async = false;
-    //json prev_active = active_window_dmi;
-    bool changed = prev_dialog != active_dialog || prev_step != active_dialog_step;
-    prev_dialog = active_dialog;
-    prev_step = active_dialog_step;
-    if (active_dialog == dialog_sequence::None) {
-        if (changed) active_window_dmi = default_window;
-    } else if (active_dialog == dialog_sequence::StartUp) {
-        if (!som_active)
-            active_dialog = dialog_sequence::None;
-        if (active_dialog_step == "S0") {
-            if (changed)
-                active_window_dmi = main_window_radio_wait;
+    None,
+    Custom,
+    Default,
+    MainRadioWait,
+    RadioRadioWait,
+    MenuMain,
+    MenuRadio,
+    MenuOverride,
+    MenuSpecial,
+    MenuSettings,
+    MenuNTC,
+    Volume,
+    Brightness,
+};
+static const json &prebuilt_window(window_id id)
+{
+    static const json windows[] = {
+        nullptr,
+        nullptr,
+        default_window,
+        main_window_radio_wait,
+        radio_window_radio_wait,
+        R"({"active":"menu_main"})"_json,
+        R"({"active":"menu_radio"})"_json,
+        R"({"active":"menu_override"})"_json,
+        R"({"active":"menu_spec"})"_json,
+        R"({"active":"menu_settings"})"_json,
+        nullptr,
+        R"({"active":"volume_window"})"_json,
+        R"({"active":"brightness_window"})"_json,
+    };
+    return windows[(int)id];
+}
+EVC_STATE static window_id active_window_id = window_id::Default;
+static void show_window(window_id id)
+{
+    active_window_dmi = prebuilt_window(id);
+    active_window_id = id;
+}
+static void show_window(json window, window_id id = window_id::Custom)
+{
+    active_window_dmi = std::move(window);
+    active_window_id = id;
+}
+/*
+ * Each step of a dialog sequence has the window shown when the step is
+ * entered, either prebuilt or built from current data, and the function
+ * evaluating its transitions every cycle. Tables are built once and
+ * indexed by sequence and step.
+ */
+struct dialog_state
+{
+    window_id window = window_id::None;
+    void (*enter)() = nullptr;
+    void (*update)() = nullptr;
+    bool exit = false;
+};
+const int dialog_step_count = (int)dialog_step::A40 + 1;
+const int dialog_sequence_count = (int)dialog_sequence::NTCData + 1;
+struct dialog_sequence_table
+{
+    dialog_state states[dialog_step_count];
+    // Evaluated before the active step
+    void (*update)() = nullptr;
+    // Whether the Exit button depends on the step
+    bool manages_exit = false;
+};
+static bool any_mobile_registered()
+{
+    for (mobile_terminal &t : mobile_terminals) {
+        if (t.registered)
+            return true;
+    }
+    return false;
+}
+static std::vector<dialog_sequence_table> build_dialog_tables()
+{
+    std::vector<dialog_sequence_table> tables(dialog_sequence_count);
+    auto sequence = [&tables](dialog_sequence seq, bool manages_exit, bool exit) -> dialog_sequence_table& {
+        dialog_sequence_table &t = tables[(int)seq];
+        t.manages_exit = manages_exit;
+        for (auto &s : t.states)
+            s.exit = exit;
+        return t;
+    };
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::None, false, false);
+        for (auto &s : t.states)
+            s.window = window_id::Default;
+    }
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::StartUp, true, false);
+        t.update = []() {
+            if (!som_active)
+                active_dialog = dialog_sequence::None;
+        };
+        auto &s = t.states;
+        s[(int)dialog_step::S0].window = window_id::MainRadioWait;
+        s[(int)dialog_step::S0].update = []() {
             if (som_status != S0)
-                active_dialog_step = "S1";
-        } else if (active_dialog_step == "S1") {
-            if (changed)
-                active_window_dmi = driver_id_window(true);
+                active_dialog_step = dialog_step::S1;
+        };
+        s[(int)dialog_step::S1].enter = []() { show_window(driver_id_window(true)); };
+        s[(int)dialog_step::S1].update = []() {
             if (som_status != S1)
-                active_dialog_step = "D2";
-        } else if (active_dialog_step == "S1-1") {
+                active_dialog_step = dialog_step::D2;
+        };
+        s[(int)dialog_step::S1_1].update = []() {
             active_dialog = dialog_sequence::Settings;
-            active_dialog_step = "S1";
-        } else if (active_dialog_step == "S1-2") {
-            if (changed)
-                active_window_dmi = trn_window();
-        } else if (active_dialog_step == "S2") {
-            if (changed)
-                active_window_dmi = level_window();
+            active_dialog_step = dialog_step::S1;
+        };
+        s[(int)dialog_step::S1_1].exit = true;
+        s[(int)dialog_step::S1_2].enter = []() { show_window(trn_window()); };
+        s[(int)dialog_step::S1_2].exit = true;
+        s[(int)dialog_step::S2].enter = []() { show_window(level_window()); };
+        s[(int)dialog_step::S2].update = []() {
             if (som_status != S2) {
                 if (level == Level::N2 || level == Level::N3)
-                    active_dialog_step = "S3-1";
+                    active_dialog_step = dialog_step::S3_1;
                 else
-                    active_dialog_step = "S10";
+                    active_dialog_step = dialog_step::S10;
             }
-        } else if (active_dialog_step == "S3-1") {
-            if (changed)
-                active_window_dmi = R"({"active":"menu_radio"})"_json;
+        };
+        s[(int)dialog_step::S3_1].window = window_id::MenuRadio;
+        s[(int)dialog_step::S3_1].update = []() {
             if (som_status != S3)
-                active_dialog_step = "A31";
-        } else if (active_dialog_step == "S3-2-1") {
-            if (changed)
-                active_window_dmi = radio_window_radio_wait;
-        } else if (active_dialog_step == "S3-2-2") {
-        } else if (active_dialog_step == "S3-2-3") {
-            if (changed)
-                active_window_dmi = radio_window_radio_wait;
-        } else if (active_dialog_step == "S3-3") {
-            if (changed)
-                active_window_dmi = rbc_data_window();
+                active_dialog_step = dialog_step::A31;
+        };
+        s[(int)dialog_step::S3_2_1].window = window_id::RadioRadioWait;
+        s[(int)dialog_step::S3_2_2].exit = true;
+        s[(int)dialog_step::S3_2_3].window = window_id::RadioRadioWait;
+        s[(int)dialog_step::S3_3].enter = []() { show_window(rbc_data_window()); };
+        s[(int)dialog_step::S3_3].update = []() {
             if (som_status != S3)
-                active_dialog_step = "A31";
-        } else if (active_dialog_step == "S4") {
-            if (changed)
-                active_window_dmi = main_window_radio_wait;
-        } else if (active_dialog_step == "A29") {
-            active_dialog_step = "S10";
-        } else if (active_dialog_step == "A31") {
-            if (changed)
-                active_window_dmi = main_window_radio_wait;
+                active_dialog_step = dialog_step::A31;
+        };
+        s[(int)dialog_step::S3_3].exit = true;
+        s[(int)dialog_step::S4].window = window_id::MainRadioWait;
+        s[(int)dialog_step::A29].update = []() { active_dialog_step = dialog_step::S10; };
+        s[(int)dialog_step::A31].window = window_id::MainRadioWait;
+        s[(int)dialog_step::A31].update = []() {
             if (som_status != A31)
-                active_dialog_step = "D31";
-        } else if (active_dialog_step == "A32") {
-            active_dialog_step = "S10";
-        } else if (active_dialog_step == "A40") {
+                active_dialog_step = dialog_step::D31;
+        };
+        s[(int)dialog_step::A32].update = []() { active_dialog_step = dialog_step::S10; };
+        s[(int)dialog_step::A40].update = []() {
             add_message(text_message(get_text("Train is rejected"), true, false, 0, [](text_message &t){return any_button_pressed;})); // TODO
-            active_dialog_step = "S10";
-        } else if (active_dialog_step == "D2") {
+            active_dialog_step = dialog_step::S10;
+        };
+        s[(int)dialog_step::D2].update = []() {
             if (level_valid)
-                active_dialog_step = "D3";
+                active_dialog_step = dialog_step::D3;
             else
-                active_dialog_step = "S2";
-        } else if (active_dialog_step == "D3") {
+                active_dialog_step = dialog_step::S2;
+        };
+        s[(int)dialog_step::D3].update = []() {
             if (level == Level::N2 || level == Level::N3)
-                active_dialog_step = "D7";
+                active_dialog_step = dialog_step::D7;
             else
-                active_dialog_step = "S10";
-        } else if (active_dialog_step == "D7") {
-            bool registered = false;
-            for (mobile_terminal &t : mobile_terminals) {
-                if (t.registered) {
-                    registered = true;
-                    break;
-                }
-            }
-            if (registered)
-                active_dialog_step = "A31";
+                active_dialog_step = dialog_step::S10;
+        };
+        s[(int)dialog_step::D7].update = []() {
+            if (any_mobile_registered())
+                active_dialog_step = dialog_step::A31;
             else
-                active_dialog_step = "S4";
-        } else if (active_dialog_step == "D31") {
+                active_dialog_step = dialog_step::S4;
+        };
+        s[(int)dialog_step::D31].update = []() {
             if (supervising_rbc && supervising_rbc->status == session_status::Established)
-                active_dialog_step = "D32";
+                active_dialog_step = dialog_step::D32;
             else
-                active_dialog_step = "A32";
-        } else if (active_dialog_step == "D32") {
+                active_dialog_step = dialog_step::A32;
+        };
+        s[(int)dialog_step::D32].update = []() {
             if (som_status == A40)
-                active_dialog_step = "A40";
+                active_dialog_step = dialog_step::A40;
             if (som_status == S10)
-                active_dialog_step = "S10";
-        } else if (active_dialog_step == "S10") {
+                active_dialog_step = dialog_step::S10;
+        };
+        s[(int)dialog_step::S10].update = []() {
             active_dialog = dialog_sequence::Main;
-            active_dialog_step = "S1";
-        }
-        active_window_dmi["enabled"]["Exit"] = active_dialog_step == "S1-1" || active_dialog_step == "S1-2" || active_dialog_step == "S3-2-2" || active_dialog_step == "S3-3";
-    } else if (active_dialog == dialog_sequence::Main) {
-        if (active_dialog_step == "S1") {
-            if (changed)
-                active_window_dmi = R"({"active":"menu_main"})"_json;
-        } else if (active_dialog_step == "S2") {
-            if (changed)
-                active_window_dmi = driver_id_window(false);
-        } else if (active_dialog_step == "S3-1") {
-            if (changed) {
-                if (data_entry_type == 0)
-                    flexible_data_entry = true;
-                else if (data_entry_type == 1)
-                    flexible_data_entry = false;
-                if (flexible_data_entry)
-                    active_window_dmi = train_data_window();
-                else
-                    active_window_dmi = fixed_train_data_window();
-            }
-        } else if (active_dialog_step == "S3-2") {
-            //active_window_dmi = fixed_train_data_validation_window();
-        } else if (active_dialog_step == "S3-3") {
-            if (changed)
-                active_window_dmi = trn_window();
-        } else if (active_dialog_step == "S4") {
-            if (changed)
-                active_window_dmi = level_window();
-        } else if (active_dialog_step == "S5-1") {
-            if (changed)
-                active_window_dmi = R"({"active":"menu_radio"})"_json;
-        } else if (active_dialog_step == "S5-2-1") {
-            if (changed)
-                active_window_dmi = radio_window_radio_wait;
-        } else if (active_dialog_step == "S5-2-2") {
-        } else if (active_dialog_step == "S5-2-3") {
-            if (changed)
-                active_window_dmi = radio_window_radio_wait;
-        } else if (active_dialog_step == "S5-3") {
-            if (changed)
-                active_window_dmi = rbc_data_window();
-        } else if (active_dialog_step == "S6") {
-            if (changed)
-                active_window_dmi = trn_window();
-        } else if (active_dialog_step == "S7") {
-            if (changed)
-                active_window_dmi = main_window_radio_wait;
+            active_dialog_step = dialog_step::S1;
+        };
+    }
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::Main, true, true);
+        auto &s = t.states;
+        s[(int)dialog_step::S1].window = window_id::MenuMain;
+        s[(int)dialog_step::S2].enter = []() { show_window(driver_id_window(false)); };
+        s[(int)dialog_step::S3_1].enter = []() {
+            if (data_entry_type == 0)
+                flexible_data_entry = true;
+            else if (data_entry_type == 1)
+                flexible_data_entry = false;
+            if (flexible_data_entry)
+                show_window(train_data_window());
+            else
+                show_window(fixed_train_data_window());
+        };
+        s[(int)dialog_step::S3_3].enter = []() { show_window(trn_window()); };
+        s[(int)dialog_step::S4].enter = []() { show_window(level_window()); };
+        s[(int)dialog_step::S5_1].window = window_id::MenuRadio;
+        s[(int)dialog_step::S5_2_1].window = window_id::RadioRadioWait;
+        s[(int)dialog_step::S5_2_1].exit = false;
+        s[(int)dialog_step::S5_2_3].window = window_id::RadioRadioWait;
+        s[(int)dialog_step::S5_2_3].exit = false;
+        s[(int)dialog_step::S5_3].enter = []() { show_window(rbc_data_window()); };
+        s[(int)dialog_step::S6].enter = []() { show_window(trn_window()); };
+        s[(int)dialog_step::S7].window = window_id::MainRadioWait;
+        s[(int)dialog_step::S7].update = []() {
             if (!supervising_rbc || supervising_rbc->status == session_status::Inactive)
-                active_dialog_step = "S1";
-        } else if (active_dialog_step == "S8") {
-            if (changed)
-                active_window_dmi = main_window_radio_wait;
+                active_dialog_step = dialog_step::S1;
+        };
+        s[(int)dialog_step::S7].exit = false;
+        s[(int)dialog_step::S8].window = window_id::MainRadioWait;
+        s[(int)dialog_step::S8].update = []() {
             if (!supervising_rbc || supervising_rbc->status != session_status::Establishing)
-                active_dialog_step = "D3";
-        } else if (active_dialog_step == "S9") {
-            if (changed)
-                active_window_dmi = main_window_radio_wait;
+                active_dialog_step = dialog_step::D3;
+        };
+        s[(int)dialog_step::S8].exit = false;
+        s[(int)dialog_step::S9].window = window_id::MainRadioWait;
+        s[(int)dialog_step::S9].update = []() {
             if (!supervising_rbc || supervising_rbc->status == session_status::Inactive || !supervising_rbc->train_data_ack_pending)
-                active_dialog_step = "S1";
-        } else if (active_dialog_step == "D1") {
+                active_dialog_step = dialog_step::S1;
+        };
+        s[(int)dialog_step::S9].exit = false;
+        s[(int)dialog_step::D1].update = []() {
             if (supervising_rbc) {
                 supervising_rbc->train_data_ack_pending = true;
                 supervising_rbc->train_data_ack_sent = false;
                 supervising_rbc->train_running_number_sent = false;
             }
             if (level == Level::N2 || level == Level::N3)
-                active_dialog_step = "D2";
+                active_dialog_step = dialog_step::D2;
             else
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
             if (train_data_valid && som_active) {
                 for (auto kvp : installed_stms) {
                     auto *stm = kvp.second;
@@ -480,49 +548,56 @@ void update_dmi_windows()
                         send_failed_msg(stm);
                 }
             }
-        } else if (active_dialog_step == "D2") {
+        };
+        s[(int)dialog_step::D2].update = []() {
             if (supervising_rbc && supervising_rbc->status == session_status::Established)
-                active_dialog_step = "S9";
+                active_dialog_step = dialog_step::S9;
             else
-                active_dialog_step = "S1";
-        } else if (active_dialog_step == "D3") {
+                active_dialog_step = dialog_step::S1;
+        };
+        s[(int)dialog_step::D3].update = []() {
             if (supervising_rbc && supervising_rbc->status == session_status::Established)
-                active_dialog_step = "D4";
+                active_dialog_step = dialog_step::D4;
             else if (!supervising_rbc || supervising_rbc->status == session_status::Inactive)
-                active_dialog_step = "S1";
-        } else if (active_dialog_step == "D4") {
+                active_dialog_step = dialog_step::S1;
+        };
+        s[(int)dialog_step::D4].update = []() {
             if (som_active) {
                 active_dialog = dialog_sequence::StartUp;
-                active_dialog_step = "D32";
+                active_dialog_step = dialog_step::D32;
                 som_status = D32;
             } else {
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
             }
-        } else if (active_dialog_step == "D5") {
+        };
+        s[(int)dialog_step::D5].update = []() {
             if (rbc_contact && rbc_contact_valid) {
                 set_supervising_rbc(*rbc_contact);
                 supervising_rbc->open(N_tries_radio);
-                active_dialog_step = "S8";
+                active_dialog_step = dialog_step::S8;
             } else {
-                active_dialog_step = "S5-1";
+                active_dialog_step = dialog_step::S5_1;
             }
-        } else if (active_dialog_step == "D6") {
+        };
+        s[(int)dialog_step::D6].update = []() {
             if (train_running_number_valid)
-                active_dialog_step = "D1";
+                active_dialog_step = dialog_step::D1;
             else
-                active_dialog_step = "S3-3";
-        } else if (active_dialog_step == "D7") {
+                active_dialog_step = dialog_step::S3_3;
+        };
+        s[(int)dialog_step::D7].update = []() {
             if (supervising_rbc && supervising_rbc->status == session_status::Established)
-                active_dialog_step = "S7";
+                active_dialog_step = dialog_step::S7;
             else
                 active_dialog = dialog_sequence::None;
-        }
-        active_window_dmi["enabled"]["Exit"] = active_dialog_step != "S5-2-1" && active_dialog_step != "S5-2-3" && active_dialog_step != "S7" && active_dialog_step != "S8" && active_dialog_step != "S9";
-    } else if (active_dialog == dialog_sequence::NTCData) {
-        if (active_dialog_step == "S1") {
-            if (changed)
-                active_window_dmi = ntc_menu(true);
-            bool waiting;
+        };
+    }
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::NTCData, true, true);
+        auto &s = t.states;
+        s[(int)dialog_step::S1].enter = []() { show_window(ntc_menu(true), window_id::MenuNTC); };
+        s[(int)dialog_step::S1].update = []() {
+            bool waiting = false;
             for (auto &kvp : installed_stms) {
                 auto *stm = kvp.second;
                 if (stm->data_entry == stm_object::data_entry_state::Start) {
@@ -531,10 +606,11 @@ void update_dmi_windows()
                 }
             }
             if (!waiting)
-             active_dialog_step = "S2";
-        } else if (active_dialog_step == "S2") {
-            if (changed)
-                active_window_dmi = ntc_menu(false);
+                active_dialog_step = dialog_step::S2;
+        };
+        s[(int)dialog_step::S1].exit = false;
+        s[(int)dialog_step::S2].enter = []() { show_window(ntc_menu(false), window_id::MenuNTC); };
+        s[(int)dialog_step::S2].update = []() {
             bool remaining = false;
             for (auto kvp : installed_stms) {
                 auto *stm = kvp.second;
@@ -545,9 +621,10 @@ void update_dmi_windows()
             }
             if (!remaining) {
                 active_dialog = dialog_sequence::Main;
-                active_dialog_step = "D6";
+                active_dialog_step = dialog_step::D6;
             }
-        } else if (active_dialog_step == "D1") {
+        };
+        s[(int)dialog_step::D1].update = []() {
             bool needsdata = false;
             for (auto &kvp : installed_stms) {
                 auto *stm = kvp.second;
@@ -557,17 +634,15 @@ void update_dmi_windows()
                 }
             }
             if (needsdata) {
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
             } else {
                 active_dialog = dialog_sequence::Main;
-                active_dialog_step = "D6";
+                active_dialog_step = dialog_step::D6;
             }
-        } else if (active_dialog_step == "S3-1") {
-            if (changed)
-                active_window_dmi = ntc_data_window();
-        } else if (active_dialog_step == "S4") {
-            if (changed)
-                active_window_dmi = ntc_menu(true);
+        };
+        s[(int)dialog_step::S3_1].enter = []() { show_window(ntc_data_window()); };
+        s[(int)dialog_step::S4].enter = []() { show_window(ntc_menu(true), window_id::MenuNTC); };
+        s[(int)dialog_step::S4].update = []() {
             bool wait = false;
             for (auto kvp : installed_stms) {
                 auto *stm = kvp.second;
@@ -577,73 +652,85 @@ void update_dmi_windows()
                 }
             }
             if (!wait)
-                active_dialog_step = "S2";
-        }
-        active_window_dmi["enabled"]["Exit"] = active_dialog_step != "S1" && active_dialog_step != "S4";
-    } else if (active_dialog == dialog_sequence::Override) {
-        if (active_dialog_step == "S1")
-            if (changed)
-                active_window_dmi = R"({"active":"menu_override"})"_json;
-    } else if (active_dialog == dialog_sequence::Shunting) {
-        if (active_dialog_step == "D1") {
+                active_dialog_step = dialog_step::S2;
+        };
+        s[(int)dialog_step::S4].exit = false;
+    }
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::Override, false, false);
+        t.states[(int)dialog_step::S1].window = window_id::MenuOverride;
+    }
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::Shunting, false, false);
+        auto &s = t.states;
+        s[(int)dialog_step::D1].update = []() {
             if (level == Level::N2 || level == Level::N3) {
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
             } else/* if (level == level::N0 || level == level::N1) */{
                 active_dialog = dialog_sequence::None;
             }
-        } else if (active_dialog_step == "S1") {
-            if (changed)
-                active_window_dmi = main_window_radio_wait;
+        };
+        s[(int)dialog_step::S1].window = window_id::MainRadioWait;
+        s[(int)dialog_step::S1].update = []() {
             if (!supervising_rbc || supervising_rbc->status != session_status::Established) {
                 active_dialog = dialog_sequence::Main;
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
                 add_message(text_message(get_text("Shunting request failed"), true, false, 0, [](text_message &t){return any_button_pressed;}));
             }
-        }
-    } else if (active_dialog == dialog_sequence::DataView) {
-        if (changed)
-                active_window_dmi = data_view_window();
-    } else if (active_dialog == dialog_sequence::Special) {
-        if (active_dialog_step == "S1") {
-            if (changed)
-                active_window_dmi = R"({"active":"menu_spec"})"_json;
-        } else if (active_dialog_step == "S2") {
-            if (changed)
-                active_window_dmi = adhesion_window();
-        } else if (active_dialog_step == "S3") {
-            if (changed)
-                active_window_dmi = sr_data_window();
-        }
-    } else if (active_dialog == dialog_sequence::Settings) {
-        if (active_dialog_step == "S1") {
-            if (changed)
-                active_window_dmi = R"({"active":"menu_settings"})"_json;
-        } else if (active_dialog_step == "S2") {
-            if (changed)
-                active_window_dmi = language_window();
-        } else if (active_dialog_step == "S3") {
-            if (changed)
-                active_window_dmi = R"({"active":"volume_window"})"_json;
-        } else if (active_dialog_step == "S4") {
-            if (changed)
-                active_window_dmi = R"({"active":"brightness_window"})"_json;
-        } else if (active_dialog_step == "S5") {
-            if (changed)
-                active_window_dmi = system_version_window();
-        } else if (active_dialog_step == "S6-1") {
-            if (changed)
-                active_window_dmi = set_vbc_window();
-        } else if (active_dialog_step == "S6-2") {
-
-        } else if (active_dialog_step == "S7-1") {
-            if (changed)
-                active_window_dmi = remove_vbc_window();
-        } else if (active_dialog_step == "S7-2") {
-
-        }
+        };
     }
-    std::string active = active_window_dmi["active"];
-    if (active == "menu_main" && !active_window_dmi.contains("hour_glass")) {
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::DataView, false, false);
+        for (auto &s : t.states)
+            s.enter = []() { show_window(data_view_window()); };
+    }
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::Special, false, false);
+        auto &s = t.states;
+        s[(int)dialog_step::S1].window = window_id::MenuSpecial;
+        s[(int)dialog_step::S2].enter = []() { show_window(adhesion_window()); };
+        s[(int)dialog_step::S3].enter = []() { show_window(sr_data_window()); };
+    }
+    {
+        dialog_sequence_table &t = sequence(dialog_sequence::Settings, false, false);
+        auto &s = t.states;
+        s[(int)dialog_step::S1].window = window_id::MenuSettings;
+        s[(int)dialog_step::S2].enter = []() { show_window(language_window()); };
+        s[(int)dialog_step::S3].window = window_id::Volume;
+        s[(int)dialog_step::S4].window = window_id::Brightness;
+        s[(int)dialog_step::S5].enter = []() { show_window(system_version_window()); };
+        s[(int)dialog_step::S6_1].enter = []() { show_window(set_vbc_window()); };
+        s[(int)dialog_step::S7_1].enter = []() { show_window(remove_vbc_window()); };
+    }
+    return tables;
+}
+EVC_STATE static dialog_sequence prev_dialog;
+EVC_STATE static dialog_step prev_step;
+void update_dmi_windows()
+{
+    static const std::vector<dialog_sequence_table> dialog_tables = build_dialog_tables();
+    any_button_pressed = any_button_pressed_async;
+    any_button_pressed_async = false;
+    bool changed = prev_dialog != active_dialog || prev_step != active_dialog_step;
+    prev_dialog = active_dialog;
+    prev_step = active_dialog_step;
+    const dialog_sequence_table &table = dialog_tables[(int)active_dialog];
+    const dialog_state &state = table.states[(int)active_dialog_step];
+    if (changed) {
+        if (state.window != window_id::None)
+            show_window(state.window);
+        if (state.enter != nullptr)
+            state.enter();
+    }
+    if (table.update != nullptr)
+        table.update();
+    if (state.update != nullptr)
+        state.update();
+    if (table.manages_exit)
+        active_window_dmi["enabled"]["Exit"] = table.states[(int)active_dialog_step].exit;
+    switch (active_window_id) {
+    case window_id::MenuMain:
+    {
         json &enabled = active_window_dmi["enabled"];
         bool c1 = V_est == 0 && mode == Mode::SB && train_data_valid && level != Level::Unknown;
         bool c2 = V_est == 0 && mode == Mode::PT && train_data_valid && (level == Level::N1 || ((level == Level::N2 || level == Level::N3) && trip_exit_acknowledged && supervising_rbc && supervising_rbc->status == session_status::Established && emergency_stops.empty()));
@@ -665,15 +752,12 @@ void update_dmi_windows()
         enabled["Non Leading"] = false;
         enabled["Radio Data"] = V_est == 0 && driver_id_valid && level_valid &&
             (mode == Mode::SB || mode == Mode::FS || mode == Mode::LS || mode == Mode::SR || mode == Mode::OS || mode == Mode::NL || mode == Mode::PT || mode == Mode::UN || mode == Mode::SN);;
-    } else if (active == "menu_radio" && !active_window_dmi.contains("hour_glass")) {
+        break;
+    }
+    case window_id::MenuRadio:
+    {
         json &enabled = active_window_dmi["enabled"];
-        bool registered = false;
-        for (mobile_terminal &t : mobile_terminals) {
-            if (t.registered) {
-                registered = true;
-                break;
-            }
-        }
+        bool registered = any_mobile_registered();
         enabled["Contact last RBC"] = V_est == 0 && driver_id_valid && 
             (mode == Mode::SB || mode == Mode::FS || mode == Mode::LS || mode == Mode::SR || mode == Mode::OS || mode == Mode::NL || mode == Mode::PT) && 
             level_valid && (level == Level::N2 || level == Level::N3) && registered && rbc_contact;
@@ -686,14 +770,21 @@ void update_dmi_windows()
         enabled["Radio Network ID"] = V_est == 0 && driver_id_valid && 
             (mode == Mode::SB || mode == Mode::FS || mode == Mode::LS || mode == Mode::SR || mode == Mode::OS || mode == Mode::NL || mode == Mode::PT) && 
             level_valid;
-    } else if (active == "menu_override") {
+        break;
+    }
+    case window_id::MenuOverride:
         active_window_dmi["enabled"]["EoA"] = V_est <= V_NVALLOWOVTRP && (((mode == Mode::FS || mode == Mode::OS || mode == Mode::LS || mode == Mode::SR || mode == Mode::UN || mode == Mode::PT || mode == Mode::SB || mode == Mode::SN) && train_data_valid) || mode == Mode::SH);
-    } else if (active == "menu_spec") {
+        break;
+    case window_id::MenuSpecial:
+    {
         json &enabled = active_window_dmi["enabled"];
         enabled["Adhesion"] = (V_est == 0 && mode == Mode::SB && Q_NVDRIVER_ADHES && driver_id_valid && train_data_valid && level_valid) || (Q_NVDRIVER_ADHES && (mode == Mode::FS || mode == Mode::LS || mode == Mode::SR || mode == Mode::OS || mode == Mode::UN || mode == Mode::SN));
         enabled["SRspeed"] = V_est == 0 && mode == Mode::SR;
         enabled["TrainIntegrity"] = V_est == 0 && (mode == Mode::SB || mode == Mode::FS || mode == Mode::LS || mode == Mode::SR || mode == Mode::OS || mode == Mode::PT) && driver_id_valid && train_data_valid && level_valid;
-    } else if (active == "menu_settings") {
+        break;
+    }
+    case window_id::MenuSettings:
+    {
         bool c = (V_est == 0 && mode == Mode::SB) || (mode == Mode::SH || mode == Mode::FS || mode == Mode::LS || mode == Mode::SR || mode == Mode::OS || mode == Mode::NL || mode == Mode::UN || mode == Mode::TR || mode == Mode::PT || mode == Mode::SN || mode == Mode::RV);
         active_window_dmi["enabled"]["Language"] = c;
         active_window_dmi["enabled"]["Volume"] = c;
@@ -701,12 +792,17 @@ void update_dmi_windows()
         active_window_dmi["enabled"]["SystemVersion"] = c;
         active_window_dmi["enabled"]["SetVBC"] = V_est == 0 && mode == Mode::SB;
         active_window_dmi["enabled"]["RemoveVBC"] = V_est == 0 && mode == Mode::SB && !vbcs.empty();
-    } else if (active == "menu_ntc") {
+        break;
+    }
+    case window_id::MenuNTC:
         for (auto &kvp : installed_stms) {
             auto *stm = kvp.second;
             active_window_dmi["enabled"][get_ntc_name(kvp.first)] = stm->data_entry == stm_object::data_entry_state::Active;
         }
-        active_window_dmi["enabled"]["EndDataEntry"] = active_dialog_step != "S1" && active_dialog_step != "S4";
+        active_window_dmi["enabled"]["EndDataEntry"] = active_dialog_step != dialog_step::S1 && active_dialog_step != dialog_step::S4;
+        break;
+    default:
+        break;
     }
 }
 void close_window()
@@ -715,34 +811,34 @@ void close_window()
     if (active == "menu_main" || active == "menu_override" || active == "data_view_window" || active == "menu_spec")
         active_dialog = dialog_sequence::None;
     else if (active == "trn_window" || active == "driver_window") {
-        active_dialog_step = "S1";   
+        active_dialog_step = dialog_step::S1;   
     } else if (active == "fixed_train_data_window" || active == "level_window" || active == "fixed_train_data_validation_window" || active == "train_data_window" || active == "train_data_validation_window")
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     else if (active == "menu_ntc") {
         active_dialog = dialog_sequence::Main;
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     } else if (active == "ntc_data_window" || active == "ntc_data_validation_window") {
-        active_dialog_step = "S2";
+        active_dialog_step = dialog_step::S2;
         for (auto &kvp : installed_stms) {
             auto *stm = kvp.second;
             if (stm->data_entry == stm_object::data_entry_state::Driver)
                 stm->data_entry = stm_object::data_entry_state::Active;
         }
     } else if (active == "menu_radio")
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     else if (active == "rbc_data_window")
-        active_dialog_step = "S5-1";
+        active_dialog_step = dialog_step::S5_1;
     else if (active == "menu_settings") {
         if (som_active && som_status == S1) {
             active_dialog = dialog_sequence::StartUp;
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
         } else {
             active_dialog = dialog_sequence::None;
         }
     } else if (active == "adhesion_window" || active == "sr_data_window") {
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     } else if (active == "language_window" || active == "volume_window" || active == "brightness_window" || active == "system_version_window" || active == "set_vbc_window" || active == "set_vbc_validation_window" || active == "remove_vbc_window" || active == "remove_vbc_validation_window") {
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     }
 }
 void validate_data_entry(std::string name, json &result)
@@ -770,9 +866,9 @@ void validate_data_entry(std::string name, json &result)
         driver_set_level({lv, nid_ntc});
         if (active_dialog == dialog_sequence::Main) {
             if (level == Level::N2 || level == Level::N3) {
-                active_dialog_step = "D5";
+                active_dialog_step = dialog_step::D5;
             } else {
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
             }
         }
     } else if (name == get_text("Train running number")) {
@@ -787,31 +883,31 @@ void validate_data_entry(std::string name, json &result)
             return;
         }
         if (active_dialog == dialog_sequence::Main) {
-            if (active_dialog_step == "S6") {
-                active_dialog_step = "S1";
+            if (active_dialog_step == dialog_step::S6) {
+                active_dialog_step = dialog_step::S1;
                 if (supervising_rbc)
                     supervising_rbc->train_running_number_sent = false;
             } else
-                active_dialog_step = "D1";
+                active_dialog_step = dialog_step::D1;
         } else if (active_dialog == dialog_sequence::StartUp) {
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
         }
     } else if (name == get_text("Train data")) {
-        active_dialog_step = "S3-2";
+        active_dialog_step = dialog_step::S3_2;
         json j = R"({"active":"train_data_validation_window"})"_json;
         json def;
         def["WindowType"] = "DataValidation";
         def["WindowTitle"] = get_text("Validate train data");
         def["DataInputResult"] = result;
         j["WindowDefinition"] = def;
-        active_window_dmi = j;
+        show_window(j);
     } else if (name == get_text("Validate train data")) {
         if (!result["Validated"]) {
-            prev_step = active_dialog_step = "S3-1";
+            prev_step = active_dialog_step = dialog_step::S3_1;
             if (flexible_data_entry)
-                active_window_dmi = train_data_window();
+                show_window(train_data_window());
             else
-                active_window_dmi = fixed_train_data_window();
+                show_window(fixed_train_data_window());
             for (auto it = result.begin(); it != result.end(); ++it) {
                 for (json &j : active_window_dmi["WindowDefinition"]["Inputs"]) {
                     if (j["Label"] == it.key())
@@ -894,10 +990,10 @@ void validate_data_entry(std::string name, json &result)
             recalculate_MRSP();
             if (train_data_valid) {
                 active_dialog = dialog_sequence::NTCData;
-                active_dialog_step = "D1";
+                active_dialog_step = dialog_step::D1;
                 stm_send_train_data();
             } else {
-                active_dialog_step = "S1";
+                active_dialog_step = dialog_step::S1;
             }
         }
     } else if (name == get_text("Driver ID")) {
@@ -906,9 +1002,9 @@ void validate_data_entry(std::string name, json &result)
             return;
         driver_id_valid = true;
         if (active_dialog == dialog_sequence::StartUp)
-            active_dialog_step = "D2";
+            active_dialog_step = dialog_step::D2;
         else if (active_dialog == dialog_sequence::Main)
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
     } else if (name == get_text("RBC data")) {
         uint32_t id = atoll(result[get_text("RBC ID")].get<std::string>().c_str());
         uint64_t number = atoll(result[get_text("RBC phone number")].get<std::string>().c_str());
@@ -918,12 +1014,12 @@ void validate_data_entry(std::string name, json &result)
         } else {
             if (supervising_rbc)
                 supervising_rbc->open(N_tries_radio);
-            active_dialog_step = "S8";
+            active_dialog_step = dialog_step::S8;
         }
     } else if (name == get_text("Language")) {
         set_language(result[""]);
         if (active_dialog == dialog_sequence::Settings)
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
     } else if (name == get_text("SR speed/distance")) {
         if (mode == Mode::SR) {
             double v = stod(result[get_text("SR speed (km/h)")].get<std::string>())/3.6;
@@ -932,32 +1028,32 @@ void validate_data_entry(std::string name, json &result)
             SR_speed = speed_restriction(v, distance(std::numeric_limits<double>::lowest(), 0, 0), *SR_dist, false);
             recalculate_MRSP();
         }
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     } else if (name == get_text("Adhesion")) {
         slippery_rail_driver = result[""] == get_text("Slippery rail");
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     } else if (name == get_text("Set VBC")) {
-        active_dialog_step = "S6-2";
+        active_dialog_step = dialog_step::S6_2;
         json j = R"({"active":"set_vbc_validation_window"})"_json;
         json def;
         def["WindowType"] = "DataValidation";
         def["WindowTitle"] = get_text("Validate set VBC");
         def["DataInputResult"] = result;
         j["WindowDefinition"] = def;
-        active_window_dmi = j;
+        show_window(j);
     } else if (name == get_text("Remove VBC")) {
-        active_dialog_step = "S7-2";
+        active_dialog_step = dialog_step::S7_2;
         json j = R"({"active":"remove_vbc_validation_window"})"_json;
         json def;
         def["WindowType"] = "DataValidation";
         def["WindowTitle"] = get_text("Validate remove VBC");
         def["DataInputResult"] = result;
         j["WindowDefinition"] = def;
-        active_window_dmi = j;
+        show_window(j);
     } else if (name == get_text("Validate set VBC")) {
         if (!result["Validated"]) {
-            prev_step = active_dialog_step = "S6-1";
-            active_window_dmi = set_vbc_window();
+            prev_step = active_dialog_step = dialog_step::S6_1;
+            show_window(set_vbc_window());
             for (auto it = result.begin(); it != result.end(); ++it) {
                 for (json &j : active_window_dmi["WindowDefinition"]["Inputs"]) {
                     if (j["Label"] == it.key())
@@ -969,12 +1065,12 @@ void validate_data_entry(std::string name, json &result)
             std::string t = get_text("VBC code");
             uint32_t num = stoi(result[get_text("VBC code")].get<std::string>());
             set_vbc({(int)(num>>6) & 1023, (int)(num & 63), (num>>16)*86400000LL+get_milliseconds()});
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
         }
     } else if (name == get_text("Validate remove VBC")) {
         if (!result["Validated"]) {
-            prev_step = active_dialog_step = "S7-1";
-            active_window_dmi = remove_vbc_window();
+            prev_step = active_dialog_step = dialog_step::S7_1;
+            show_window(remove_vbc_window());
             for (auto it = result.begin(); it != result.end(); ++it) {
                 for (json &j : active_window_dmi["WindowDefinition"]["Inputs"]) {
                     if (j["Label"] == it.key())
@@ -985,29 +1081,29 @@ void validate_data_entry(std::string name, json &result)
         } else {
             uint32_t num = stoi(result[get_text("VBC code")].get<std::string>());
             remove_vbc({(int)(num>>6) & 1023, (int)(num & 63), (num>>16)*86400000LL+get_milliseconds()});
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
         }
     } else if (name == get_text("Brightness")) {
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     } else if (name == get_text("Volume")) {
-        active_dialog_step = "S1";
+        active_dialog_step = dialog_step::S1;
     } else {
         for (auto &kvp : installed_stms) {
             auto *stm = kvp.second;
             if (stm->data_entry == stm_object::data_entry_state::Driver) {
                 if ((name == get_ntc_name(kvp.first)+get_text(" data"))) {
-                    active_dialog_step = "S3-2";
+                    active_dialog_step = dialog_step::S3_2;
                     json j = R"({"active":"ntc_data_validation_window"})"_json;
                     json def;
                     def["WindowType"] = "DataValidation";
                     def["WindowTitle"] = get_text("Validate ")+get_ntc_name(kvp.first)+get_text(" data");
                     def["DataInputResult"] = result;
                     j["WindowDefinition"] = def;
-                    active_window_dmi = j;
+                    show_window(j);
                 } else if ((name == get_text("Validate ")+get_ntc_name(kvp.first)+get_text(" data"))) {
                     if (!result["Validated"]) {
-                        prev_step = active_dialog_step = "S3-1";
-                        active_window_dmi = ntc_data_window();
+                        prev_step = active_dialog_step = dialog_step::S3_1;
+                        show_window(ntc_data_window());
                         for (auto it = result.begin(); it != result.end(); ++it) {
                             for (json &j : active_window_dmi["WindowDefinition"]["Inputs"]) {
                                 if (j["Label"] == it.key())
@@ -1017,7 +1113,7 @@ void validate_data_entry(std::string name, json &result)
                         return;
                     } else {
                         stm->send_specific_data(result);
-                        active_dialog_step = "S4";
+                        active_dialog_step = dialog_step::S4;
                     }
                 }
             }
@@ -1071,61 +1167,61 @@ void validate_entry_field(std::string window, json &result)
 void update_dialog_step(std::string step, std::string step2)
 {
     dialog_sequence prev_seq = active_dialog;
-    std::string prev_step = active_dialog_step;
+    dialog_step prev_step = active_dialog_step;
     if (active_dialog == dialog_sequence::None) {
         if (step2 == "main") {
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
             active_dialog = dialog_sequence::Main;
         } else if (step2 == "override") {
             active_dialog = dialog_sequence::Override;
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
         } else if (step2 == "data_view") {
             active_dialog = dialog_sequence::DataView;
         } else if (step2 == "spec") {
             active_dialog = dialog_sequence::Special;
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
         } else if (step2 == "settings") {
             active_dialog = dialog_sequence::Settings;
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
         }
     } else if (active_dialog == dialog_sequence::StartUp) {
         if (step2 == "settings") {
-            active_dialog_step = "S1-1";
+            active_dialog_step = dialog_step::S1_1;
         } else if (step == "TrainRunningNumber") {
-            active_dialog_step = "S1-2";
+            active_dialog_step = dialog_step::S1_2;
         } else if (step == "ContactLastRBC" || step == "UseShortNumber") {
             set_supervising_rbc(step == "ContactLastRBC" ? contact_info({0,NID_RBC_t::ContactLastRBC,0}) : contact_info({0,0,NID_RADIO_t::UseShortNumber}));
             som_status = A31;
         } else if (step == "EnterRBCdata") {
-            active_dialog_step = "S3-3";
+            active_dialog_step = dialog_step::S3_3;
         }
     } else if (active_dialog == dialog_sequence::Main) {
         if (step == "Start") {
             start_pressed();
             if ((level == Level::N2 || level == Level::N3) && supervising_rbc && supervising_rbc->status == session_status::Established) {
-                active_dialog_step = "S7";
+                active_dialog_step = dialog_step::S7;
             } else {
                 active_dialog = dialog_sequence::None;
             }
         } else if (step == "Level") {
-            active_dialog_step = "S4";
+            active_dialog_step = dialog_step::S4;
         } else if (step == "RadioData") {
-            active_dialog_step = "S5-1";
+            active_dialog_step = dialog_step::S5_1;
         } else if (step == "DriverID") {
-            active_dialog_step = "S2";
+            active_dialog_step = dialog_step::S2;
         } else if (step == "TrainRunningNumber") {
-            active_dialog_step = "S6";
+            active_dialog_step = dialog_step::S6;
         } else if (step == "TrainData") {
-            active_dialog_step = "S3-1";
+            active_dialog_step = dialog_step::S3_1;
         } else if (step == "SelectType") {
             if (data_entry_type == 2) {
                 flexible_data_entry = false;
-                active_window_dmi = fixed_train_data_window();
+                show_window(fixed_train_data_window());
             }
         } else if (step == "EnterData") {
             if (data_entry_type == 2) {
                 flexible_data_entry = true;
-                active_window_dmi = train_data_window();
+                show_window(train_data_window());
             }
         } else if (step == "Shunting") {
             if (V_est == 0 && mode == Mode::SH) {
@@ -1153,7 +1249,7 @@ void update_dialog_step(std::string step, std::string step2)
                 active_dialog = dialog_sequence::None;
             } else {
                 active_dialog = dialog_sequence::Shunting;
-                active_dialog_step = "D1";
+                active_dialog_step = dialog_step::D1;
             }
         } else if (step == "MaintainShunting" || step == "NonLeading") {
             active_dialog = dialog_sequence::None;
@@ -1161,20 +1257,20 @@ void update_dialog_step(std::string step, std::string step2)
             set_supervising_rbc(step == "ContactLastRBC" ? contact_info({0,NID_RBC_t::ContactLastRBC,0}) : contact_info({0,0,NID_RADIO_t::UseShortNumber}));
             if (supervising_rbc)
                 supervising_rbc->open(N_tries_radio);
-            active_dialog_step = "S8";
+            active_dialog_step = dialog_step::S8;
         } else if (step == "EnterRBCdata") {
-            active_dialog_step = "S5-3";
+            active_dialog_step = dialog_step::S5_3;
         }
     } else if (active_dialog == dialog_sequence::NTCData) {
         if (step == "EndDataEntry") {
             active_dialog = dialog_sequence::Main;
-            active_dialog_step = "D6";
+            active_dialog_step = dialog_step::D6;
         } else {
             for (auto &kvp : installed_stms) {
                 auto *stm = kvp.second;
                 if (step2 == get_ntc_name(kvp.first) && stm->data_entry == stm_object::data_entry_state::Active) {
                     stm->data_entry = stm_object::data_entry_state::Driver;
-                    active_dialog_step = "S3-1";
+                    active_dialog_step = dialog_step::S3_1;
                 }
             }
         }
@@ -1187,7 +1283,7 @@ void update_dialog_step(std::string step, std::string step2)
         if (step == "SH refused") {
             add_message(text_message(get_text("SH refused"), true, false, 0, [](text_message &t){return any_button_pressed;}));
             active_dialog = dialog_sequence::Main;
-            active_dialog_step = "S1";
+            active_dialog_step = dialog_step::S1;
         } else if (step == "SH authorised") {
             active_dialog = dialog_sequence::None;
             if (V_est == 0 && (level == Level::N2 || level == Level::N3))
@@ -1195,25 +1291,25 @@ void update_dialog_step(std::string step, std::string step2)
         }
     } else if (active_dialog == dialog_sequence::Special) {
         if (step == "Adhesion") {
-            active_dialog_step = "S2";
+            active_dialog_step = dialog_step::S2;
         } else if (step == "SRspeed") {
-            active_dialog_step = "S3";
+            active_dialog_step = dialog_step::S3;
         } else if (step == "TrainIntegrity") {
             active_dialog = dialog_sequence::None;
         }
     } else if (active_dialog == dialog_sequence::Settings) {
         if (step == "Language")
-            active_dialog_step = "S2";
+            active_dialog_step = dialog_step::S2;
         else if (step == "Volume")
-            active_dialog_step = "S3";
+            active_dialog_step = dialog_step::S3;
         else if (step == "Brightness")
-            active_dialog_step = "S4";
+            active_dialog_step = dialog_step::S4;
         else if (step == "SystemVersion")
-            active_dialog_step = "S5";
+            active_dialog_step = dialog_step::S5;
         else if (step == "SetVBC")
-            active_dialog_step = "S6-1";
+            active_dialog_step = dialog_step::S6_1;
         else if (step == "RemoveVBC")
-            active_dialog_step = "S7-1";
+            active_dialog_step = dialog_step::S7_1;
     }
     if (active_dialog != prev_seq || active_dialog_step != prev_step) {
         any_button_pressed_async = true;
@@ -8,6 +8,7 @@
  */
 #pragma once
 #include <nlohmann/json.hpp>
+#include "../Context/state.h"
 using json = nlohmann::json;
 enum struct dialog_sequence
 {
@@ -21,9 +22,21 @@ enum struct dialog_sequence
     DataView,
     NTCData,
 };
-extern dialog_sequence active_dialog;
-extern std::string active_dialog_step;
-extern json active_window_dmi;
+/*
+ * Steps of the dialog sequences, named after the states and decisions of
+ * the sequence diagrams (S1-2 is S1_2).
+ */
+enum struct dialog_step
+{
+    S0, S1, S1_1, S1_2, S2, S3, S3_1, S3_2, S3_2_1, S3_2_2, S3_2_3, S3_3,
+    S4, S5, S5_1, S5_2_1, S5_2_2, S5_2_3, S5_3, S6, S6_1, S6_2,
+    S7, S7_1, S7_2, S8, S9, S10,
+    D1, D2, D3, D4, D5, D6, D7, D31, D32,
+    A29, A31, A32, A40,
+};
+extern EVC_STATE dialog_sequence active_dialog;
+extern EVC_STATE dialog_step active_dialog_step;
+extern EVC_STATE json active_window_dmi;
 /*extern json default_window;
 extern const json main_window_radio_wait;
 extern const json radio_window_radio_wait;*/
@@ -25,16 +25,17 @@
 #else
 #include <winsock2.h>
 #endif
-communication_session *supervising_rbc = nullptr;
-communication_session *accepting_rbc = nullptr;
-communication_session *handing_over_rbc = nullptr;
-bool handover_report_accepting = false;
-bool handover_report_min = false;
-bool handover_report_max = false;
-distance rbc_transition_position;
-safe_radio_status radio_status_driver;
-std::map<contact_info, communication_session*> active_sessions;
+EVC_STATE communication_session *supervising_rbc = nullptr;
+EVC_STATE communication_session *accepting_rbc = nullptr;
+EVC_STATE communication_session *handing_over_rbc = nullptr;
+EVC_STATE bool handover_report_accepting = false;
+EVC_STATE bool handover_report_min = false;
+EVC_STATE bool handover_report_max = false;
+EVC_STATE distance rbc_transition_position;
+EVC_STATE safe_radio_status radio_status_driver;
+EVC_STATE std::map<contact_info, communication_session*> active_sessions;
 #include <iostream>
+#include "../Context/state.h"
 void communication_session::open(int ntries)
 {
     pending_ack.remove_if([](const msg_expecting_ack &mack){return mack.nid_ack.find(-1) != mack.nid_ack.end();});     
@@ -175,10 +176,10 @@ void communication_session::update()
         }
     }
     if (terminal != nullptr) {
-        std::unique_lock<std::mutex> lck(terminal->mtx);
-        auto msgs = terminal->pending_read;
-        terminal->pending_read.clear();
-        lck.unlock();
+        std::vector<std::shared_ptr<euroradio_message>> msgs;
+        std::shared_ptr<euroradio_message> received;
+        while (terminal->receive(received))
+            msgs.push_back(received);
         for (auto it = msgs.begin(); it!=msgs.end(); ++it) {
             auto msg = *it;
             log_message(msg, d_estfront, get_milliseconds());
@@ -263,19 +264,14 @@ void communication_session::update()
                     }
                 }
                 log_message(msg.message, d_estfront, get_milliseconds());
-                if (terminal != nullptr) {
-                    {
-                        std::unique_lock<std::mutex> lck(terminal->mtx);
-                        terminal->pending_write.push_back(msg.message);
-                    }
-                    terminal->cv.notify_all();
-                }
+                if (terminal != nullptr)
+                    terminal->send(msg.message);
             }
         }
     }
 }
 
-void communication_session::send(std::shared_ptr<euroradio_message_traintotrack> msg, bool lock)
+void communication_session::send(std::shared_ptr<euroradio_message_traintotrack> msg)
 {
     msg = translate_message(msg, version);
     log_message(msg, d_estfront, get_milliseconds());
@@ -298,20 +294,13 @@ void communication_session::send(std::shared_ptr<euroradio_message_traintotrack>
         pending_ack.remove_if([msg](const msg_expecting_ack &mack){return mack.message->NID_MESSAGE == msg->NID_MESSAGE;});
         pending_ack.push_back({ack,msg,1,get_milliseconds()});
     }
-    if (radio_status == safe_radio_status::Connected && terminal != nullptr) {
-        if (lock) {
-            std::unique_lock<std::mutex> lck(terminal->mtx);
-            terminal->pending_write.push_back(msg);
-        } else {
-            terminal->pending_write.push_back(msg);
-        }
-        terminal->cv.notify_all();
-    }
+    if (radio_status == safe_radio_status::Connected && terminal != nullptr)
+        terminal->send(msg);
 }
-std::string RadioNetworkId = "GSMR-A";
-int64_t first_supervised_timestamp;
-bool radio_reaction_applied = false;
-bool radio_reaction_reconnected = false;
+EVC_STATE std::string RadioNetworkId = "GSMR-A";
+EVC_STATE int64_t first_supervised_timestamp;
+EVC_STATE bool radio_reaction_applied = false;
+EVC_STATE bool radio_reaction_reconnected = false;
 void update_euroradio()
 {
     for (mobile_terminal &t : mobile_terminals) {
@@ -426,8 +415,8 @@ void update_euroradio()
     if (supervising_rbc && supervising_rbc->status == session_status::Established && (level == Level::N2 || level == Level::N3))
         operate_version(supervising_rbc->version, true);
 }
-optional<contact_info> rbc_contact;
-bool rbc_contact_valid;
+EVC_STATE optional<contact_info> rbc_contact;
+EVC_STATE bool rbc_contact_valid;
 void load_contact_info()
 {
     //TODO: Radio Network
@@ -15,13 +15,14 @@
 #include <memory>
 #include <set>
 #include <list>
+#include "../Context/state.h"
 enum struct session_status
 {
     Inactive,
     Establishing,
     Established
 };
-extern safe_radio_status radio_status_driver;
+extern EVC_STATE safe_radio_status radio_status_driver;
 struct msg_expecting_ack
 {
     std::set<int> nid_ack;
@@ -53,22 +54,22 @@ class communication_session
     void open(int ntries);
     void finalize();
     void close();
-    void send(std::shared_ptr<euroradio_message_traintotrack> msg, bool lock = true);
+    void send(std::shared_ptr<euroradio_message_traintotrack> msg);
     void update();
     void reset_radio()
     {
         if (terminal != nullptr) {
             terminal->status = safe_radio_status::Failed;
-            terminal->cv.notify_all();
+            notify_radio_transport();
         }
     }
 };
-extern communication_session *supervising_rbc;
-extern communication_session *accepting_rbc;
-extern communication_session *handing_over_rbc;
-extern optional<contact_info> rbc_contact;
-extern bool rbc_contact_valid;
-extern bool radio_reaction_applied;
+extern EVC_STATE communication_session *supervising_rbc;
+extern EVC_STATE communication_session *accepting_rbc;
+extern EVC_STATE communication_session *handing_over_rbc;
+extern EVC_STATE optional<contact_info> rbc_contact;
+extern EVC_STATE bool rbc_contact_valid;
+extern EVC_STATE bool radio_reaction_applied;
 void update_euroradio();
 void set_supervising_rbc(contact_info info);
 void terminate_session(contact_info info);
@@ -11,111 +11,356 @@
 #include "../Version/translate.h"
 #ifndef _WIN32
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #else
 #include <winsock2.h>
 #endif
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <memory>
 #include <thread>
-mobile_terminal mobile_terminals[2];
-bool mobile_terminal::setup(communication_session *session)
+#include <chrono>
+#include "../Context/state.h"
+EVC_STATE mobile_terminal mobile_terminals[2];
+static const int64_t connect_timeout = 10000;
+static const int64_t connect_retry_delay = 1000;
+/*
+ * Socket side of a mobile terminal. Owned exclusively by the transport
+ * thread, which drives both terminals; the main loop only exchanges
+ * complete frames with it through the terminal queues.
+ */
+struct terminal_connection
 {
-    if (released > 0 || !registered)
-        return false;
-    setting_up = true;
-    active_session = session;
-    released = 2;
-    std::thread thr([this]{
-        int fd = socket(AF_INET, SOCK_STREAM, 0);
-        if (fd < 0) {
-            status = safe_radio_status::Failed;
-            released = 0;
-            perror("socket");
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            setting_up = false;
+    int fd = -1;
+    bool connecting = false;
+    int64_t deadline;
+    int64_t retry_at = -1;
+    std::vector<unsigned char> rx;
+    size_t rx_start = 0;
+    std::vector<unsigned char> tx;
+    size_t tx_start = 0;
+};
+/*
+ * Transport serving the two terminals of one train. Each EVC context owns
+ * its own, and the transport thread only reaches the terminals through it.
+ */
+struct radio_transport
+{
+    mobile_terminal *terminals;
+    terminal_connection connections[2];
+#ifndef _WIN32
+    int wake_pipe[2] = {-1, -1};
+#endif
+    std::atomic<bool> stop{false};
+    std::thread thread;
+    ~radio_transport();
+};
+static EVC_STATE std::unique_ptr<radio_transport> transport;
+static int64_t transport_time()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static bool would_block()
+{
+#ifdef _WIN32
+    int err = WSAGetLastError();
+    return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == EINTR;
+#endif
+}
+static void close_socket(int fd)
+{
+#ifdef _WIN32
+    shutdown(fd, SD_BOTH);
+    closesocket(fd);
+#else
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+#endif
+}
+static void connection_closed(mobile_terminal &t, terminal_connection &c)
+{
+    if (c.fd >= 0)
+        close_socket(c.fd);
+    c.fd = -1;
+    c.connecting = false;
+    c.rx.clear();
+    c.rx_start = 0;
+    c.tx.clear();
+    c.tx_start = 0;
+    t.pending_write.clear();
+    safe_radio_status connected = safe_radio_status::Connected;
+    t.status.compare_exchange_strong(connected, safe_radio_status::Failed);
+    t.released = 0;
+}
+static void connection_failed(mobile_terminal &t, terminal_connection &c)
+{
+    connection_closed(t, c);
+    t.status = safe_radio_status::Failed;
+    c.retry_at = transport_time() + connect_retry_delay;
+}
+static void start_connect(mobile_terminal &t, terminal_connection &c)
+{
+    c.retry_at = -1;
+    t.pending_write.clear();
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c.fd < 0) {
+        perror("socket");
+        connection_failed(t, c);
+        return;
+    }
+#ifdef _WIN32
+    u_long nonblock = 1;
+    ioctlsocket(c.fd, FIONBIO, &nonblock);
+#else
+    fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    uint64_t phone_number = t.phone_number;
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(phone_number&0xffff);
+    addr.sin_addr.s_addr = htonl(phone_number>>16);
+    if (connect(c.fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 && !would_block()) {
+        perror("connect");
+        connection_failed(t, c);
+        return;
+    }
+    c.connecting = true;
+    c.deadline = transport_time() + connect_timeout;
+}
+static void finish_connect(mobile_terminal &t, terminal_connection &c)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(c.fd, SOL_SOCKET, SO_ERROR, (char*)&err, &len) < 0 || err != 0) {
+        connection_failed(t, c);
+        return;
+    }
+    c.connecting = false;
+    t.status = safe_radio_status::Connected;
+    t.setting_up = false;
+}
+static void flush_writes(mobile_terminal &t, terminal_connection &c)
+{
+    std::vector<unsigned char> frame;
+    while (t.pending_write.pop(frame))
+        c.tx.insert(c.tx.end(), frame.begin(), frame.end());
+    while (c.tx_start < c.tx.size()) {
+#ifdef MSG_NOSIGNAL
+        int result = ::send(c.fd, (char*)c.tx.data() + c.tx_start, c.tx.size() - c.tx_start, MSG_NOSIGNAL);
+#else
+        int result = ::send(c.fd, (char*)c.tx.data() + c.tx_start, c.tx.size() - c.tx_start, 0);
+#endif
+        if (result < 0) {
+            if (!would_block())
+                connection_closed(t, c);
+            return;
+        }
+        c.tx_start += result;
+    }
+    c.tx.clear();
+    c.tx_start = 0;
+}
+static void read_frames(mobile_terminal &t, terminal_connection &c, bool readable)
+{
+    unsigned char buff[4096];
+    while (readable) {
+        int result = recv(c.fd, (char*)buff, sizeof(buff), 0);
+        if (result == 0 || (result < 0 && !would_block())) {
+            connection_closed(t, c);
             return;
         }
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(active_session->contact.phone_number&0xffff);
-        addr.sin_addr.s_addr = htonl(active_session->contact.phone_number>>16);
-        if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-            status = safe_radio_status::Failed;
-            perror("connect");
-            released = 0;
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            setting_up = false;
+        if (result < 0)
+            break;
+        c.rx.insert(c.rx.end(), buff, buff + result);
+        if (result < (int)sizeof(buff))
+            break;
+    }
+    while (c.rx.size() - c.rx_start >= 3 && !t.pending_read.full()) {
+        const unsigned char *head = c.rx.data() + c.rx_start;
+        size_t size = (head[1]<<2)|(head[2]>>6);
+        if (size < 3) {
+            connection_closed(t, c);
             return;
         }
-        status = safe_radio_status::Connected;
-        setting_up = false;
-        std::thread write([this,fd]() {
-            while (status == safe_radio_status::Connected) {
-                std::unique_lock<std::mutex> lck(mtx);
-                while (!pending_write.empty()) {
-                    auto msg = pending_write.front();
-                    pending_write.pop_front();
-                    msg = translate_message(msg, 0);
-                    lck.unlock();
-                    bit_manipulator w;
-                    msg->write_to(w);
-                    int result = ::send(fd, (char*)&w.bits[0], w.bits.size(), 0);
-                    if (result < 0) {
-                        released--;
-                        if (status == safe_radio_status::Connected)
-                            status = safe_radio_status::Failed;
-                        cv.notify_all();
-                        return;
-                    }
-                    lck.lock();
-                }
-                cv.wait(lck);
+        if (c.rx.size() - c.rx_start < size)
+            break;
+        t.pending_read.push(std::vector<unsigned char>(head, head + size));
+        c.rx_start += size;
+    }
+    c.rx.erase(c.rx.begin(), c.rx.begin() + c.rx_start);
+    c.rx_start = 0;
+}
+static void transport_loop(radio_transport *transport)
+{
+    mobile_terminal *terminals = transport->terminals;
+    terminal_connection *connections = transport->connections;
+    while (!transport->stop) {
+        std::vector<struct pollfd> fds;
+        int index[2] = {-1, -1};
+#ifndef _WIN32
+        fds.push_back({transport->wake_pipe[0], POLLIN, 0});
+#endif
+        int64_t now = transport_time();
+        int64_t timeout = 100;
+        for (int i=0; i<2; i++) {
+            mobile_terminal &t = terminals[i];
+            terminal_connection &c = connections[i];
+            if (c.fd < 0) {
+                if (c.retry_at >= 0)
+                    timeout = std::min(timeout, std::max(c.retry_at - now, (int64_t)0));
+                continue;
+            }
+            short events = 0;
+            if (c.connecting) {
+                events = POLLOUT;
+                timeout = std::min(timeout, std::max(c.deadline - now, (int64_t)0));
+            } else {
+                if (!t.pending_read.full())
+                    events |= POLLIN;
+                if (c.tx_start < c.tx.size() || !t.pending_write.empty())
+                    events |= POLLOUT;
             }
+            index[i] = fds.size();
+            fds.push_back({(decltype(pollfd::fd))c.fd, events, 0});
+        }
 #ifdef _WIN32
-            shutdown(fd, SD_BOTH);
-            closesocket(fd);
+        if (fds.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        else
+            WSAPoll(fds.data(), fds.size(), std::min(timeout, (int64_t)10));
 #else
-            shutdown(fd, SHUT_RDWR);
-            close(fd);
+        poll(fds.data(), fds.size(), timeout);
+        if (fds[0].revents & POLLIN) {
+            char buff[64];
+            while (read(transport->wake_pipe[0], buff, sizeof(buff)) > 0);
+        }
 #endif
-            released--;
-        });
-        write.detach();
-        while (status == safe_radio_status::Connected) {
-            unsigned char head[3];
-            if (recv(fd, (char*)head, 3, 0) < 0)
-                break;
-            int size = (head[1]<<2)|(head[2]>>6);
-            std::vector<unsigned char> pack;
-            pack.resize(size, 0);
-            pack[0] = head[0];
-            pack[1] = head[1];
-            pack[2] = head[2];
-            int res = recv(fd, (char*)pack.data() + 3, size - 3, 0);
-            if (res != size-3)
-                break;
-            bit_manipulator r(std::move(pack));
-            std::shared_ptr<euroradio_message> msg = euroradio_message::build(r, active_session == nullptr ? -1 : active_session->version);
-            std::unique_lock<std::mutex> lck(mtx);
-            pending_read.push_back(msg);
+        now = transport_time();
+        for (int i=0; i<2; i++) {
+            mobile_terminal &t = terminals[i];
+            terminal_connection &c = connections[i];
+            short revents = index[i] >= 0 ? fds[index[i]].revents : 0;
+            if (c.fd >= 0 && t.status != safe_radio_status::Connected && !c.connecting) {
+                connection_closed(t, c);
+                continue;
+            }
+            if (c.fd < 0) {
+                if (t.connect_requested.exchange(false)) {
+                    start_connect(t, c);
+                } else if (c.retry_at >= 0 && now >= c.retry_at) {
+                    c.retry_at = -1;
+                    t.setting_up = false;
+                }
+                continue;
+            }
+            if (c.connecting) {
+                if (!t.setting_up)
+                    connection_closed(t, c);
+                else if (revents & (POLLOUT | POLLERR | POLLHUP))
+                    finish_connect(t, c);
+                else if (now >= c.deadline)
+                    connection_failed(t, c);
+                continue;
+            }
+            read_frames(t, c, revents & (POLLIN | POLLERR | POLLHUP));
+            if (c.fd >= 0)
+                flush_writes(t, c);
         }
-        released--;
-        if (status == safe_radio_status::Connected)
-            status = safe_radio_status::Failed;
-        cv.notify_all();
-    });
-    thr.detach();
+    }
+}
+void notify_radio_transport()
+{
+#ifndef _WIN32
+    char c = 0;
+    if (transport != nullptr && transport->wake_pipe[1] >= 0 && write(transport->wake_pipe[1], &c, 1) < 0) {}
+#endif
+}
+static void start_transport()
+{
+    if (transport != nullptr)
+        return;
+    transport.reset(new radio_transport());
+    transport->terminals = mobile_terminals;
+#ifndef _WIN32
+    if (pipe(transport->wake_pipe) == 0) {
+        fcntl(transport->wake_pipe[0], F_SETFL, fcntl(transport->wake_pipe[0], F_GETFL, 0) | O_NONBLOCK);
+        fcntl(transport->wake_pipe[1], F_SETFL, fcntl(transport->wake_pipe[1], F_GETFL, 0) | O_NONBLOCK);
+    }
+#endif
+    transport->thread = std::thread(transport_loop, transport.get());
+}
+radio_transport::~radio_transport()
+{
+    stop = true;
+#ifndef _WIN32
+    char c = 0;
+    if (wake_pipe[1] >= 0 && write(wake_pipe[1], &c, 1) < 0) {}
+#endif
+    if (thread.joinable())
+        thread.join();
+    for (int i=0; i<2; i++) {
+        if (connections[i].fd >= 0)
+            close_socket(connections[i].fd);
+    }
+#ifndef _WIN32
+    for (int i=0; i<2; i++) {
+        if (wake_pipe[i] >= 0)
+            close(wake_pipe[i]);
+    }
+#endif
+}
+void stop_radio_transport()
+{
+    transport.reset();
+}
+bool mobile_terminal::setup(communication_session *session)
+{
+    if (released > 0 || !registered)
+        return false;
+    start_transport();
+    pending_read.clear();
+    setting_up = true;
+    active_session = session;
+    released = 1;
+    phone_number = session->contact.phone_number;
+    connect_requested = true;
+    notify_radio_transport();
     return true;
 }
 void mobile_terminal::release()
 {
-    {
-        std::unique_lock<std::mutex> lck(mtx);
-        pending_read.clear();
-        pending_write.clear();
-    }
+    pending_read.clear();
     setting_up = false;
     status = safe_radio_status::Disconnected;
     active_session = nullptr;
-    cv.notify_all();
-}
\ No newline at end of file
+    notify_radio_transport();
+}
+void mobile_terminal::send(std::shared_ptr<euroradio_message_traintotrack> msg)
+{
+    msg = translate_message(msg, 0);
+    writer.bits.clear();
+    writer.log_entries.clear();
+    writer.position = 0;
+    msg->write_to(writer);
+    if (!pending_write.push(writer.bits))
+        status = safe_radio_status::Failed;
+    notify_radio_transport();
+}
+bool mobile_terminal::receive(std::shared_ptr<euroradio_message> &msg)
+{
+    std::vector<unsigned char> frame;
+    bool full = pending_read.full();
+    if (!pending_read.pop(frame))
+        return false;
+    if (full)
+        notify_radio_transport();
+    bit_manipulator r(std::move(frame));
+    msg = euroradio_message::build(r, active_session == nullptr ? -1 : active_session->version);
+    return true;
+}
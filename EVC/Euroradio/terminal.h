@@ -7,11 +7,11 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 #pragma once
-#include <mutex>
 #include <atomic>
-#include <deque>
-#include <condition_variable>
+#include <vector>
 #include "../Packets/radio.h"
+#include "../Utils/spsc_queue.h"
+#include "../Context/state.h"
 class communication_session;
 struct contact_info
 {
@@ -47,16 +47,25 @@ struct mobile_terminal
     communication_session *active_session;
     std::atomic<bool> setting_up;
     std::atomic<int> released;
-    std::deque<std::shared_ptr<euroradio_message_traintotrack>> pending_write;
-    std::deque<std::shared_ptr<euroradio_message>> pending_read;
-    std::mutex mtx;
-    std::condition_variable cv;
+    std::atomic<bool> connect_requested;
+    std::atomic<uint64_t> phone_number;
+    spsc_queue<std::vector<unsigned char>, 64> pending_write;
+    spsc_queue<std::vector<unsigned char>, 64> pending_read;
+    bit_manipulator writer;
     public:
     std::atomic<safe_radio_status> status;
     std::string radio_network_id;
     bool registered;
     bool setup(communication_session *session);
     void release();
+    void send(std::shared_ptr<euroradio_message_traintotrack> msg);
+    bool receive(std::shared_ptr<euroradio_message> &msg);
     void update();
 };
-extern mobile_terminal mobile_terminals[2];
\ No newline at end of file
+extern EVC_STATE mobile_terminal mobile_terminals[2];
+void notify_radio_transport();
+/*
+ * Stops the transport thread of the calling context and closes its
+ * connections. Must be called before the context's state goes away.
+ */
+void stop_radio_transport();
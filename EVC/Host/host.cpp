@@ -0,0 +1,112 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "../Context/context.h"
+#include "../OR_interface/interface.h"
+#include "../language/language.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+/*
+ * Headless host running several trains in one process.
+ *
+ * Usage:
+ *   evc_host [--trains 16] [--workers 4] [--duration 30] [--period 80] [--speed 80]
+ *
+ * Every train runs on its own context; at most --workers of them execute
+ * a cycle at the same time. Trains are fed odometry directly, without the
+ * DMI or the simulator interface. A period of 0 runs cycles back to back.
+ */
+#ifndef EVC_MULTI_TRAIN
+#error "evc_host must be built with EVC_MULTI_TRAIN"
+#endif
+bool run;
+static void usage()
+{
+    fprintf(stderr, "usage: evc_host [--trains N] [--workers W] [--duration S] [--period MS] [--speed KMH]\n");
+}
+int main(int argc, char *argv[])
+{
+    int trains = 16;
+    int workers = (int)std::thread::hardware_concurrency();
+    double duration = 30;
+    int period = 80;
+    double speed = 80;
+    for (int i=1; i<argc; i++) {
+        bool has_value = i+1 < argc;
+        if (!strcmp(argv[i], "--trains") && has_value) {
+            trains = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--workers") && has_value) {
+            workers = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--duration") && has_value) {
+            duration = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--period") && has_value) {
+            period = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--speed") && has_value) {
+            speed = atof(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (workers < 1)
+        workers = 1;
+    run = true;
+    load_language();
+    SetParameters();
+    printf("Running %d trains on %d workers\n", trains, workers);
+    evc_worker_pool pool(workers);
+    std::atomic<bool> stop(false);
+    std::vector<std::unique_ptr<evc_context>> contexts;
+    for (int i=0; i<trains; i++) {
+        contexts.push_back(std::make_unique<evc_context>(i));
+        contexts.back()->set_input("master_key", "1");
+        contexts.back()->run(pool, std::chrono::milliseconds(period), stop);
+    }
+    std::vector<double> positions(trains, 0);
+    auto start = std::chrono::steady_clock::now();
+    auto prev = start;
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - start).count() >= duration)
+            break;
+        double dt = std::chrono::duration<double>(now - prev).count();
+        prev = now;
+        for (int i=0; i<trains; i++) {
+            // Spread speeds a little so that trains do not run in lockstep
+            double v = speed*(1 + (i%5)*0.05);
+            positions[i] += v/3.6*dt;
+            contexts[i]->set_input("speed", std::to_string(v));
+            contexts[i]->set_input("distance", std::to_string(positions[i]));
+        }
+    }
+    stop = true;
+    evc_cycle_stats total;
+    for (auto &c : contexts) {
+        c->join();
+        evc_cycle_stats s = c->get_stats();
+        total.cycles += s.cycles;
+        total.overruns += s.overruns;
+        total.total_us += s.total_us;
+        if (s.max_us > total.max_us)
+            total.max_us = s.max_us;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%llu cycles in %.1f s (%.1f cycles/s), cycle time avg %.1f us, max %lld us, %llu overruns\n",
+        (unsigned long long)total.cycles, elapsed, total.cycles/elapsed,
+        total.cycles > 0 ? (double)total.total_us/total.cycles : 0.0, (long long)total.max_us,
+        (unsigned long long)total.overruns);
+    for (auto &c : contexts) {
+        evc_outputs out = c->get_outputs();
+        printf("train %d: mode %d level %d V_est %.1f km/h V_perm %.1f km/h%s\n", c->id, out.mode, out.level,
+            out.V_est*3.6, out.V_perm*3.6, out.EB ? " EB" : out.SB ? " SB" : "");
+    }
+    return 0;
+}
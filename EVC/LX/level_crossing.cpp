@@ -9,9 +9,10 @@
 #include "level_crossing.h"
 #include "../MA/movement_authority.h"
 #include "../Supervision/targets.h"
-std::set<level_crossing> level_crossings;
-extern target MRDT;
-bool inform_lx = false;
+#include "../Context/state.h"
+EVC_STATE std::set<level_crossing> level_crossings;
+extern EVC_STATE target MRDT;
+EVC_STATE bool inform_lx = false;
 void load_lx(LevelCrossingInformation lxi, distance ref)
 {
     level_crossing lx = level_crossing(lxi, ref);
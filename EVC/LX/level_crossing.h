@@ -11,6 +11,7 @@
 #include "../Packets/88.h"
 #include "../optional.h"
 #include <set>
+#include "../Context/state.h"
 class level_crossing
 {
     public:
@@ -40,6 +41,6 @@ class level_crossing
         return start<l.start;
     }
 };
-extern std::set<level_crossing> level_crossings;
+extern EVC_STATE std::set<level_crossing> level_crossings;
 void load_lx(LevelCrossingInformation lx, distance ref);
 void update_lx();
\ No newline at end of file
@@ -8,15 +8,16 @@
  */
 #include "mode_profile.h"
 #include "../Procedures/mode_transition.h"
-std::list<mode_profile> mode_profiles;
-bool in_mode_ack_area;
-bool mode_timer_started = false;
-int64_t mode_timer;
-optional<mode_profile> requested_mode_profile;
-double lssma;
-bool display_lssma;
-optional<int64_t> display_lssma_time;
-bool ls_function_marker;
+#include "../Context/state.h"
+EVC_STATE std::list<mode_profile> mode_profiles;
+EVC_STATE bool in_mode_ack_area;
+EVC_STATE bool mode_timer_started = false;
+EVC_STATE int64_t mode_timer;
+EVC_STATE optional<mode_profile> requested_mode_profile;
+EVC_STATE double lssma;
+EVC_STATE bool display_lssma;
+EVC_STATE optional<int64_t> display_lssma_time;
+EVC_STATE bool ls_function_marker;
 void update_mode_profile()
 {
     if (mode_timer_started && mode_timer + T_ACK*1000 < get_milliseconds()) {
@@ -82,7 +83,7 @@ void update_mode_profile()
     if (requested_mode_profile && requested_mode_profile->mode == Mode::LS) {
         if (LoA) {
             lssma = LoA->second;
-            auto mrsp = get_MRSP();
+            auto &mrsp = get_MRSP();
             for (auto it = mrsp.begin(); it != mrsp.end(); ++it) {
                 if (d_minsafefront(it->first) < it->first && lssma > it->second)
                     lssma = it->second;
@@ -13,6 +13,7 @@
 #include "../Supervision/national_values.h"
 #include "../TrainSubsystems/brake.h"
 #include "../optional.h"
+#include "../Context/state.h"
 struct mode_profile
 {
     distance start;
@@ -22,15 +23,15 @@ struct mode_profile
     bool start_SvL;
     double speed;
 };
-extern std::list<mode_profile> mode_profiles;
-extern bool in_mode_ack_area;
-extern bool mode_timer_started;
-extern int64_t mode_timer;
-extern optional<mode_profile> requested_mode_profile;
-extern optional<int64_t> display_lssma_time;
-extern double lssma;
-extern bool display_lssma;
-extern bool ls_function_marker;
+extern EVC_STATE std::list<mode_profile> mode_profiles;
+extern EVC_STATE bool in_mode_ack_area;
+extern EVC_STATE bool mode_timer_started;
+extern EVC_STATE int64_t mode_timer;
+extern EVC_STATE optional<mode_profile> requested_mode_profile;
+extern EVC_STATE optional<int64_t> display_lssma_time;
+extern EVC_STATE double lssma;
+extern EVC_STATE bool display_lssma;
+extern EVC_STATE bool ls_function_marker;
 void update_mode_profile();
 void reset_mode_profile(distance ref, bool infill);
 void set_mode_profile(ModeProfile profile, distance ref, bool infill);
\ No newline at end of file
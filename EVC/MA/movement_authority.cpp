@@ -12,8 +12,9 @@
 #include "../Procedures/stored_information.h"
 #include "../Supervision/emergency_stop.h"
 #include "../TrackConditions/route_suitability.h"
-optional<distance> d_perturbation_eoa;
-optional<distance> d_perturbation_svl;
+#include "../Context/state.h"
+EVC_STATE optional<distance> d_perturbation_eoa;
+EVC_STATE optional<distance> d_perturbation_svl;
 movement_authority::movement_authority(distance start, Level1_MA ma, int64_t time) : start(start), time_stamp(time)
 {
     v_main = ma.V_MAIN.get_value();
@@ -281,8 +282,8 @@ void calculate_perturbation_location()
         }
     }
 }
-optional<movement_authority> MA;
-std::set<speed_restriction> signal_speeds;
+EVC_STATE optional<movement_authority> MA;
+EVC_STATE std::set<speed_restriction> signal_speeds;
 void set_data()
 {
     MA->calculate_distances();
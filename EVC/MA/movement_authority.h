@@ -16,6 +16,7 @@
 #include "../optional.h"
 #include "../Time/clock.h"
 #include "mode_profile.h"
+#include "../Context/state.h"
 class timer
 {
 public:
@@ -69,7 +70,7 @@ struct overlap
     double distance;
     double vrelease;
 };
-extern std::set<speed_restriction> signal_speeds;
+extern EVC_STATE std::set<speed_restriction> signal_speeds;
 class movement_authority
 {
     double v_main;
@@ -119,9 +120,9 @@ public:
     friend void set_data();
     friend void set_signalling_restriction(movement_authority ma, bool infill);
 };
-extern optional<movement_authority> MA;
-extern optional<distance> d_perturbation_eoa;
-extern optional<distance> d_perturbation_svl;
+extern EVC_STATE optional<movement_authority> MA;
+extern EVC_STATE optional<distance> d_perturbation_eoa;
+extern EVC_STATE optional<distance> d_perturbation_svl;
 void calculate_SvL();
 void calculate_perturbation_location();
 void replace_MA(movement_authority ma, bool cooperative_shortening=false);
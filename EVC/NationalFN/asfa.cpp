@@ -19,18 +19,24 @@ using namespace ORserver;
 using std::mutex;
 using std::string;
 extern ParameterManager manager;
-bool AKT=false;
-bool CON=true;
-extern mutex loop_mtx;
+EVC_STATE bool AKT=false;
+EVC_STATE bool CON=true;
+extern EVC_STATE mutex loop_mtx;
 extern mutex iface_mtx;
-bool detected = false;
-bool connected = false;
-bool active = false;
-bool brake_commanded = false;
+EVC_STATE bool detected = false;
+EVC_STATE bool connected = false;
+EVC_STATE bool active = false;
+EVC_STATE bool brake_commanded = false;
 void register_parameter(std::string parameter);
 void initialize_asfa()
 {
+    // Parameters act on the state of the calling thread, so a single set
+    // serves every train of a multi-train host
+    static bool parameters_added = false;
     std::unique_lock<mutex> lck(iface_mtx);
+    if (parameters_added)
+        return;
+    parameters_added = true;
     Parameter *p;
     p = new Parameter("asfa::akt::etcs");
     p->GetValue = []() {
@@ -53,12 +59,13 @@ void initialize_asfa()
 
     register_parameter("asfa::conectado");
 }
-extern double V_NVUNFIT;
+extern EVC_STATE double V_NVUNFIT;
 #include "../Position/distance.h"
 #include "../Supervision/speed_profile.h"
-extern optional<speed_restriction> UN_speed;
-int64_t akt_delay=0;
-int64_t con_delay=0;
+#include "../Context/state.h"
+extern EVC_STATE optional<speed_restriction> UN_speed;
+EVC_STATE int64_t akt_delay=0;
+EVC_STATE int64_t con_delay=0;
 text_message &send_msg()
 {
     bool con = CON;
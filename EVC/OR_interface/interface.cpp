@@ -12,7 +12,9 @@
 #include <set>
 #include <bitset>
 #include <algorithm>
+#include <functional>
 #include "../Position/distance.h"
+#include "../Position/odometry.h"
 #include "../Supervision/speed_profile.h"
 #include "../MA/movement_authority.h"
 #include "../Position/linking.h"
@@ -20,66 +22,88 @@
 #include "../TrainSubsystems/power.h"
 #include "../TrainSubsystems/train_interface.h"
 #include "../STM/stm.h"
+#include "../STM/stm_bus.h"
 #include "../Config/config.h"
+#include "../Utils/triple_buffer.h"
 #include <iostream>
 #include <sstream>
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <condition_variable>
+#include "../Context/state.h"
 using namespace ORserver;
 using std::string;
 using std::cout;
 using std::endl;
 using std::thread;
 using std::mutex;
-extern mutex loop_mtx;
-extern std::condition_variable evc_cv;
-extern double V_est;
-double V_set;
-extern distance d_estfront;
-extern bool EB_command;
-extern bool SB_command;
+extern EVC_STATE mutex loop_mtx;
+extern EVC_STATE std::condition_variable evc_cv;
+extern EVC_STATE double V_est;
+EVC_STATE double V_set;
+extern EVC_STATE distance d_estfront;
+extern EVC_STATE bool EB_command;
+extern EVC_STATE bool SB_command;
 extern bool desk_open;
 extern bool sleep_signal;
-double or_dist;
+EVC_STATE double or_dist;
 POSIXclient *s_client;
 ParameterManager manager;
 mutex iface_mtx;
 static threadwait *poller;
+/*
+ * Output parameters are evaluated by the EVC once per cycle and handed to
+ * the interface thread, which only sends those whose value changed.
+ * Published parameters answer GetValue from the last sent value, so the
+ * interface thread never touches EVC state to serve them.
+ */
+static std::vector<Parameter*> published_parameters;
+static std::vector<std::function<string()>> published_getters;
+static std::vector<string> published_values;
+static triple_buffer<std::vector<string>> published_snapshot;
 //std::list<euroradio_message_traintotrack> pendingmessages;
 void parse_command(string str, bool lock);
+void set_odometer_input(double dist)
+{
+    or_dist = dist;
+    record_odometer_distance(dist, get_microseconds());
+}
+void set_speed_input(double speed)
+{
+    record_odometer_speed(speed/3.6, get_microseconds());
+    if (V_est != 0 && speed/3.6 < 0.2)
+        position_report_reasons[0] = true;
+}
+void set_acceleration_input(double acceleration)
+{
+    record_odometer_acceleration(acceleration, get_microseconds());
+}
+void set_odometry_inputs(double dist, double speed, double acceleration, int64_t time)
+{
+    or_dist = dist;
+    record_odometer_sample(dist, speed/3.6, acceleration, time);
+    if (V_est != 0 && speed/3.6 < 0.2)
+        position_report_reasons[0] = true;
+}
 void SetParameters()
 {
     std::unique_lock<mutex> lck(iface_mtx);
     Parameter *p = new Parameter("distance");
     p->SetValue = [](string val) {
-        or_dist = stod(val);
-        if (odometer_value > or_dist)
-            odometer_direction = -1;
-        else if (odometer_value < or_dist)
-            odometer_direction = 1;
-        
-        odometer_value = or_dist;
+        set_odometer_input(stod(val));
     };
     manager.AddParameter(p);
 
     p = new Parameter("speed");
     p->SetValue = [](string val) {
-        double prev = V_est;
-        V_est = stod(val)/3.6;
-        V_ura = 0.007*V_est;
-        if (V_est < 0.2)
-        {
-            V_est = V_ura = 0;
-        }
-        if (prev != 0 && V_est == 0)
-            position_report_reasons[0] = true;
+        set_speed_input(stod(val));
     };
     manager.AddParameter(p);
 
     p = new Parameter("acceleration");
     p->SetValue = [](string val) {
-        A_est = stod(val);
+        set_acceleration_input(stod(val));
     };
     manager.AddParameter(p);
 
@@ -117,7 +141,8 @@ void SetParameters()
         }
         bit_manipulator r(std::move(message));
         eurobalise_telegram t(r);
-        pending_telegrams.push_back({t,{distance(odometer_value-odometer_reference, odometer_orientation, 0), get_milliseconds()}});
+        double position = odometer_position_at(get_microseconds());
+        pending_telegrams.push_back({t,{distance(position-odometer_reference, odometer_orientation, 0), get_milliseconds()}});
         evc_cv.notify_all();
     };
     manager.AddParameter(p);
@@ -155,9 +180,9 @@ void SetParameters()
     p = new Parameter("etcs::atf");
     p->GetValue = []() {
         if (mode != Mode::FS) return std::string("-1");
-        extern const target *indication_target;
-        extern target MRDT;
-        extern MonitoringStatus monitoring;
+        extern EVC_STATE const target *indication_target;
+        extern EVC_STATE target MRDT;
+        extern EVC_STATE MonitoringStatus monitoring;
         const target *t = (monitoring == CSM) ? indication_target : &MRDT;
         if (t != nullptr) {
             //t->calculate_curves();
@@ -201,7 +226,7 @@ void SetParameters()
     p = new Parameter("etcs::supervision");
     p->GetValue = []() {
         string s = "";
-        extern SupervisionStatus supervision;
+        extern EVC_STATE SupervisionStatus supervision;
         switch(supervision)
         {
             case NoS:
@@ -231,14 +256,13 @@ void SetParameters()
 
     p = new Parameter("stm::command");
     p->SetValue = [](std::string val) {
-        bit_manipulator r(val);
-        stm_message msg(r);
-        handle_stm_message(msg);
-        /*for (auto &var : r.log_entries)
-        {
-            std::cout<<var.first<<"\t"<<var.second<<"\n";
-        }*/
-        send_command("stmData", val);
+        stm_bus_receive(val);
+    };
+    manager.AddParameter(p);
+
+    p = new Parameter("etcs::stm_bus");
+    p->GetValue = []() {
+        return stm_bus_statistics();
     };
     manager.AddParameter(p);
 
@@ -262,8 +286,93 @@ void SetParameters()
     };
     manager.AddParameter(p);
 }
+void set_parameter(const string &name, const string &value)
+{
+    // Parameters are all registered before the first cycle, and later
+    // only their getters are replaced, so finding a setter needs no lock
+    for (Parameter *p : manager.parameters) {
+        if (p->name == name && p->SetValue) {
+            p->SetValue(value);
+            return;
+        }
+    }
+}
+string get_parameter(const string &name)
+{
+    std::unique_lock<mutex> lck(iface_mtx);
+    for (size_t i=0; i<published_parameters.size(); i++) {
+        if (published_parameters[i]->name == name)
+            return published_getters[i]();
+    }
+    for (Parameter *p : manager.parameters) {
+        if (p->name == name && p->GetValue)
+            return p->GetValue();
+    }
+    return "";
+}
+void apply_parameter(const string &name, const string &value)
+{
+    std::unique_lock<mutex> lck(iface_mtx);
+    std::unique_lock<mutex> lck2(loop_mtx);
+    for (Parameter *p : manager.parameters) {
+        if (p->name == name && p->SetValue) {
+            p->SetValue(value);
+            return;
+        }
+    }
+}
+/*
+ * Parameters are added from start() and later by the national functions,
+ * so new ones are adopted whenever the set grows. Both locks are taken in
+ * the order polling() uses, since the cycle reads published_getters.
+ */
+static void adopt_output_parameters()
+{
+    static size_t adopted_count = 0;
+    std::unique_lock<mutex> lck(iface_mtx);
+    if (manager.parameters.size() == adopted_count)
+        return;
+    std::unique_lock<mutex> lck2(loop_mtx);
+    adopted_count = manager.parameters.size();
+    for (Parameter *p : manager.parameters) {
+        if (!p->GetValue || std::find(published_parameters.begin(), published_parameters.end(), p) != published_parameters.end())
+            continue;
+        int index = published_parameters.size();
+        published_parameters.push_back(p);
+        published_getters.push_back(p->GetValue);
+        published_values.push_back("");
+        p->GetValue = [index]() {
+            return published_values[index];
+        };
+    }
+}
+void publish_or_outputs()
+{
+    if (s_client == nullptr)
+        return;
+    std::vector<string> &values = published_snapshot.write_buffer();
+    values.resize(published_getters.size());
+    for (size_t i=0; i<published_getters.size(); i++)
+        values[i] = published_getters[i]();
+    published_snapshot.publish();
+}
+static void send_changed_parameters()
+{
+    if (!published_snapshot.update())
+        return;
+    const std::vector<string> &values = published_snapshot.read_buffer();
+    std::unique_lock<mutex> lck(iface_mtx);
+    for (size_t i=0; i<values.size(); i++) {
+        if (values[i] == published_values[i])
+            continue;
+        published_values[i] = values[i];
+        published_parameters[i]->Send();
+    }
+}
 void register_parameter(string parameter)
 {
+    if (s_client == nullptr)
+        return;
     s_client->WriteLine("register("+parameter+")");
 }
 
@@ -271,16 +380,19 @@ void polling()
 {
     std::this_thread::sleep_for(std::chrono::milliseconds(2000));
     while(s_client->connected) {
-        int nfds = poller->poll(300);
+        int nfds = poller->poll(100);
         s_client->handle();
         string s = s_client->ReadLine();
-        std::unique_lock<mutex> lck(iface_mtx);
-        std::unique_lock<mutex> lck2(loop_mtx);
-        while(s!="") {
-            manager.ParseLine(s_client, s);
-            s = s_client->ReadLine();
+        if (s!="") {
+            std::unique_lock<mutex> lck(iface_mtx);
+            std::unique_lock<mutex> lck2(loop_mtx);
+            while(s!="") {
+                manager.ParseLine(s_client, s);
+                s = s_client->ReadLine();
+            }
         }
-        std::for_each(manager.parameters.begin(), manager.parameters.end(), [](Parameter* p){p->Send();});
+        adopt_output_parameters();
+        send_changed_parameters();
     }
 }
 #ifdef _WIN32
@@ -313,6 +425,7 @@ void start_or_iface()
     s_client->WriteLine("register(etcs::isolated)");
     s_client->WriteLine("register(serie)");
     SetParameters();
+    adopt_output_parameters();
     thread t(polling);
     t.detach();
 }
@@ -10,4 +10,35 @@
 #include <list>
 #include "../Packets/radio.h"
 void start_or_iface();
+void SetParameters();
+/*
+ * Direct access to the simulator parameters, used by hosts that feed the
+ * EVC without an ORTS server. Runs on the calling thread, so in a
+ * multi-train build it acts on the state of the caller's context, and
+ * trains do not wait for each other.
+ */
+void set_parameter(const std::string &name, const std::string &value);
+std::string get_parameter(const std::string &name);
+/*
+ * Same as set_parameter() for other threads of the single train EVC,
+ * next to the ORTS interface thread. Takes iface_mtx and then loop_mtx,
+ * in the same order as that thread, so neither must be held.
+ */
+void apply_parameter(const std::string &name, const std::string &value);
+/*
+ * Odometry inputs, in metres, km/h and m/s².
+ */
+void set_odometer_input(double dist);
+void set_speed_input(double speed);
+void set_acceleration_input(double acceleration);
+/*
+ * The three inputs above measured together, stamped by their producer
+ * with get_microseconds() time.
+ */
+void set_odometry_inputs(double dist, double speed, double acceleration, int64_t time);
+/*
+ * Called by the EVC at the end of every cycle, with loop_mtx held, to hand
+ * the current output values over to the interface thread.
+ */
+void publish_or_outputs();
 //extern std::list<euroradio_message_traintotrack> pendingmessages;
\ No newline at end of file
@@ -0,0 +1,110 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "shm_bridge.h"
+#include "interface.h"
+#include "../Supervision/supervision.h"
+#include "../TrainSubsystems/train_interface.h"
+#include "../Position/odometry.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+static etcs_shm_region *region = nullptr;
+static uint64_t output_cycle;
+static etcs_shm_region *map_region(const char *name)
+{
+    size_t size = sizeof(etcs_shm_region);
+#if defined(__ANDROID__)
+    return nullptr;
+#else
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, size, name);
+    if (mapping == nullptr)
+        return nullptr;
+    void *mem = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (mem == nullptr)
+        return nullptr;
+#else
+    std::string path = name[0] == '/' ? name : std::string("/") + name;
+    int fd = shm_open(path.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) {
+        perror("shm_open");
+        return nullptr;
+    }
+    if (ftruncate(fd, size) < 0) {
+        perror("ftruncate");
+        close(fd);
+        return nullptr;
+    }
+    void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        return nullptr;
+    }
+#endif
+    // The EVC owns the mapping and resets it; a simulator waits for the
+    // magic number before using it
+    etcs_shm_region *r = new (mem) etcs_shm_region();
+    r->version = ETCS_SHM_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    r->magic = ETCS_SHM_MAGIC;
+    return r;
+#endif
+}
+static void read_shm_odometry()
+{
+    shm_train_inputs in;
+    while (region->inputs.pop(in))
+        set_odometry_inputs(in.distance, in.speed, in.acceleration, in.timestamp);
+}
+void start_shm_bridge()
+{
+    const char *name = getenv("ETCS_SHM");
+    if (name == nullptr || name[0] == 0)
+        return;
+    region = map_region(name);
+    if (region != nullptr) {
+        set_odometry_source(read_shm_odometry);
+        printf("Simulator shared memory bridge at %s\n", name);
+    }
+}
+void update_shm_inputs()
+{
+    if (region == nullptr)
+        return;
+    shm_event ev;
+    while (region->events.pop(ev)) {
+        ev.parameter[sizeof(ev.parameter)-1] = 0;
+        ev.value[sizeof(ev.value)-1] = 0;
+        apply_parameter(ev.parameter, ev.value);
+    }
+}
+void publish_shm_outputs()
+{
+    if (region == nullptr)
+        return;
+    shm_train_outputs out;
+    out.cycle = ++output_cycle;
+    out.V_est = V_est*3.6;
+    out.V_perm = V_perm*3.6;
+    out.V_target = V_target*3.6;
+    out.V_sbi = V_sbi*3.6;
+    out.emergency_brake = EB_command;
+    out.service_brake = SB_command;
+    out.traction_cutoff = !traction_cutoff_status;
+    region->outputs.store(out);
+}
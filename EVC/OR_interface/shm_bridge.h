@@ -0,0 +1,97 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "../Utils/spsc_queue.h"
+/*
+ * Shared memory interface for a simulator running on the same machine,
+ * next to the ORTS TCP interface. It is enabled by setting ETCS_SHM to
+ * the name of the mapping before starting the EVC; the simulator opens
+ * the same mapping and uses the layout below.
+ *
+ * Odometry samples are queued with the time they were measured at, on
+ * the monotonic clock (CLOCK_MONOTONIC, steady_clock), and consumed by
+ * the EVC right when it evaluates the odometry. Outputs go through a
+ * seqlock, so the simulator always reads the latest consistent value
+ * without waiting. Discrete inputs, such as balise telegrams, are queued
+ * in a ring and applied in order as if they had been received from ORTS
+ * as parameter=value.
+ */
+#define ETCS_SHM_MAGIC 0x45544353
+#define ETCS_SHM_VERSION 2
+template<typename T>
+struct shm_seqlock
+{
+    std::atomic<uint32_t> sequence{0};
+    T value;
+    void store(const T &v)
+    {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq+1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy((void*)&value, &v, sizeof(T));
+        sequence.store(seq+2, std::memory_order_release);
+    }
+    bool load(T &v) const
+    {
+        for (int i=0; i<64; i++) {
+            uint32_t seq = sequence.load(std::memory_order_acquire);
+            if (seq & 1)
+                continue;
+            std::memcpy(&v, (const void*)&value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == seq)
+                return seq != 0;
+        }
+        return false;
+    }
+};
+struct shm_train_inputs
+{
+    // Microseconds of the monotonic clock when the sample was measured
+    int64_t timestamp;
+    double distance;
+    double speed;
+    double acceleration;
+};
+struct shm_train_outputs
+{
+    uint64_t cycle;
+    double V_est;
+    double V_perm;
+    double V_target;
+    double V_sbi;
+    uint8_t emergency_brake;
+    uint8_t service_brake;
+    uint8_t traction_cutoff;
+};
+struct shm_event
+{
+    char parameter[64];
+    char value[1088];
+};
+struct etcs_shm_region
+{
+    uint32_t magic;
+    uint32_t version;
+    spsc_queue<shm_train_inputs, 256> inputs;
+    shm_seqlock<shm_train_outputs> outputs;
+    spsc_queue<shm_event, 64> events;
+};
+void start_shm_bridge();
+/*
+ * Called by the EVC loop before every cycle, without loop_mtx held.
+ */
+void update_shm_inputs();
+/*
+ * Called by the EVC loop after every cycle, with loop_mtx held.
+ */
+void publish_shm_outputs();
@@ -0,0 +1,59 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include <utility>
+/*
+ * Monotonic storage for a decoded message, its packets and the information
+ * objects derived from them. Objects are never freed individually: every
+ * allocation keeps the arena alive, and the whole buffer is released at once
+ * when the last of them is destroyed.
+ *
+ * A radio message owns one arena. For balises, each telegram owns the
+ * arena of its packets, and the information derived while handling a
+ * balise group goes to one arena shared by all its telegrams, as the
+ * group is what gets handled as a whole.
+ */
+struct message_arena
+{
+    std::pmr::monotonic_buffer_resource resource;
+    message_arena(std::size_t initial_size = 4096) : resource(initial_size) {}
+};
+template<typename T>
+struct arena_allocator
+{
+    typedef T value_type;
+    std::shared_ptr<message_arena> arena;
+    arena_allocator(std::shared_ptr<message_arena> arena) : arena(std::move(arena)) {}
+    template<typename U>
+    arena_allocator(const arena_allocator<U> &o) : arena(o.arena) {}
+    T *allocate(std::size_t n)
+    {
+        return (T*)arena->resource.allocate(n*sizeof(T), alignof(T));
+    }
+    void deallocate(T *p, std::size_t n) {}
+    template<typename U>
+    bool operator==(const arena_allocator<U> &o) const
+    {
+        return arena == o.arena;
+    }
+    template<typename U>
+    bool operator!=(const arena_allocator<U> &o) const
+    {
+        return arena != o.arena;
+    }
+};
+template<typename T, typename... Args>
+std::shared_ptr<T> arena_new(const std::shared_ptr<message_arena> &arena, Args&&... args)
+{
+    if (arena == nullptr)
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    return std::allocate_shared<T>(arena_allocator<T>(arena), std::forward<Args>(args)...);
+}
@@ -68,7 +68,7 @@ void national_values_information::handle()
 }
 void linking_information::handle()
 {
-    Linking l = *(Linking*)linked_packets.front().get();
+    const Linking &l = *(Linking*)linked_packets.front().get();
     update_linking(ref, l, infill, nid_bg);
 }
 void signalling_information::handle()
@@ -113,7 +113,7 @@ void ma_information::handle()
 }
 void ma_information_lv2::handle()
 {
-    if (active_dialog == dialog_sequence::Main && active_dialog_step == "S7")
+    if (active_dialog == dialog_sequence::Main && active_dialog_step == dialog_step::S7)
         active_dialog = dialog_sequence::None;
     Level2_3_MA ma = *(Level2_3_MA*)linked_packets.front().get();
     movement_authority MA = movement_authority(ref, ma, timestamp);
@@ -239,7 +239,7 @@ void SR_authorisation_info::handle()
         else
             D_STFF_rbc = std::numeric_limits<double>::infinity();
     }
-    if (active_dialog == dialog_sequence::Main && active_dialog_step == "S7")
+    if (active_dialog == dialog_sequence::Main && active_dialog_step == dialog_step::S7)
         active_dialog = dialog_sequence::None;
     sr_balises = {};
     for (auto &pack : sr->optional_packets) {
@@ -329,10 +329,8 @@ void danger_for_SH_information::handle()
 void coordinate_system_information::handle()
 {
     auto &msg = *(coordinate_system_assignment*)message->get();
-    for (auto it = lrbgs.begin(); it != lrbgs.end(); ++it) {
-        if (it->nid_lrbg == msg.NID_LRBG.get_value()) {
-            it->dir = msg.Q_ORIENTATION == Q_ORIENTATION_t::Reverse;
-        }
+    for (auto it = lrbgs.find_last(msg.NID_LRBG.get_value()); it != lrbgs.end(); it = lrbgs.find_previous(it)) {
+        it->dir = msg.Q_ORIENTATION == Q_ORIENTATION_t::Reverse;
     }
 }
 void track_condition_information::handle()
@@ -26,8 +26,10 @@ static int sock;
 static std::mutex mtx;
 static std::condition_variable cv;
 std::deque<std::string> pending_logs;
+static bool logging_started;
 void start_logging()
 {
+    logging_started = true;
     std::thread thr([]{
         int server = socket(AF_INET, SOCK_STREAM, 0);
         struct sockaddr_in serv;
@@ -89,6 +91,8 @@ void print_vars(std::ostream &stream, std::vector<std::pair<std::string,std::str
 }
 void log_message(std::shared_ptr<ETCS_message> msg, distance &dist, int64_t time)
 {
+    if (!logging_started)
+        return;
     std::stringstream ss;
     bit_manipulator b;
     msg->write_to(b);
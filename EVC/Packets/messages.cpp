@@ -36,31 +36,32 @@
 #include "../Version/translate.h"
 #include <algorithm>
 #include <iostream>
-static int reading_nid_bg=-1;
-static int reading_nid_c=-1;
-static std::vector<eurobalise_telegram> telegrams;
-static distance last_passed_distance;
-static bool reffound=false;
-static bool refmissed=false;
-static bool dupfound=false;
-static bool refpassed=false;
-static bool linked = false;
-static int prevpig=-1;
-static int totalbg=8;
-static bool reading = false;
-static int rams_lost_count = 0;
-static int dir = -1;
-static int orientation = -1;
-static int64_t first_balise_time;
-static distance bg_reference1;
-static distance bg_reference1max;
-static distance bg_reference1min;
-static distance bg_reference;
-static distance bg_referencemax;
-static distance bg_referencemin;
-static bool stop_checking_linking=false;
-std::deque<std::pair<eurobalise_telegram, std::pair<distance,int64_t>>> pending_telegrams;
-optional<link_data> rams_reposition_mitigation;
+#include "../Context/state.h"
+EVC_STATE static int reading_nid_bg=-1;
+EVC_STATE static int reading_nid_c=-1;
+EVC_STATE static std::vector<eurobalise_telegram> telegrams;
+EVC_STATE static distance last_passed_distance;
+EVC_STATE static bool reffound=false;
+EVC_STATE static bool refmissed=false;
+EVC_STATE static bool dupfound=false;
+EVC_STATE static bool refpassed=false;
+EVC_STATE static bool linked = false;
+EVC_STATE static int prevpig=-1;
+EVC_STATE static int totalbg=8;
+EVC_STATE static bool reading = false;
+EVC_STATE static int rams_lost_count = 0;
+EVC_STATE static int dir = -1;
+EVC_STATE static int orientation = -1;
+EVC_STATE static int64_t first_balise_time;
+EVC_STATE static distance bg_reference1;
+EVC_STATE static distance bg_reference1max;
+EVC_STATE static distance bg_reference1min;
+EVC_STATE static distance bg_reference;
+EVC_STATE static distance bg_referencemax;
+EVC_STATE static distance bg_referencemin;
+EVC_STATE static bool stop_checking_linking=false;
+EVC_STATE std::deque<std::pair<eurobalise_telegram, std::pair<distance,int64_t>>> pending_telegrams;
+EVC_STATE optional<link_data> rams_reposition_mitigation;
 void trigger_reaction(int reaction);
 void handle_telegrams(std::vector<eurobalise_telegram> message, distance dist, int dir, int64_t timestamp, bg_id nid_bg, int m_version);
 void handle_radio_message(std::shared_ptr<euroradio_message> message);
@@ -69,7 +70,7 @@ void update_track_comm();
 void balise_group_passed();
 void check_linking(bool group_passed=false);
 void expect_next_linking();
-std::vector<etcs_information*> construct_information(ETCS_packet *packet, euroradio_message *msg);
+std::vector<std::shared_ptr<etcs_information>> construct_information(ETCS_packet *packet, euroradio_message *msg, const std::shared_ptr<message_arena> &arena);
 void trigger_reaction(int reaction)
 {
     switch (reaction) {
@@ -108,6 +109,16 @@ void expect_next_linking()
     if (link_expected != linking.end())
         ++link_expected;
 }
+/*
+ * First linked group from the given one that is either the group being
+ * read or an unknown group (NID_BG 16383) of the same country.
+ */
+static linking_list::iterator find_reading_link(linking_list::iterator from)
+{
+    auto it = linking.find_first({reading_nid_c, reading_nid_bg}, from);
+    auto unknown = linking.find_first({reading_nid_c, 16383}, from);
+    return unknown < it ? unknown : it;
+}
 void check_linking(bool group_passed)
 {
     if (mode != Mode::FS && mode != Mode::OS && mode != Mode::LS) {
@@ -119,13 +130,7 @@ void check_linking(bool group_passed)
     if (link_expected == linking.end())
         rams_lost_count = 0;
     if (link_expected!=linking.end() && !stop_checking_linking) {
-        auto link_bg=linking.end();
-        for (auto it = link_expected; it!=linking.end(); ++it) {
-            if (it->nid_bg == bg_id({reading_nid_c, reading_nid_bg}) || (it->nid_bg.NID_C == reading_nid_c && it->nid_bg.NID_BG == 16383)) {
-                link_bg = it;
-                break;
-            }
-        }
+        auto link_bg = find_reading_link(link_expected);
         bool isexpected = linked && refpassed && link_expected==link_bg;
         bool c1 = isexpected && (link_expected->min() > bg_referencemax || link_expected->nid_bg.NID_BG == 16383);
         bool c2 = (!isexpected || link_expected->max() < bg_referencemin) && link_expected->max() < d_minsafefront(odometer_orientation, 0)-L_antenna_front;
@@ -175,7 +180,8 @@ void balise_group_passed()
     bool linking_rejected=false;
     if (linked && reffound && !linking.empty() && (mode == Mode::FS || mode == Mode::OS || mode == Mode::LS)) {
         linking_rejected = true;
-        for (auto it = linking.begin(); it != linking.end(); ++it) {
+        auto it = find_reading_link(linking.begin());
+        if (it != linking.end()) {
             link_data &l = *it;
             if (l.nid_bg == bg_id({reading_nid_c, reading_nid_bg})) {
                 if (dir != -1 && dir != l.reverse_dir) {
@@ -185,9 +191,7 @@ void balise_group_passed()
                 rams_reposition_mitigation = {};
                 if (l.max() >= bg_referencemin && l.min() <= bg_referencemax)
                     linking_rejected = false;
-                break;
-            }
-            if (l.nid_bg.NID_C == reading_nid_c && l.nid_bg.NID_BG == 16383) {
+            } else {
                 bool repositioning = false;
                 for (auto tel : telegrams) {
                     for (auto pack : tel.packets) {
@@ -212,7 +216,6 @@ void balise_group_passed()
                         linking_rejected = false;
                     }
                 }
-                break;
             }
         }
         if (rams_reposition_mitigation) {
@@ -238,7 +241,7 @@ void balise_group_passed()
         }
     }
     if (!linking_rejected) check_valid_data(telegrams, bg_reference, linked, first_balise_time);
-    linking.erase(linking.begin(), link_expected);
+    linking.pop_front(link_expected);
     reset_eurobalise_data();
 }
 void update_track_comm()
@@ -269,7 +272,7 @@ void update_track_comm()
         distance passed_dist = pending_telegrams.front().second.first-L_antenna_front;
         log_message(std::shared_ptr<ETCS_message>(new eurobalise_telegram(t)), pending_telegrams.front().second.first, pending_telegrams.front().second.second);
         pending_telegrams.pop_front();
-        extern optional<float> rmp_position;
+        extern EVC_STATE optional<float> rmp_position;
         int rev = ((mode == Mode::PT || mode == Mode::RV) ? -1 : 1)*odometer_orientation;
         if (rmp_position && (*rmp_position - odometer_value)*rev > 0.1) {
             update_track_comm();
@@ -389,14 +392,11 @@ void check_valid_data(std::vector<eurobalise_telegram> telegrams, distance bg_re
     link_data balise_link;
     bool containedinlinking=false;
     if (linked && !linking.empty()) {
-        bool unknown = false;
-        for (link_data l : linking) {
-            if (l.nid_bg.NID_C == nid_c && l.nid_bg.NID_BG == 16383)
-                unknown = true;
-            if (l.nid_bg == bg_id({nid_c, nid_bg})) {
-                containedinlinking = true;
-                balise_link = l;
-            }
+        bool unknown = linking.find_last({nid_c, 16383}) != linking.end();
+        auto it = linking.find_last({nid_c, nid_bg});
+        if (it != linking.end()) {
+            containedinlinking = true;
+            balise_link = *it;
         }
         if (!containedinlinking && !unknown && (mode == Mode::FS || mode == Mode::OS || mode == Mode::LS))
             return;
@@ -565,6 +565,7 @@ void handle_telegrams(std::vector<eurobalise_telegram> message, distance dist, i
             remove_vbc(*it);
     }
 
+    auto arena = std::make_shared<message_arena>();
     std::list<std::shared_ptr<etcs_information>> ordered_info;
     for (int i=0; i<message.size(); i++) {
         eurobalise_telegram t = message[i];
@@ -589,15 +590,11 @@ void handle_telegrams(std::vector<eurobalise_telegram> message, distance dist, i
                 ordered_info.clear();
 
                 InfillLocationReference ilr = *((InfillLocationReference*)p);
-                bool found = false;
-                for (auto it = link_expected; it!=linking.end(); ++it) {
-                    link_data &l = *it;
-                    if (l.nid_bg == bg_id({ilr.Q_NEWCOUNTRY == Q_NEWCOUNTRY_t::SameCountry ? nid_bg.NID_C : ilr.NID_C, (int)ilr.NID_BG})) {
-                        found = true;
-                        infill = true;
-                        ref = l.dist;
-                        break;
-                    }
+                auto it = linking.find_first({ilr.Q_NEWCOUNTRY == Q_NEWCOUNTRY_t::SameCountry ? nid_bg.NID_C : ilr.NID_C, (int)ilr.NID_BG}, link_expected);
+                bool found = it != linking.end();
+                if (found) {
+                    infill = true;
+                    ref = it->dist;
                 }
                 if (!found)
                     return;
@@ -609,7 +606,7 @@ void handle_telegrams(std::vector<eurobalise_telegram> message, distance dist, i
                     }
                 }
             }
-            std::vector<etcs_information*> info = construct_information(p, nullptr);
+            std::vector<std::shared_ptr<etcs_information>> info = construct_information(p, nullptr, arena);
             for (int i=0; i<info.size(); i++) {
                 info[i]->linked_packets.push_back(t.packets[j]);
                 info[i]->ref = ref;
@@ -619,7 +616,7 @@ void handle_telegrams(std::vector<eurobalise_telegram> message, distance dist, i
                 info[i]->timestamp = timestamp;
                 info[i]->nid_bg = nid_bg;
                 info[i]->version = m_version;
-                ordered_info.push_back(std::shared_ptr<etcs_information>(info[i]));
+                ordered_info.push_back(info[i]);
             }
         }
     }
@@ -639,19 +636,18 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
         transition_buffer.push_back({});
     }
     message = translate_message(message, session->version);
+    auto arena = message->arena.lock();
     std::list<std::shared_ptr<etcs_information>> ordered_info;
     bg_id lrbg = message->NID_LRBG.get_value();
     distance ref = distance(0, odometer_orientation, 0);
     bool valid_lrbg = false;
     int dir = -1;
-    for (lrbg_info info : lrbgs) {
-        if (info.nid_lrbg == lrbg) {
-            valid_lrbg = true;
-            ref = info.position;
-            std::cout<<"Ref: "<<ref.get()<<std::endl;
-            dir = info.dir;
-            break;
-        }
+    auto info = lrbgs.find_first(lrbg);
+    if (info != lrbgs.end()) {
+        valid_lrbg = true;
+        ref = info->position;
+        std::cout<<"Ref: "<<ref.get()<<std::endl;
+        dir = info->dir;
     }
     if (!valid_lrbg && message->NID_LRBG!=NID_LRBG_t::Unknown)
         return;
@@ -675,25 +671,25 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
             break;
     }
     {
-        etcs_information* info = nullptr;
+        std::shared_ptr<etcs_information> info;
         switch (message->NID_MESSAGE) {
             case 2:
-                info = new SR_authorisation_info();
+                info = arena_new<SR_authorisation_info>(arena);
                 break;
             case 6:
-                info = new etcs_information(37, 39, []() {
+                info = arena_new<etcs_information>(arena, 37, 39, []() {
                     trip_exit_acknowledged = true;
                 });
                 break;
             case 8:
-                info = new etcs_information(38, 40, [session]() {
+                info = arena_new<etcs_information>(arena, 38, 40, [session]() {
                     session->train_data_ack_pending = false;
                 });
                 break;
             case 15:{
                 auto *emerg = (conditional_emergency_stop*)message.get();
                 if (!((emerg->Q_DIR == Q_DIR_t::Nominal && dir == 1) && (emerg->Q_DIR == Q_DIR_t::Reverse && dir == 0))) {
-                    info = new etcs_information(41, 43, [emerg,ref]() {
+                    info = arena_new<etcs_information>(arena, 41, 43, [emerg,ref]() {
                         int result = handle_conditional_emergency_stop(emerg->NID_EM, ref+emerg->D_EMERGENCYSTOP.get_value(emerg->Q_SCALE));
                         emergency_acknowledgement_message *ack = new emergency_acknowledgement_message();
                         ack->NID_EM = emerg->NID_EM;
@@ -705,7 +701,7 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
                 break;
             }
             case 16:
-                info = new etcs_information(40, 42, [message]() {
+                info = arena_new<etcs_information>(arena, 40, 42, [message]() {
                     auto *emerg = (unconditional_emergency_stop*)message.get();
                     handle_unconditional_emergency_stop(emerg->NID_EM);
                     emergency_acknowledgement_message *ack = new emergency_acknowledgement_message();
@@ -716,23 +712,23 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
                 });
                 break;
             case 18:
-                info = new etcs_information(42, 44, [message]() {
+                info = arena_new<etcs_information>(arena, 42, 44, [message]() {
                     auto *emerg = (emergency_stop_revocation*)message.get();
                     revoke_emergency_stop(emerg->NID_EM);
                 });
                 break;
             case 27:
-                info = new etcs_information(43, 45, []() {
+                info = arena_new<etcs_information>(arena, 43, 45, []() {
                     update_dialog_step("SH refused", "");
                 });
                 break;
             case 28:
-                info = new SH_authorisation_info();
+                info = arena_new<SH_authorisation_info>(arena);
                 break;
             case 34:{
                 auto *taf = (taf_request_message*)message.get();
                 if (!((taf->Q_DIR == Q_DIR_t::Nominal && dir == 1) && (taf->Q_DIR == Q_DIR_t::Reverse && dir == 0))) {
-                    info = new etcs_information(47, 49, [taf,ref]() {
+                    info = arena_new<etcs_information>(arena, 47, 49, [taf,ref]() {
                         distance dist = ref + taf->D_TAFDISPLAY.get_value(taf->Q_SCALE);
                         double length = taf->L_TAFDISPLAY.get_value(taf->Q_SCALE);
                         request_track_ahead_free(dist, length);
@@ -741,22 +737,22 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
                 break;
             }
             case 40:
-                info = new etcs_information(50, 52, []() {
+                info = arena_new<etcs_information>(arena, 50, 52, []() {
                     if (som_status == D33 || som_status == D22)
                         som_status = A38;
                 });
                 break;
             case 41:
-                info = new etcs_information(51, 53, []() {
+                info = arena_new<etcs_information>(arena, 51, 53, []() {
                     if (som_status == D33 || som_status == D22)
                         som_status = A23;
                 });
                 break;
             case 43:
-                info = new etcs_information(52, 54, [](){ position_valid = true; });
+                info = arena_new<etcs_information>(arena, 52, 54, [](){ position_valid = true; });
                 break;
             case 45:
-                info = new coordinate_system_information();
+                info = arena_new<coordinate_system_information>(arena);
                 break;
             default:
                 break;
@@ -770,7 +766,7 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
             info->timestamp = message->T_TRAIN.get_value();
             info->message = message;
             info->version = session->version;
-            ordered_info.push_back(std::shared_ptr<etcs_information>(info));
+            ordered_info.push_back(info);
         }
     }
     bool infill=false;
@@ -783,15 +779,11 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
         }
         if (p->NID_PACKET == 136) {
             InfillLocationReference ilr = *((InfillLocationReference*)p);
-            bool found = false;
-            for (auto it = link_expected; it!=linking.end(); ++it) {
-                link_data &l = *it;
-                if (l.nid_bg == bg_id({ilr.Q_NEWCOUNTRY == Q_NEWCOUNTRY_t::SameCountry ? lrbg.NID_C : ilr.NID_C, (int)ilr.NID_BG})) {
-                    found = true;
-                    infill = true;
-                    ref = l.dist;
-                    break;
-                }
+            auto it = linking.find_first({ilr.Q_NEWCOUNTRY == Q_NEWCOUNTRY_t::SameCountry ? lrbg.NID_C : ilr.NID_C, (int)ilr.NID_BG}, link_expected);
+            bool found = it != linking.end();
+            if (found) {
+                infill = true;
+                ref = it->dist;
             }
             if (!found)
                 break;
@@ -817,7 +809,7 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
                 } 
             }
         }
-        std::vector<etcs_information*> info = construct_information(p, message.get());
+        std::vector<std::shared_ptr<etcs_information>> info = construct_information(p, message.get(), arena);
         for (int i=0; i<info.size(); i++) {
             info[i]->linked_packets.push_back(message->packets[j]);
             info[i]->ref = ref;
@@ -828,7 +820,7 @@ void handle_radio_message(std::shared_ptr<euroradio_message> message, communicat
             info[i]->timestamp = message->T_TRAIN.get_value()*10;
             info[i]->message = message;
             info[i]->version = session->version;
-            ordered_info.push_back(std::shared_ptr<etcs_information>(info[i]));
+            ordered_info.push_back(info[i]);
         }
     }
     ordered_info.sort(info_compare);
@@ -857,7 +849,7 @@ struct accepted_condition
     bool reject;
     std::set<int> exceptions;
 };
-std::map<level_filter_data, accepted_condition> level_filter_index;
+EVC_STATE std::map<level_filter_data, accepted_condition> level_filter_index;
 bool level_filter(std::shared_ptr<etcs_information> info, std::list<std::shared_ptr<etcs_information>> message) 
 {
     accepted_condition s = level_filter_index[{info->index_level, level, info->fromRBC != nullptr}];
@@ -1062,7 +1054,7 @@ struct mode_filter_data
         return num<o.num;
     }
 };
-std::map<mode_filter_data, accepted_condition> mode_filter_index;
+EVC_STATE std::map<mode_filter_data, accepted_condition> mode_filter_index;
 void set_mode_filter()
 {
     std::vector<std::vector<std::string>> conds = {
@@ -1246,89 +1238,89 @@ void try_handle_information(std::shared_ptr<etcs_information> info, std::list<st
     if (!mode_filter(info, message)) return;
     info->handle();
 }
-std::vector<etcs_information*> construct_information(ETCS_packet *packet, euroradio_message *msg)
+std::vector<std::shared_ptr<etcs_information>> construct_information(ETCS_packet *packet, euroradio_message *msg, const std::shared_ptr<message_arena> &arena)
 {
     int packet_num = packet->NID_PACKET.rawdata;
-    std::vector<etcs_information*> info;
+    std::vector<std::shared_ptr<etcs_information>> info;
     if (packet_num == 2) {
-        info.push_back(new version_order_information());
+        info.push_back(arena_new<version_order_information>(arena));
     } else if (packet_num == 3) {
-        info.push_back(new national_values_information());
+        info.push_back(arena_new<national_values_information>(arena));
     } else if (packet_num == 5) {
-        info.push_back(new linking_information());
+        info.push_back(arena_new<linking_information>(arena));
     } else if (packet_num == 6) {
-        info.push_back(new vbc_order());
+        info.push_back(arena_new<vbc_order>(arena));
     } else if (packet_num == 12) {
-        info.push_back(new ma_information());
-        info.push_back(new signalling_information());
+        info.push_back(arena_new<ma_information>(arena));
+        info.push_back(arena_new<signalling_information>(arena));
     } else if (packet_num == 15) {
         if (msg != nullptr && msg->NID_MESSAGE == 9)
-            info.push_back(new ma_shortening_information());
+            info.push_back(arena_new<ma_shortening_information>(arena));
         else
-            info.push_back(new ma_information_lv2());
+            info.push_back(arena_new<ma_information_lv2>(arena));
     } else if (packet_num == 16) {
-        info.push_back(new repositioning_information());
+        info.push_back(arena_new<repositioning_information>(arena));
     } else if (packet_num == 21) {
-        info.push_back(new gradient_information());
+        info.push_back(arena_new<gradient_information>(arena));
     } else if (packet_num == 27) {
-        info.push_back(new issp_information());
+        info.push_back(arena_new<issp_information>(arena));
     } else if (packet_num == 39) {
-        info.push_back(new track_condition_information());
+        info.push_back(arena_new<track_condition_information>(arena));
     } else if (packet_num == 40) {
-        info.push_back(new track_condition_information());
+        info.push_back(arena_new<track_condition_information>(arena));
     } else if (packet_num == 41) {
-        info.push_back(new leveltr_order_information());
+        info.push_back(arena_new<leveltr_order_information>(arena));
     } else if (packet_num == 42) {
-        info.push_back(new session_management_information());
+        info.push_back(arena_new<session_management_information>(arena));
     } else if (packet_num == 46) {
-        info.push_back(new condleveltr_order_information());
+        info.push_back(arena_new<condleveltr_order_information>(arena));
     } else if (packet_num == 52) {
-        info.push_back(new pbd_information());
+        info.push_back(arena_new<pbd_information>(arena));
     } else if (packet_num == 57) {
-        info.push_back(new ma_request_params_info());
+        info.push_back(arena_new<ma_request_params_info>(arena));
     } else if (packet_num == 58) {
-        info.push_back(new position_report_params_info());
+        info.push_back(arena_new<position_report_params_info>(arena));
     } else if (packet_num == 65) {
-        info.push_back(new TSR_information());
+        info.push_back(arena_new<TSR_information>(arena));
     } else if (packet_num == 66) {
-        info.push_back(new TSR_revocation_information());
+        info.push_back(arena_new<TSR_revocation_information>(arena));
     } else if (packet_num == 67) {
-        info.push_back(new track_condition_big_metal_information());
+        info.push_back(arena_new<track_condition_big_metal_information>(arena));
     } else if (packet_num == 68) {
-        info.push_back(new track_condition_information());
-        info.push_back(new track_condition_information2());
+        info.push_back(arena_new<track_condition_information>(arena));
+        info.push_back(arena_new<track_condition_information2>(arena));
     } else if (packet_num == 69) {
-        info.push_back(new track_condition_information());
+        info.push_back(arena_new<track_condition_information>(arena));
     } else if (packet_num == 70) {
-        info.push_back(new route_suitability_information());
+        info.push_back(arena_new<route_suitability_information>(arena));
     } else if (packet_num == 72) {
-        info.push_back(new plain_text_information());
+        info.push_back(arena_new<plain_text_information>(arena));
     } else if (packet_num == 76) {
-        info.push_back(new fixed_text_information());
+        info.push_back(arena_new<fixed_text_information>(arena));
     } else if (packet_num == 79) {
-        info.push_back(new geographical_position_information());
+        info.push_back(arena_new<geographical_position_information>(arena));
     } else if (packet_num == 88) {
-        info.push_back(new level_crossing_information());
+        info.push_back(arena_new<level_crossing_information>(arena));
     } else if (packet_num == 90) {
-        info.push_back(new taf_level23_information());
+        info.push_back(arena_new<taf_level23_information>(arena));
     } else if (packet_num == 131) {
-        info.push_back(new rbc_transition_information());
+        info.push_back(arena_new<rbc_transition_information>(arena));
     } else if (packet_num == 132) {
-        info.push_back(new danger_for_SH_information());
+        info.push_back(arena_new<danger_for_SH_information>(arena));
     } else if (packet_num == 137) {
-        info.push_back(new stop_if_in_SR_information());
+        info.push_back(arena_new<stop_if_in_SR_information>(arena));
     } else if (packet_num == 140) {
-        info.push_back(new train_running_number_information());
+        info.push_back(arena_new<train_running_number_information>(arena));
     } else if (packet_num == 141) {
-        info.push_back(new TSR_gradient_information());
+        info.push_back(arena_new<TSR_gradient_information>(arena));
     } else if (packet_num == 180) {
         auto *order = (LSSMAToggleOrder*)packet;
         if (order->Q_LSSMA == Q_LSSMA_t::ToggleOff)
-            info.push_back(new lssma_display_off_information());
+            info.push_back(arena_new<lssma_display_off_information>(arena));
         else
-            info.push_back(new lssma_display_on_information());
+            info.push_back(arena_new<lssma_display_on_information>(arena));
     } else if (packet_num == 181) {
-        info.push_back(new generic_ls_marker_information());
+        info.push_back(arena_new<generic_ls_marker_information>(arena));
     }
     return info;
 }
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <iostream>
 #include <deque>
+#include "../Context/state.h"
 struct eurobalise_telegram : public ETCS_message
 {
     Q_UPDOWN_t Q_UPDOWN;
@@ -36,7 +37,7 @@ struct eurobalise_telegram : public ETCS_message
     std::vector<std::shared_ptr<ETCS_packet>> packets;
     eurobalise_telegram(bit_manipulator &b)
     {
-        extern double or_dist;
+        extern EVC_STATE double or_dist;
         Q_UPDOWN.copy(b);
         M_VERSION.copy(b);
         Q_MEDIA.copy(b);
@@ -47,13 +48,14 @@ struct eurobalise_telegram : public ETCS_message
         NID_C.copy(b);
         NID_BG.copy(b);
         Q_LINK.copy(b);
+        auto arena = std::make_shared<message_arena>();
         while (!b.error)
         {
             NID_PACKET_t NID_PACKET;
             b.peek(&NID_PACKET);
             if (NID_PACKET==255)
                 break;
-            packets.push_back(std::shared_ptr<ETCS_packet>(ETCS_packet::construct(b, M_VERSION)));
+            packets.push_back(ETCS_packet::construct(b, M_VERSION, arena));
         }
         readerror = b.error;
         valid = !b.sparefound;
@@ -78,8 +80,8 @@ struct eurobalise_telegram : public ETCS_message
         NID_PACKET.copy(b);
     }
 };
-extern std::deque<std::pair<eurobalise_telegram, std::pair<distance,int64_t>>> pending_telegrams;
-extern std::list<link_data>::iterator link_expected;
+extern EVC_STATE std::deque<std::pair<eurobalise_telegram, std::pair<distance,int64_t>>> pending_telegrams;
+extern EVC_STATE linking_list::iterator link_expected;
 void update_track_comm();
 void handle_radio_message(std::shared_ptr<euroradio_message> msg, communication_session *session);
 void set_message_filters();
\ No newline at end of file
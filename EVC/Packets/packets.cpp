@@ -59,78 +59,78 @@
 #include "V1/200.h"
 #include "V1/203.h"
 #include "254.h"
-ETCS_packet *ETCS_packet::construct(bit_manipulator &r, int m_version)
+std::shared_ptr<ETCS_packet> ETCS_packet::construct(bit_manipulator &r, int m_version, const std::shared_ptr<message_arena> &arena)
 {
     int pos = r.position;
     NID_PACKET_t NID_PACKET;
     r.peek(&NID_PACKET);
-    ETCS_packet *p = nullptr;
+    std::shared_ptr<ETCS_packet> p;
     switch ((unsigned char)NID_PACKET) {
-        case 0: p = new VirtualBaliseCoverMarker(); break;
-        case 2: p = new SystemVersionOrder(); break;
+        case 0: p = arena_new<VirtualBaliseCoverMarker>(arena); break;
+        case 2: p = arena_new<SystemVersionOrder>(arena); break;
         case 3:
-            if (VERSION_X(m_version == 1)) p = new V1::NationalValues();
-            else p = new NationalValues();
+            if (VERSION_X(m_version == 1)) p = arena_new<V1::NationalValues>(arena);
+            else p = arena_new<NationalValues>(arena);
             break;
-        case 5: p = new Linking(); break;
-        case 6: p = new VirtualBaliseCoverOrder(); break;
-        case 12: p = new Level1_MA(); break;
-        case 16: p = new RepositioningInformation(); break;
-        case 21: p = new GradientProfile(); break;
+        case 5: p = arena_new<Linking>(arena); break;
+        case 6: p = arena_new<VirtualBaliseCoverOrder>(arena); break;
+        case 12: p = arena_new<Level1_MA>(arena); break;
+        case 16: p = arena_new<RepositioningInformation>(arena); break;
+        case 21: p = arena_new<GradientProfile>(arena); break;
         case 27:
-            if (VERSION_X(m_version == 1)) p = new V1::InternationalSSP();
-            else p = new InternationalSSP();
+            if (VERSION_X(m_version == 1)) p = arena_new<V1::InternationalSSP>(arena);
+            else p = arena_new<InternationalSSP>(arena);
             break;
         case 39:
-            if (VERSION_X(m_version == 1)) p = new V1::TrackConditionChangeTractionSystem();
-            else p = new TrackConditionChangeTractionSystem();
+            if (VERSION_X(m_version == 1)) p = arena_new<V1::TrackConditionChangeTractionSystem>(arena);
+            else p = arena_new<TrackConditionChangeTractionSystem>(arena);
             break;
-        case 40: p = new TrackConditionChangeCurrentConsumption(); break;
-        case 41: p = new LevelTransitionOrder(); break;
-        case 42: p = new SessionManagement(); break;
-        case 45: p = new RadioNetworkRegistration(); break;
-        case 46: p = new ConditionalLevelTransitionOrder(); break;
-        case 49: p = new ListSHBalises();
-        case 52: p = new PermittedBrakingDistanceInformation(); break;
-        case 57: p = new MovementAuthorityRequestParameters(); break;
-        case 58: p = new PositionReportParameters(); break;
-        case 63: p = new ListSHBalises();
-        case 64: p = new InhibitionOfRevocableTSRL23(); break;
-        case 65: p = new TemporarySpeedRestriction(); break;
-        case 66: p = new TemporarySpeedRestrictionRevocation(); break;
-        case 67: p = new TrackConditionBigMetalMasses(); break;
-        case 68: p = new TrackCondition(); break;
-        case 69: p = new TrackConditionStationPlatforms(); break;
-        case 70: p = new RouteSuitabilityData(); break;
-        case 71: p = new AdhesionFactor(); break;
+        case 40: p = arena_new<TrackConditionChangeCurrentConsumption>(arena); break;
+        case 41: p = arena_new<LevelTransitionOrder>(arena); break;
+        case 42: p = arena_new<SessionManagement>(arena); break;
+        case 45: p = arena_new<RadioNetworkRegistration>(arena); break;
+        case 46: p = arena_new<ConditionalLevelTransitionOrder>(arena); break;
+        case 49: p = arena_new<ListSHBalises>(arena);
+        case 52: p = arena_new<PermittedBrakingDistanceInformation>(arena); break;
+        case 57: p = arena_new<MovementAuthorityRequestParameters>(arena); break;
+        case 58: p = arena_new<PositionReportParameters>(arena); break;
+        case 63: p = arena_new<ListSHBalises>(arena);
+        case 64: p = arena_new<InhibitionOfRevocableTSRL23>(arena); break;
+        case 65: p = arena_new<TemporarySpeedRestriction>(arena); break;
+        case 66: p = arena_new<TemporarySpeedRestrictionRevocation>(arena); break;
+        case 67: p = arena_new<TrackConditionBigMetalMasses>(arena); break;
+        case 68: p = arena_new<TrackCondition>(arena); break;
+        case 69: p = arena_new<TrackConditionStationPlatforms>(arena); break;
+        case 70: p = arena_new<RouteSuitabilityData>(arena); break;
+        case 71: p = arena_new<AdhesionFactor>(arena); break;
         case 72:
-            if (VERSION_X(m_version == 1)) p = new V1::PlainTextMessage();
-            else p = new PlainTextMessage();
+            if (VERSION_X(m_version == 1)) p = arena_new<V1::PlainTextMessage>(arena);
+            else p = arena_new<PlainTextMessage>(arena);
             break;
-        case 76: p = new FixedTextMessage(); break;
+        case 76: p = arena_new<FixedTextMessage>(arena); break;
         case 79:
-            if (VERSION_X(m_version == 1)) p = new V1::GeographicalPosition();
-            else p = new GeographicalPosition();
+            if (VERSION_X(m_version == 1)) p = arena_new<V1::GeographicalPosition>(arena);
+            else p = arena_new<GeographicalPosition>(arena);
             break;
         case 80:
-            if (VERSION_X(m_version == 1)) p = new V1::ModeProfile();
-            else p = new ModeProfile();
+            if (VERSION_X(m_version == 1)) p = arena_new<V1::ModeProfile>(arena);
+            else p = arena_new<ModeProfile>(arena);
             break;
-        case 88: p = new LevelCrossingInformation(); break;
-        case 90: p = new TrackAheadFreeTransition(); break;
-        case 131: p = new RBCTransitionOrder(); break;
-        case 132: p = new DangerForShunting(); break;
-        case 136: p = new InfillLocationReference(); break;
-        case 137: p = new StopIfInSR(); break;
-        case 140: p = new TrainRunningNumberRBC(); break;
-        case 141: p = new DefaultGradientTSR(); break;
-        case 180: p = new LSSMAToggleOrder(); break;
-        case 181: p = new GenericLSFunctionMarker(); break;
-        case 200: if (VERSION_X(m_version) == 1) p = new V1::VirtualBaliseCoverMarker(); break;
-        case 203: if (VERSION_X(m_version) == 1) p = new V1::NationalValuesBraking(); break;
-        case 206: if (VERSION_X(m_version) == 1) p = new TrackCondition(); break;
-        case 239: if (VERSION_X(m_version) == 1) p = new TrackConditionChangeTractionSystem(); break;
-        case 254: p = new DefaultBaliseInformation(); break;
+        case 88: p = arena_new<LevelCrossingInformation>(arena); break;
+        case 90: p = arena_new<TrackAheadFreeTransition>(arena); break;
+        case 131: p = arena_new<RBCTransitionOrder>(arena); break;
+        case 132: p = arena_new<DangerForShunting>(arena); break;
+        case 136: p = arena_new<InfillLocationReference>(arena); break;
+        case 137: p = arena_new<StopIfInSR>(arena); break;
+        case 140: p = arena_new<TrainRunningNumberRBC>(arena); break;
+        case 141: p = arena_new<DefaultGradientTSR>(arena); break;
+        case 180: p = arena_new<LSSMAToggleOrder>(arena); break;
+        case 181: p = arena_new<GenericLSFunctionMarker>(arena); break;
+        case 200: if (VERSION_X(m_version) == 1) p = arena_new<V1::VirtualBaliseCoverMarker>(arena); break;
+        case 203: if (VERSION_X(m_version) == 1) p = arena_new<V1::NationalValuesBraking>(arena); break;
+        case 206: if (VERSION_X(m_version) == 1) p = arena_new<TrackCondition>(arena); break;
+        case 239: if (VERSION_X(m_version) == 1) p = arena_new<TrackConditionChangeTractionSystem>(arena); break;
+        case 254: p = arena_new<DefaultBaliseInformation>(arena); break;
         default: break;
     }
     if (p == nullptr) {
@@ -141,7 +141,7 @@ ETCS_packet *ETCS_packet::construct(bit_manipulator &r, int m_version)
         }
         if (!highery)
             r.sparefound = true;
-        p = new ETCS_directional_packet();
+        p = arena_new<ETCS_directional_packet>(arena);
     }
     p->copy(r);
     if (NID_PACKET != 0 && r.position-pos != p->L_PACKET)
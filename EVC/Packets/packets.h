@@ -9,7 +9,9 @@
 #pragma once
 #include "variables.h"
 #include "types.h"
+#include "arena.h"
 #include <map>
+#include <memory>
 struct ETCS_message
 {
     bool valid;
@@ -40,7 +42,7 @@ struct ETCS_packet
         L_PACKET.rawdata = w.position-start;
         w.replace(&L_PACKET, start+8);
     }
-    static ETCS_packet *construct(bit_manipulator &r, int m_version);
+    static std::shared_ptr<ETCS_packet> construct(bit_manipulator &r, int m_version, const std::shared_ptr<message_arena> &arena = nullptr);
 };
 struct ETCS_nondirectional_packet : ETCS_packet
 {
@@ -12,99 +12,12 @@
 #include "../MA/movement_authority.h"
 #include "../Supervision/supervision.h"
 #include "../Version/version.h"
+#include "../Supervision/speed_profile.h"
+#include "../Supervision/train_data.h"
+#include "../Context/state.h"
 void ma_request(bool driver, bool perturb, bool timer, bool trackdel, bool taf);
 void fill_pos_report(euroradio_message_traintotrack *m);
 ETCS_packet *get_position_report();
-std::shared_ptr<euroradio_message> euroradio_message::build(bit_manipulator &r, int m_version)
-{
-    int size = r.bits.size();
-    NID_MESSAGE_t nid;
-    r.peek(&nid);
-    euroradio_message* msg;
-    switch (nid.rawdata) {
-        case 2: msg = new SR_authorisation(); break;
-        case 3: msg = new MA_message(); break;
-        case 6: msg = new TR_exit_recognition(); break;
-        case 8: msg = new train_data_acknowledgement(); break;
-        case 9: msg = new MA_shortening_message(); break;
-        case 15: msg = new conditional_emergency_stop(m_version); break;
-        case 16: msg = new unconditional_emergency_stop(); break;
-        case 18: msg = new emergency_stop_revocation(); break;
-        case 24: msg = new euroradio_message(); break;
-        case 27: msg = new SH_refused(); break;
-        case 28: msg = new SH_authorised(); break;
-        case 32: msg = new RBC_version(); break;
-        case 33: msg = new MA_shifted_message(); break;
-        case 34: msg = new taf_request_message(m_version); break;
-        case 39: msg = new ack_session_termination(); break;
-        case 40: msg = new train_rejected(); break;
-        case 41: msg = new train_accepted(); break;
-        case 43: msg = new som_position_confirmed(); break;
-        case 45: msg = new coordinate_system_assignment(); break;
-        default:
-            bool highery = false;
-            for (int v : supported_versions) {
-                if (VERSION_X(m_version)==VERSION_X(v) && VERSION_Y(m_version)>VERSION_Y(v))
-                    highery = true;
-            }
-            if (!highery)
-                r.sparefound = true;
-            msg = new euroradio_message();
-            break;
-    }
-    msg->copy(r);
-    while (!r.error && r.position<=(r.bits.size()*8-8))
-    {
-        NID_PACKET_t NID_PACKET;
-        r.peek(&NID_PACKET);
-        if (NID_PACKET==255)
-            break;
-        msg->optional_packets.push_back(std::shared_ptr<ETCS_packet>(ETCS_packet::construct(r, m_version)));
-    }
-    msg->packets.insert(msg->packets.end(), msg->optional_packets.begin(), msg->optional_packets.end());
-    if (msg->L_MESSAGE != size) r.error=true;
-    msg->readerror = r.error;
-    msg->valid = !r.sparefound;
-    return std::shared_ptr<euroradio_message>(msg);
-}
-std::shared_ptr<euroradio_message_traintotrack> euroradio_message_traintotrack::build(bit_manipulator &r)
-{
-    int size = r.bits.size();
-    NID_MESSAGE_t nid;
-    r.peek(&nid);
-    euroradio_message_traintotrack *msg;
-    switch (nid.rawdata) {
-        case 129: msg = new validated_train_data_message(); break;
-        case 130: msg = new SH_request(); break;
-        case 132: msg = new MA_request(); break;
-        case 136: msg = new position_report(); break;
-        case 137: msg = new ma_shorten_granted(); break;
-        case 138: msg = new ma_shorten_rejected(); break;
-        case 146: msg = new acknowledgement_message(); break;
-        case 147: msg = new emergency_acknowledgement_message(); break;
-        case 149: msg = new taf_granted(); break;
-        case 154: msg = new no_compatible_session_supported(); break;
-        case 155: msg = new init_communication_session(); break;
-        case 156: msg = new terminate_communication_session(); break;
-        case 157: msg = new SoM_position_report(); break;
-        case 159: msg = new communication_session_established(); break;
-        default: r.sparefound = true; msg = new euroradio_message_traintotrack(); break;
-    }
-    msg->copy(r);
-    while (!r.error && r.position<=(r.bits.size()*8-8))
-    {
-        NID_PACKET_t NID_PACKET;
-        r.peek(&NID_PACKET);
-        if (NID_PACKET==255)
-            break;
-        msg->optional_packets.push_back(std::shared_ptr<ETCS_packet>(ETCS_packet::construct(r, 33)));
-    }
-    msg->packets.insert(msg->packets.end(), msg->optional_packets.begin(), msg->optional_packets.end());
-    if (msg->L_MESSAGE != size) r.error=true;
-    msg->readerror = r.error;
-    msg->valid = !r.sparefound;
-    return std::shared_ptr<euroradio_message_traintotrack>(msg);
-}
 /*void send_message(euroradio_message_traintotrack *m)
 {
     m->T_TRAIN.rawdata = get_milliseconds()/10;
@@ -131,21 +44,79 @@ std::shared_ptr<euroradio_message_traintotrack> euroradio_message_traintotrack::
     bit_manipulator r(base64_decode(str.str(), true));
     //auto msg = euroradio_message_traintotrack::build(r);
 }*/
-optional<position_report_parameters> pos_report_params;
-ma_request_parameters ma_params = {30000, (int64_t)(T_CYCRQSTD*1000), 30000};
-int64_t ma_asked;
-bool ma_rq_reasons[5];
-bool ma_rq_reasons_old[5];
-int64_t t_last_pos_rep;
-distance d_last_pos_rep;
+EVC_STATE optional<position_report_parameters> pos_report_params;
+EVC_STATE ma_request_parameters ma_params = {30000, (int64_t)(T_CYCRQSTD*1000), 30000};
+EVC_STATE int64_t ma_asked;
+EVC_STATE bool ma_rq_reasons[5];
+EVC_STATE bool ma_rq_reasons_old[5];
+EVC_STATE int64_t t_last_pos_rep;
+EVC_STATE distance d_last_pos_rep;
+/*
+ * Points in time and along the track at which the next periodic position
+ * report is due. They only change when a report is sent or the position
+ * report parameters are replaced, so most cycles just compare against them.
+ */
+struct position_report_schedule
+{
+    int64_t T_sendreport = -1;
+    double D_sendreport = -1;
+    int64_t time;
+    distance ahead;
+    distance behind;
+};
+EVC_STATE position_report_schedule report_schedule;
+static void schedule_position_report()
+{
+    report_schedule.T_sendreport = pos_report_params->T_sendreport;
+    report_schedule.D_sendreport = pos_report_params->D_sendreport;
+    report_schedule.time = t_last_pos_rep + report_schedule.T_sendreport;
+    report_schedule.ahead = d_last_pos_rep + report_schedule.D_sendreport;
+    report_schedule.behind = d_last_pos_rep - report_schedule.D_sendreport;
+}
+static bool periodic_report_due()
+{
+    if (report_schedule.T_sendreport != pos_report_params->T_sendreport || report_schedule.D_sendreport != pos_report_params->D_sendreport)
+        schedule_position_report();
+    return get_milliseconds() > report_schedule.time || d_estfront > report_schedule.ahead || d_estfront < report_schedule.behind;
+}
+static bool location_report_due()
+{
+    // Locations are given in increasing distance, so only the first one
+    // of each list can have been passed
+    bool due = false;
+    auto &front = pos_report_params->location_front;
+    while (!front.empty() && d_maxsafefront(front.front()) > front.front()) {
+        front.pop_front();
+        due = true;
+    }
+    auto &rear = pos_report_params->location_rear;
+    while (!rear.empty() && d_minsafefront(rear.front())-L_TRAIN > rear.front()) {
+        rear.pop_front();
+        due = true;
+    }
+    return due;
+}
+static bool perturbation_ahead()
+{
+    // The advance uses the ceiling speed, which never exceeds the train
+    // speed while the MRSP is populated. Only when the train is within that
+    // bound is the actual ceiling speed computed.
+    double V_bound = get_MRSP().empty() ? 1000 : V_train;
+    double max_advance = (V_bound + dV_warning(V_bound))*ma_params.T_MAR/1000;
+    bool eoa = d_perturbation_eoa && *d_perturbation_eoa-max_advance < d_estfront;
+    bool svl = d_perturbation_svl && *d_perturbation_svl-max_advance < d_maxsafefront(*d_perturbation_svl);
+    if (!eoa && !svl)
+        return false;
+    double V_MRSP = calc_ceiling_limit();
+    double advance = (V_MRSP + dV_warning(V_MRSP))*ma_params.T_MAR/1000;
+    return (eoa && *d_perturbation_eoa-advance < d_estfront) || (svl && *d_perturbation_svl-advance < d_maxsafefront(*d_perturbation_svl));
+}
 void update_radio()
 {
     update_euroradio();
     if (supervising_rbc) {
-        double V_MRSP = calc_ceiling_limit();
-        double advance = (V_MRSP + dV_warning(V_MRSP))*ma_params.T_MAR/1000;
         if ((mode == Mode::FS || mode == Mode::LS || mode == Mode::OS) && (level == Level::N2 || level == Level::N3)) {
-            ma_rq_reasons[1] = (d_perturbation_eoa && *d_perturbation_eoa-advance < d_estfront) || (d_perturbation_svl && *d_perturbation_svl-advance < d_maxsafefront(*d_perturbation_svl));
+            ma_rq_reasons[1] = perturbation_ahead();
             ma_rq_reasons[2] = ma_params.T_TIMEOUTRQST > 0 && MA && MA->timers_to_expire(ma_params.T_TIMEOUTRQST);
         }
         bool request = false;
@@ -172,24 +143,19 @@ void update_radio()
             }
         }
         if (pos_report_params) {
-            if (std::abs(d_estfront-d_last_pos_rep) > pos_report_params->D_sendreport)
-                rep = true;
-            if (get_milliseconds()-t_last_pos_rep > pos_report_params->T_sendreport)
+            if (location_report_due())
                 rep = true;
-            for (auto it = pos_report_params->location_front.begin(); it != pos_report_params->location_front.end(); ) {
-                if (d_maxsafefront(*it)>*it) {
-                    rep = true;
-                    it = pos_report_params->location_front.erase(it);
+            // An MA request carries the train position, so it also
+            // satisfies the periodic report falling due in the same cycle.
+            // It only goes to the supervising RBC: during a handover the
+            // other session still needs its report.
+            if (!rep && periodic_report_due()) {
+                if (request && accepting_rbc == nullptr && handing_over_rbc == nullptr) {
+                    t_last_pos_rep = get_milliseconds();
+                    d_last_pos_rep = d_estfront;
+                    schedule_position_report();
                 } else {
-                    ++it;
-                }
-            }
-            for (auto it = pos_report_params->location_rear.begin(); it != pos_report_params->location_rear.end(); ) {
-                if (d_minsafefront(*it)-L_TRAIN>*it) {
                     rep = true;
-                    it = pos_report_params->location_rear.erase(it);
-                } else {
-                    ++it;
                 }
             }
         }
@@ -201,7 +167,7 @@ void update_radio()
             b = false;
     }
 }
-int position_report_reasons[12];
+EVC_STATE int position_report_reasons[12];
 void send_position_report(bool som)
 {
     if (som) {
@@ -239,6 +205,8 @@ void send_position_report(bool som)
         }
         t_last_pos_rep = get_milliseconds();
         d_last_pos_rep = d_estfront;
+        if (pos_report_params)
+            schedule_position_report();
     }
     for (auto &b : position_report_reasons)
         b = false;
@@ -255,7 +223,7 @@ void ma_request(bool driver, bool perturb, bool timer, bool trackdel, bool taf)
     req->Q_MARQSTREASON.rawdata |= (taf<<Q_MARQSTREASON_t::TrackAheadFreeBit);
     supervising_rbc->send(std::shared_ptr<euroradio_message_traintotrack>(req));
 }
-int64_t last_sent_timestamp;
+EVC_STATE int64_t last_sent_timestamp;
 void fill_message(euroradio_message_traintotrack *m)
 {
     m->NID_ENGINE.rawdata = 0;
@@ -23,8 +23,9 @@
 #include "15.h"
 #include "../optional.h"
 #include "../Position/distance.h"
-extern bool ma_rq_reasons[5];
-extern int position_report_reasons[12];
+#include "../Context/state.h"
+extern EVC_STATE bool ma_rq_reasons[5];
+extern EVC_STATE int position_report_reasons[12];
 struct position_report_parameters
 {
     int64_t T_sendreport;
@@ -39,8 +40,8 @@ struct ma_request_parameters
     int64_t T_CYCRQSTD;
     int64_t T_TIMEOUTRQST;
 };
-extern optional<position_report_parameters> pos_report_params;
-extern ma_request_parameters ma_params;
+extern EVC_STATE optional<position_report_parameters> pos_report_params;
+extern EVC_STATE ma_request_parameters ma_params;
 struct euroradio_message : public ETCS_message
 {
     NID_MESSAGE_t NID_MESSAGE;
@@ -50,6 +51,7 @@ struct euroradio_message : public ETCS_message
     NID_LRBG_t NID_LRBG;
     std::vector<std::shared_ptr<ETCS_packet>> packets;
     std::vector<std::shared_ptr<ETCS_packet>> optional_packets;
+    std::weak_ptr<message_arena> arena;
     int version = 33;
     euroradio_message() {}
     virtual void copy(bit_manipulator &r)
@@ -0,0 +1,102 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "radio.h"
+#include "../Version/version.h"
+std::shared_ptr<euroradio_message> euroradio_message::build(bit_manipulator &r, int m_version)
+{
+    int size = r.bits.size();
+    NID_MESSAGE_t nid;
+    r.peek(&nid);
+    auto arena = std::make_shared<message_arena>();
+    std::shared_ptr<euroradio_message> msg;
+    switch (nid.rawdata) {
+        case 2: msg = arena_new<SR_authorisation>(arena); break;
+        case 3: msg = arena_new<MA_message>(arena); break;
+        case 6: msg = arena_new<TR_exit_recognition>(arena); break;
+        case 8: msg = arena_new<train_data_acknowledgement>(arena); break;
+        case 9: msg = arena_new<MA_shortening_message>(arena); break;
+        case 15: msg = arena_new<conditional_emergency_stop>(arena, m_version); break;
+        case 16: msg = arena_new<unconditional_emergency_stop>(arena); break;
+        case 18: msg = arena_new<emergency_stop_revocation>(arena); break;
+        case 24: msg = arena_new<euroradio_message>(arena); break;
+        case 27: msg = arena_new<SH_refused>(arena); break;
+        case 28: msg = arena_new<SH_authorised>(arena); break;
+        case 32: msg = arena_new<RBC_version>(arena); break;
+        case 33: msg = arena_new<MA_shifted_message>(arena); break;
+        case 34: msg = arena_new<taf_request_message>(arena, m_version); break;
+        case 39: msg = arena_new<ack_session_termination>(arena); break;
+        case 40: msg = arena_new<train_rejected>(arena); break;
+        case 41: msg = arena_new<train_accepted>(arena); break;
+        case 43: msg = arena_new<som_position_confirmed>(arena); break;
+        case 45: msg = arena_new<coordinate_system_assignment>(arena); break;
+        default:
+            bool highery = false;
+            for (int v : supported_versions) {
+                if (VERSION_X(m_version)==VERSION_X(v) && VERSION_Y(m_version)>VERSION_Y(v))
+                    highery = true;
+            }
+            if (!highery)
+                r.sparefound = true;
+            msg = arena_new<euroradio_message>(arena);
+            break;
+    }
+    msg->arena = arena;
+    msg->copy(r);
+    while (!r.error && r.position<=(r.bits.size()*8-8))
+    {
+        NID_PACKET_t NID_PACKET;
+        r.peek(&NID_PACKET);
+        if (NID_PACKET==255)
+            break;
+        msg->optional_packets.push_back(ETCS_packet::construct(r, m_version, arena));
+    }
+    msg->packets.insert(msg->packets.end(), msg->optional_packets.begin(), msg->optional_packets.end());
+    if (msg->L_MESSAGE != size) r.error=true;
+    msg->readerror = r.error;
+    msg->valid = !r.sparefound;
+    return msg;
+}
+std::shared_ptr<euroradio_message_traintotrack> euroradio_message_traintotrack::build(bit_manipulator &r)
+{
+    int size = r.bits.size();
+    NID_MESSAGE_t nid;
+    r.peek(&nid);
+    euroradio_message_traintotrack *msg;
+    switch (nid.rawdata) {
+        case 129: msg = new validated_train_data_message(); break;
+        case 130: msg = new SH_request(); break;
+        case 132: msg = new MA_request(); break;
+        case 136: msg = new position_report(); break;
+        case 137: msg = new ma_shorten_granted(); break;
+        case 138: msg = new ma_shorten_rejected(); break;
+        case 146: msg = new acknowledgement_message(); break;
+        case 147: msg = new emergency_acknowledgement_message(); break;
+        case 149: msg = new taf_granted(); break;
+        case 154: msg = new no_compatible_session_supported(); break;
+        case 155: msg = new init_communication_session(); break;
+        case 156: msg = new terminate_communication_session(); break;
+        case 157: msg = new SoM_position_report(); break;
+        case 159: msg = new communication_session_established(); break;
+        default: r.sparefound = true; msg = new euroradio_message_traintotrack(); break;
+    }
+    msg->copy(r);
+    while (!r.error && r.position<=(r.bits.size()*8-8))
+    {
+        NID_PACKET_t NID_PACKET;
+        r.peek(&NID_PACKET);
+        if (NID_PACKET==255)
+            break;
+        msg->optional_packets.push_back(ETCS_packet::construct(r, 33));
+    }
+    msg->packets.insert(msg->packets.end(), msg->optional_packets.begin(), msg->optional_packets.end());
+    if (msg->L_MESSAGE != size) r.error=true;
+    msg->readerror = r.error;
+    msg->valid = !r.sparefound;
+    return std::shared_ptr<euroradio_message_traintotrack>(msg);
+}
@@ -7,8 +7,9 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 #include "vbc.h"
-std::set<virtual_balise_cover> vbcs;
+EVC_STATE std::set<virtual_balise_cover> vbcs;
 #include <fstream>
+#include "../Context/state.h"
 void write_vbcs()
 {
     std::ofstream file("vbcs.dat");
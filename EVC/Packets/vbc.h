@@ -9,6 +9,7 @@
 #pragma once
 #include <set>
 #include "../Time/clock.h"
+#include "../Context/state.h"
 struct virtual_balise_cover
 {
     int NID_C;
@@ -19,7 +20,7 @@ struct virtual_balise_cover
         return NID_VBCMK < o.NID_VBCMK;
     }
 };
-extern std::set<virtual_balise_cover> vbcs;
+extern EVC_STATE std::set<virtual_balise_cover> vbcs;
 void set_vbc(virtual_balise_cover vbc);
 void remove_vbc(virtual_balise_cover vbc);
 bool vbc_ignored(int nid_c, int nid_vbcmk);
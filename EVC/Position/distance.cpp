@@ -12,11 +12,45 @@
 #include "linking.h"
 #include <limits>
 #include <iostream>
+#include "../Context/state.h"
 #define DISTANCE_COW
-distance *distance::begin = nullptr;
-distance *distance::end = nullptr;
+EVC_STATE distance *distance::begin = nullptr;
+EVC_STATE distance *distance::end = nullptr;
+EVC_STATE uint64_t distance::relocations = 0;
+static thread_local bool registration_disabled = false;
+void distance::disable_registration()
+{
+    registration_disabled = true;
+}
+void distance::link()
+{
+    if (registration_disabled)
+        return;
+    linked = true;
+    if (begin == nullptr)
+        begin = this;
+    else
+        prev = end;
+    if (end != nullptr)
+        end->next = this;
+    end = this;
+}
+void distance::unlink()
+{
+    if (!linked)
+        return;
+    if (prev == nullptr)
+        begin = next;
+    else
+        prev->next = next;
+    if (next == nullptr)
+        end = prev;
+    else
+        next->prev = prev;
+}
 void distance::update_distances(double expected, double estimated)
 {
+    relocations++;
     distance *d = begin;
     while (d != nullptr) {
         if (d->ref == 0) {
@@ -32,6 +66,7 @@ void distance::update_distances(double expected, double estimated)
 }
 void distance::update_unlinked_reference(double newref)
 {
+    relocations++;
     distance *d = begin;
     while (d != nullptr) {
         if (d->ref !=0 ) {
@@ -45,54 +80,23 @@ void distance::update_unlinked_reference(double newref)
 }
 distance::distance() : dist(0), ref(0), orientation(0)
 {
-    if (begin == nullptr)
-        begin = this;
-    else
-        prev = end;
-    if (end != nullptr)
-        end->next = this;
-    end = this;
+    link();
 }
 distance::distance(double val, int orientation, double ref) : dist(val), ref(ref), orientation(orientation)
 {
-    if (begin == nullptr)
-        begin = this;
-    else
-        prev = end;
-    if (end != nullptr)
-        end->next = this;
-    end = this;
+    link();
 }
 distance::distance(const distance &d) : dist(d.dist), ref(d.ref), orientation(d.orientation)
 {
-    if (begin == nullptr)
-        begin = this;
-    else
-        prev = end;
-    if (end != nullptr)
-        end->next = this;
-    end = this;
+    link();
 }
 distance::distance(distance &&d) : dist(d.dist),ref(d.ref),orientation(d.orientation)
 {
-    if (begin == nullptr)
-        begin = this;
-    else
-        prev = end;
-    if (end != nullptr)
-        end->next = this;
-    end = this;
+    link();
 }
 distance::~distance()
 {
-    if (prev == nullptr)
-        begin = next;
-    else
-        prev->next = next;
-    if (next == nullptr)
-        end = prev;
-    else
-        next->prev = prev;
+    unlink();
 }
 distance &distance::operator = (const distance& d)
 {
@@ -108,7 +112,7 @@ distance &distance::operator = (distance&& d)
     orientation = d.orientation;
     return *this;
 }
-bool distance::operator<(const distance d) const
+bool distance::operator<(const distance &d) const
 {
     if (orientation * d.orientation < 0) abort();
     int dir = 1;
@@ -126,7 +130,7 @@ distance &distance::operator+=(const double d)
     dist += orientation * d;
     return *this;
 }
-double distance::operator-(const distance d) const
+double distance::operator-(const distance &d) const
 {
     int dir = 1;
     if (orientation * d.orientation < 0) abort();
@@ -167,13 +171,13 @@ distance d_minsafe(distance &d)
     double reference = d.get_reference();
     return distance((d.get()-reference)*0.99-orientation*(reference==0 && !lrbgs.empty() ? lrbgs.back().locacc : Q_NVLOCACC), orientation, reference);
 }
-distance d_estfront(0,0,0);
-distance d_estfront_dir[2] = {distance(0,1,0),distance(0,-1,0)};
-double odometer_value=0;
-double odometer_reference;
-int odometer_orientation=1;
-int current_odometer_orientation=1;
-int odometer_direction=1;
+EVC_STATE distance d_estfront(0,0,0);
+EVC_STATE distance d_estfront_dir[2] = {distance(0,1,0),distance(0,-1,0)};
+EVC_STATE double odometer_value=0;
+EVC_STATE double odometer_reference;
+EVC_STATE int odometer_orientation=1;
+EVC_STATE int current_odometer_orientation=1;
+EVC_STATE int odometer_direction=1;
 void update_odometer()
 {
     d_estfront = distance(odometer_value-odometer_reference,0,0);
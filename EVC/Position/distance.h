@@ -7,15 +7,17 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 #pragma once
+#include <cstdint>
 #include <limits>
 #include <cstdlib>
+#include "../Context/state.h"
 using std::abort;
 #define DISTANCE_COW
-extern double odometer_value;
-extern double odometer_reference;
-extern int odometer_orientation;
-extern int current_odometer_orientation;
-extern int odometer_direction;
+extern EVC_STATE double odometer_value;
+extern EVC_STATE double odometer_reference;
+extern EVC_STATE int odometer_orientation;
+extern EVC_STATE int current_odometer_orientation;
+extern EVC_STATE int odometer_direction;
 /*struct _dist_base
 {
     int refcount;
@@ -32,13 +34,31 @@ private:
     double dist;
     double ref;
     int orientation;
-    static distance* begin;
-    static distance* end;
+    static EVC_STATE distance* begin;
+    static EVC_STATE distance* end;
     distance *prev=nullptr;
     distance *next=nullptr;
+    bool linked=false;
+    static EVC_STATE uint64_t relocations;
+    void link();
+    void unlink();
 public:
     static void update_distances(double expected, double estimated);
     static void update_unlinked_reference(double newref);
+    /*
+     * Distances created afterwards by the calling thread are not added to
+     * the relocation list. For helper threads whose distances never
+     * outlive the parallel section in which they were created.
+     */
+    static void disable_registration();
+    /*
+     * Incremented whenever distances are relocated, so that values derived
+     * from them can be cached.
+     */
+    static uint64_t relocation_count()
+    {
+        return relocations;
+    }
     double get() const
     {
         return dist+ref;
@@ -58,24 +78,24 @@ public:
     ~distance();
     distance &operator = (const distance& d);
     distance &operator = (distance&& d);
-    bool operator<(const distance d) const;
-    bool operator>(const distance d) const
+    bool operator<(const distance &d) const;
+    bool operator>(const distance &d) const
     {
         return d<*this;
     }
-    bool operator==(const distance d) const
+    bool operator==(const distance &d) const
     {
         return get()==d.get();
     }
-    bool operator!=(const distance d) const
+    bool operator!=(const distance &d) const
     {
         return !(*this==d);
     }
-    bool operator<=(const distance d) const
+    bool operator<=(const distance &d) const
     {
         return !(*this>d);
     }
-    bool operator>=(const distance d) const
+    bool operator>=(const distance &d) const
     {
         return !(*this<d);
     }
@@ -97,10 +117,10 @@ public:
         *this += -d;
         return *this;
     }
-    double operator-(const distance d) const;
+    double operator-(const distance &d) const;
 };
-extern distance d_estfront;
-extern distance d_estfront_dir[2];
+extern EVC_STATE distance d_estfront;
+extern EVC_STATE distance d_estfront_dir[2];
 distance d_maxsafefront(int orientation, double reference);
 distance d_minsafefront(int orientation, double reference);
 distance d_maxsafefront(const distance&ref);
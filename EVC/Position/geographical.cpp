@@ -8,8 +8,9 @@
  */
 #include "geographical.h"
 #include <algorithm>
-optional<geographical_position> valid_geo_reference;
-std::list<geographical_position> geo_references;
+#include "../Context/state.h"
+EVC_STATE optional<geographical_position> valid_geo_reference;
+EVC_STATE std::list<geographical_position> geo_references;
 void handle_geographical_position(GeographicalPosition p, bg_id this_bg)
 {
     geo_references.clear();
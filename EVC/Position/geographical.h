@@ -10,7 +10,9 @@
 #include "distance.h"
 #include "linking.h"
 #include "../optional.h"
+#include <list>
 #include "../Packets/79.h"
+#include "../Context/state.h"
 struct geographical_position
 {
     bg_id id;
@@ -29,7 +31,7 @@ struct geographical_position
             return initial_val - travelled;
     }
 };
-extern optional<geographical_position> valid_geo_reference;
+extern EVC_STATE optional<geographical_position> valid_geo_reference;
 void handle_geographical_position(GeographicalPosition p, bg_id this_bg);
 void geographical_position_handle_bg_passed(bg_id id, distance ref, bool reverse);
 void update_geographical_position();
\ No newline at end of file
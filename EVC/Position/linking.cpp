@@ -11,10 +11,12 @@
 #include "../Supervision/national_values.h"
 #include "../Packets/messages.h"
 #include "../TrainSubsystems/cold_movement.h"
-std::list<link_data> linking;
-std::list<link_data>::iterator link_expected = linking.end();
-std::list<lrbg_info> lrbgs;
-bool position_valid=false;
+#include "../Context/state.h"
+#include <cstdio>
+EVC_STATE linking_list linking;
+EVC_STATE linking_list::iterator link_expected = linking.end();
+EVC_STATE lrbg_list lrbgs;
+EVC_STATE bool position_valid=false;
 void load_train_position()
 {
     //TODO: load lrbgs
@@ -51,15 +53,14 @@ distance update_location_reference(bg_id nid_bg, int dir, distance group_pos, bo
         return distance(0, group_pos.get_orientation(), 0);
     }
 }
-void update_linking(distance start, Linking link, bool infill, bg_id this_bg)
+// Linking decoded from the last message, kept so that updates reuse it
+EVC_STATE static std::vector<link_data> new_links;
+void update_linking(distance start, const Linking &link, bool infill, bg_id this_bg)
 {
-    std::vector<LinkingElement> elements;
-    elements.push_back(link.element);
-    elements.insert(elements.end(), link.elements.begin(), link.elements.end());
-    std::list<link_data> links;
+    new_links.clear();
     distance cumdist=start;
     int current_NID_C = this_bg.NID_C;
-    for (LinkingElement l : elements) {
+    auto add_link = [&](const LinkingElement &l) {
         link_data d;
         d.dist = cumdist+l.D_LINK.get_value(link.Q_SCALE);
         d.locacc = l.Q_LOCACC;
@@ -67,53 +68,49 @@ void update_linking(distance start, Linking link, bool infill, bg_id this_bg)
         d.reaction = l.Q_LINKREACTION;
         d.reverse_dir = l.Q_LINKORIENTATION == Q_LINKORIENTATION_t::Reverse;
         current_NID_C = d.nid_bg.NID_C;
-        links.push_back(d);
+        new_links.push_back(d);
         cumdist = d.dist;
-        for (auto &lrbg : lrbgs) {
-            if (lrbg.nid_lrbg == d.nid_bg)
-                lrbg.locacc = d.locacc;
+        for (auto it = lrbgs.find_last(d.nid_bg); it != lrbgs.end(); it = lrbgs.find_previous(it)) {
+            it->locacc = d.locacc;
         }
+    };
+    add_link(link.element);
+    for (const LinkingElement &l : link.elements)
+        add_link(l);
+    // Linking up to here is kept, the rest is replaced by the new one
+    distance keep_until = infill ? start : distance(0, odometer_orientation, 0);
+    size_t count = 0;
+    for (auto it = link_expected; it != linking.end() && !(it->dist > keep_until); ++it)
+        count++;
+    for (auto &l : new_links) {
+        if (infill || l.dist > keep_until)
+            count++;
+    }
+    // A full ring would drop the oldest groups, which may be the expected
+    // one, so the linking already stored is left untouched instead
+    if (count > linking_list::capacity()) {
+        printf("Linking for %zu balise groups exceeds capacity, ignored\n", count);
+        return;
     }
     bool expecting_linking = link_expected != linking.end();
     bg_id expected_bg;
     if (expecting_linking)
         expected_bg = link_expected->nid_bg;
-    if (infill) {
-        linking.erase(linking.begin(), link_expected);
-        for (auto it = linking.begin(); it!=linking.end(); ++it) {
-            if (it->dist > start) {
-                linking.erase(it, linking.end());
-                break;
-            }
-        }
-        linking.insert(linking.end(), links.begin(), links.end());
-    } else {
-        linking.erase(linking.begin(), link_expected);
-        distance d_lrbg = distance(0, odometer_orientation, 0);
-        for (auto it = linking.begin(); it!=linking.end(); ++it) {
-            if (it->dist > d_lrbg) {
-                linking.erase(it, linking.end());
-                break;
-            }
-        }
-        for (auto it = links.begin(); it!=links.end(); ++it) {
-            if (it->dist > d_lrbg) {
-                linking.insert(linking.end(), it, links.end());
-                break;
-            }
+    linking.pop_front(link_expected);
+    for (auto it = linking.begin(); it!=linking.end(); ++it) {
+        if (it->dist > keep_until) {
+            linking.truncate(it);
+            break;
         }
     }
-    bool prev_expected_found = false;
-    if (expecting_linking) {
-        for (auto it = linking.begin(); it!=linking.end(); ++it) {
-            if (it->nid_bg == expected_bg) {
-                link_expected = it;
-                prev_expected_found = true;
-                break;
-            }
-        }
+    for (auto &l : new_links) {
+        if (infill || l.dist > keep_until)
+            linking.push_back(l);
     }
-    if (!prev_expected_found)
+    link_expected = linking.end();
+    if (expecting_linking)
+        link_expected = linking.find_first(expected_bg);
+    if (link_expected == linking.end())
         link_expected = linking.begin();
 }
 void delete_linking()
@@ -123,12 +120,13 @@ void delete_linking()
 }
 void delete_linking(distance d)
 {
-    if (link_expected != linking.end() && link_expected->dist > d)
-        link_expected = linking.end();
     for (auto it = linking.begin(); it != linking.end(); ++it) {
         if (it->dist > d) {
-            linking.erase(it, linking.end());
+            linking.truncate(it);
             break;
         }
     }
+    // Also covers an end() taken before truncation, which is now past it
+    if (!(link_expected < linking.end()))
+        link_expected = linking.end();
 }
\ No newline at end of file
@@ -9,8 +9,9 @@
 #pragma once
 #include "distance.h"
 #include "../Packets/5.h"
-#include <list>
 #include "../optional.h"
+#include "../Context/state.h"
+#include "../Utils/indexed_ring.h"
 struct link_data
 {
     bg_id nid_bg;
@@ -34,10 +35,29 @@ struct lrbg_info
     distance position;
     double locacc;
 };
-extern std::list<link_data> linking;
-extern std::list<lrbg_info> lrbgs;
-extern bool position_valid;
+struct bg_id_hash
+{
+    size_t operator()(const bg_id &id) const { return (size_t)id.NID_C*16384 + id.NID_BG; }
+};
+struct link_key
+{
+    const bg_id &operator()(const link_data &l) const { return l.nid_bg; }
+};
+struct lrbg_key
+{
+    const bg_id &operator()(const lrbg_info &l) const { return l.nid_lrbg; }
+};
+/*
+ * A linking message carries at most 32 balise groups. The groups already
+ * passed are dropped before new linking is added, but infill keeps the
+ * groups before its reference, so room is left for a few messages.
+ */
+typedef indexed_ring<link_data, 128, bg_id, link_key, bg_id_hash> linking_list;
+typedef indexed_ring<lrbg_info, 16, bg_id, lrbg_key, bg_id_hash> lrbg_list;
+extern EVC_STATE linking_list linking;
+extern EVC_STATE lrbg_list lrbgs;
+extern EVC_STATE bool position_valid;
 distance update_location_reference(bg_id nid_bg, int dir, distance group_pos, bool linked, optional<link_data> link);
-void update_linking(distance start, Linking link, bool infill, bg_id this_bg);
+void update_linking(distance start, const Linking &link, bool infill, bg_id this_bg);
 void delete_linking();
 void delete_linking(distance from);
\ No newline at end of file
@@ -0,0 +1,175 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "odometry.h"
+#include "distance.h"
+#include "../Supervision/supervision.h"
+#include "../Time/clock.h"
+#include <algorithm>
+#include <cmath>
+static const int odometry_history = 256;
+// Extrapolation is only trusted for a short while after the last sample
+static const int64_t max_extrapolation = 250000;
+// Window used to estimate the speed measurement accuracy
+static const int64_t accuracy_window = 2000000;
+struct odometry_history_buffer
+{
+    odometry_sample samples[odometry_history];
+    int next = 0;
+    int count = 0;
+    odometry_sample last = {0, 0, 0, 0, false};
+    bool has_distance = false;
+};
+EVC_STATE odometry_history_buffer odometry;
+EVC_STATE void (*odometry_source)() = nullptr;
+static const odometry_sample &sample(int i)
+{
+    // i=0 is the oldest stored sample
+    int index = (odometry.next - odometry.count + i + odometry_history) % odometry_history;
+    return odometry.samples[index];
+}
+static void push_sample(int64_t time, bool timed = false)
+{
+    odometry.last.time = time;
+    odometry.last.timed = timed;
+    if (odometry.count > 0 && sample(odometry.count-1).time == time) {
+        odometry.samples[(odometry.next + odometry_history - 1) % odometry_history] = odometry.last;
+        return;
+    }
+    odometry.samples[odometry.next] = odometry.last;
+    odometry.next = (odometry.next + 1) % odometry_history;
+    if (odometry.count < odometry_history)
+        odometry.count++;
+}
+static void set_distance(double dist)
+{
+    if (odometry.has_distance) {
+        if (odometry.last.distance > dist)
+            odometer_direction = -1;
+        else if (odometry.last.distance < dist)
+            odometer_direction = 1;
+    }
+    odometry.last.distance = dist;
+    odometry.has_distance = true;
+}
+void record_odometer_distance(double dist, int64_t time)
+{
+    set_distance(dist);
+    push_sample(time);
+}
+void record_odometer_speed(double speed, int64_t time)
+{
+    odometry.last.speed = speed;
+    push_sample(time);
+}
+void record_odometer_acceleration(double acceleration, int64_t time)
+{
+    odometry.last.acceleration = acceleration;
+    push_sample(time);
+}
+void record_odometer_sample(double dist, double speed, double acceleration, int64_t time)
+{
+    // Samples are kept in time order
+    bool timed = odometry.count == 0 || time >= sample(odometry.count-1).time;
+    if (!timed)
+        time = std::max(get_microseconds(), sample(odometry.count-1).time);
+    set_distance(dist);
+    odometry.last.speed = speed;
+    odometry.last.acceleration = acceleration;
+    push_sample(time, timed);
+}
+void set_odometry_source(void (*source)())
+{
+    odometry_source = source;
+}
+double odometer_position_at(int64_t time)
+{
+    if (odometry.count == 0 || !odometry.has_distance)
+        return odometer_value;
+    const odometry_sample &newest = sample(odometry.count-1);
+    if (time >= newest.time) {
+        double dt = std::min(time - newest.time, max_extrapolation)/1e6;
+        double v = std::max(newest.speed + newest.acceleration*dt/2, 0.0);
+        return newest.distance + odometer_direction*v*dt;
+    }
+    int lo = 0;
+    int hi = odometry.count-1;
+    if (time <= sample(0).time)
+        return sample(0).distance;
+    while (hi - lo > 1) {
+        int mid = (lo + hi)/2;
+        if (sample(mid).time <= time)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    const odometry_sample &a = sample(lo);
+    const odometry_sample &b = sample(hi);
+    double f = (double)(time - a.time)/(b.time - a.time);
+    return a.distance + (b.distance - a.distance)*f;
+}
+static double speed_accuracy()
+{
+    // Compare the reported speed with the speed implied by consecutive
+    // distance readings. Only samples stamped by their producer count, and
+    // a reading is timed by the first sample that reports it: arrival
+    // times and repeated distances would measure the transport jitter
+    // rather than the odometer.
+    const odometry_sample &newest = sample(odometry.count-1);
+    int first = odometry.count-1;
+    while (first > 0 && newest.time - sample(first-1).time <= accuracy_window)
+        first--;
+    double sum = 0;
+    double sum2 = 0;
+    int n = 0;
+    const odometry_sample *last = nullptr;
+    const odometry_sample *reading = nullptr;
+    for (int i=first; i<odometry.count; i++) {
+        const odometry_sample &b = sample(i);
+        if (!b.timed)
+            continue;
+        bool changed = last != nullptr && b.distance != last->distance;
+        last = &b;
+        if (!changed)
+            continue;
+        const odometry_sample *a = reading;
+        if (a != nullptr && b.time - a->time < 20000)
+            continue;
+        reading = &b;
+        if (a == nullptr)
+            continue;
+        double measured = std::abs(b.distance - a->distance)*1e6/(b.time - a->time);
+        double error = (a->speed + b.speed)/2 - measured;
+        sum += error;
+        sum2 += error*error;
+        n++;
+    }
+    if (n < 4)
+        return -1;
+    double mean = sum/n;
+    return std::abs(mean) + 2*std::sqrt(std::max(sum2/n - mean*mean, 0.0));
+}
+void update_odometry()
+{
+    if (odometry_source != nullptr)
+        odometry_source();
+    if (odometry.count == 0)
+        return;
+    int64_t now = get_microseconds();
+    const odometry_sample &newest = sample(odometry.count-1);
+    if (odometry.has_distance)
+        odometer_value = odometer_position_at(now);
+    double dt = std::min(now - newest.time, max_extrapolation)/1e6;
+    V_est = std::max(newest.speed + (dt > 0 ? newest.acceleration*dt : 0), 0.0);
+    A_est = newest.acceleration;
+    double accuracy = speed_accuracy();
+    // Without enough stamped history, keep the fixed 0.7% figure
+    V_ura = accuracy < 0 ? 0.007*V_est : std::max(accuracy, 0.007*V_est);
+    if (V_est < 0.2)
+        V_est = V_ura = 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <cstdint>
+#include "../Context/state.h"
+/*
+ * Timestamped odometry. Every distance, speed or acceleration input is
+ * stored as a sample with the time it was received, so that the position
+ * can be evaluated at the exact time a telegram arrives or a cycle starts,
+ * instead of at the time of the last input.
+ */
+struct odometry_sample
+{
+    int64_t time;
+    double distance;
+    double speed;
+    double acceleration;
+    // The time was set by the producer of the sample, not on arrival
+    bool timed;
+};
+void record_odometer_distance(double dist, int64_t time);
+void record_odometer_speed(double speed, int64_t time);
+void record_odometer_acceleration(double acceleration, int64_t time);
+/*
+ * All three signals measured together, stamped by their producer on the
+ * clock of get_microseconds(). A sample older than the last one stored is
+ * taken as received now, and then counts as unstamped.
+ */
+void record_odometer_sample(double dist, double speed, double acceleration, int64_t time);
+/*
+ * Called by update_odometry() before evaluating the odometry, so that a
+ * source polled by the EVC hands its samples over as late as possible.
+ */
+void set_odometry_source(void (*source)());
+/*
+ * Odometer reading at the given time. Between samples the position is
+ * interpolated; after the last one it is extrapolated for a short time
+ * with the last speed and acceleration.
+ */
+double odometer_position_at(int64_t time);
+/*
+ * Sets odometer_value, V_est, A_est and V_ura for the current cycle.
+ */
+void update_odometry();
@@ -14,24 +14,25 @@
 #include "../TrainSubsystems/cold_movement.h"
 #include "../STM/stm.h"
 #include "../DMI/track_ahead_free.h"
-optional<level_transition_information> ongoing_transition;
-optional<level_transition_information> sh_transition;
-std::vector<level_information> priority_levels;
-bool priority_levels_valid = false;
-optional<distance> transition_border;
-Level level = Level::Unknown;
-int nid_ntc = -1;
-bool level_valid = false;
-std::list<std::list<std::shared_ptr<etcs_information>>> transition_buffer;
-bool level_acknowledgeable = false;
-bool level_acknowledged = false;
-Level level_to_ack;
-int ntc_to_ack;
-bool level_timer_started = false;
-int64_t level_timer;
-std::map<int, std::string> ntc_names;
-std::set<int> ntc_available_no_stm;
+EVC_STATE optional<level_transition_information> ongoing_transition;
+EVC_STATE optional<level_transition_information> sh_transition;
+EVC_STATE std::vector<level_information> priority_levels;
+EVC_STATE bool priority_levels_valid = false;
+EVC_STATE optional<distance> transition_border;
+EVC_STATE Level level = Level::Unknown;
+EVC_STATE int nid_ntc = -1;
+EVC_STATE bool level_valid = false;
+EVC_STATE std::list<std::list<std::shared_ptr<etcs_information>>> transition_buffer;
+EVC_STATE bool level_acknowledgeable = false;
+EVC_STATE bool level_acknowledged = false;
+EVC_STATE Level level_to_ack;
+EVC_STATE int ntc_to_ack;
+EVC_STATE bool level_timer_started = false;
+EVC_STATE int64_t level_timer;
+EVC_STATE std::map<int, std::string> ntc_names;
+EVC_STATE std::set<int> ntc_available_no_stm;
 #include <fstream>
+#include "../Context/state.h"
 void load_level()
 {
     //std::ifstream file("level.dat");
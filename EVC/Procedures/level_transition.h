@@ -16,12 +16,13 @@
 #include "../optional.h"
 #include <vector>
 #include <list>
+#include "../Context/state.h"
 struct level_information
 {
     Level level;
     int nid_ntc;
 };
-extern std::vector<level_information> priority_levels;
+extern EVC_STATE std::vector<level_information> priority_levels;
 struct target_level_information
 {
     distance startack;
@@ -42,15 +43,15 @@ struct level_transition_information
 void update_level_status();
 void level_transition_received(level_transition_information info);
 void driver_set_level(level_information level);
-extern optional<level_transition_information> ongoing_transition;
-extern optional<level_transition_information> sh_transition;
+extern EVC_STATE optional<level_transition_information> ongoing_transition;
+extern EVC_STATE optional<level_transition_information> sh_transition;
 extern optional<distance> max_ack_distance;
-extern std::vector<level_information> priority_levels;
-extern bool priority_levels_valid;
-extern std::list<std::list<std::shared_ptr<etcs_information>>> transition_buffer;
-extern bool level_acknowledgeable;
-extern bool level_acknowledged;
-extern Level level_to_ack;
-extern int ntc_to_ack;
-extern std::map<int, std::string> ntc_names;
-extern std::set<int> ntc_available_no_stm;
\ No newline at end of file
+extern EVC_STATE std::vector<level_information> priority_levels;
+extern EVC_STATE bool priority_levels_valid;
+extern EVC_STATE std::list<std::list<std::shared_ptr<etcs_information>>> transition_buffer;
+extern EVC_STATE bool level_acknowledgeable;
+extern EVC_STATE bool level_acknowledged;
+extern EVC_STATE Level level_to_ack;
+extern EVC_STATE int ntc_to_ack;
+extern EVC_STATE std::map<int, std::string> ntc_names;
+extern EVC_STATE std::set<int> ntc_available_no_stm;
\ No newline at end of file
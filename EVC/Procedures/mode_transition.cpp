@@ -23,15 +23,16 @@
 #include "../language/language.h"
 #include "../TrainSubsystems/train_interface.h"
 #include <map>
-cond mode_conditions[75];
-static std::vector<mode_transition> ordered_transitions[20];
-Mode mode=Mode::SB;
-int64_t last_mode_change;
-bool mode_acknowledgeable=false;
-bool mode_acknowledged=false;
-Mode mode_to_ack;
-optional<std::set<bg_id>> sh_balises;
-optional<std::set<bg_id>> sr_balises;
+#include "../Context/state.h"
+EVC_STATE cond mode_conditions[75];
+EVC_STATE static std::vector<mode_transition> ordered_transitions[20];
+EVC_STATE Mode mode=Mode::SB;
+EVC_STATE int64_t last_mode_change;
+EVC_STATE bool mode_acknowledgeable=false;
+EVC_STATE bool mode_acknowledged=false;
+EVC_STATE Mode mode_to_ack;
+EVC_STATE optional<std::set<bg_id>> sh_balises;
+EVC_STATE optional<std::set<bg_id>> sr_balises;
 void set_mode_deleted_data();
 void initialize_mode_transitions()
 {
@@ -209,7 +210,7 @@ struct stored_information
     std::function<void()> delete_info;
     std::function<void()> invalidate_info;
 };
-static std::map<int,stored_information> information_list;
+EVC_STATE static std::map<int,stored_information> information_list;
 struct deleted_information
 {
     int index;
@@ -230,8 +231,8 @@ struct deleted_information
         }
     }
 };
-std::map<Mode, std::vector<deleted_information>> deleted_informations;
-bool prev_desk_open;
+EVC_STATE std::map<Mode, std::vector<deleted_information>> deleted_informations;
+EVC_STATE bool prev_desk_open;
 void update_mode_status()
 {
     if (!prev_desk_open && (cab_active[0] ^ cab_active[1])) {
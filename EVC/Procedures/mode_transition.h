@@ -16,10 +16,11 @@
 #include <vector>
 #include <initializer_list>
 #include <cmath>
-extern bool mode_acknowledgeable;
-extern bool mode_acknowledged;
-extern Mode mode_to_ack;
-extern int64_t last_mode_change;
+#include "../Context/state.h"
+extern EVC_STATE bool mode_acknowledgeable;
+extern EVC_STATE bool mode_acknowledged;
+extern EVC_STATE Mode mode_to_ack;
+extern EVC_STATE int64_t last_mode_change;
 class cond
 {
     bool triggered;
@@ -48,7 +49,7 @@ class cond
         triggered = true;
     }
 };
-extern cond mode_conditions[];
+extern EVC_STATE cond mode_conditions[];
 struct mode_transition
 {
     Mode from;
@@ -69,8 +70,8 @@ struct mode_transition
 
     }
 };
-extern optional<std::set<bg_id>> sh_balises;
-extern optional<std::set<bg_id>> sr_balises;
+extern EVC_STATE optional<std::set<bg_id>> sh_balises;
+extern EVC_STATE optional<std::set<bg_id>> sr_balises;
 void initialize_mode_transitions();
 void update_mode_status();
 void trigger_condition(int num);
\ No newline at end of file
@@ -14,11 +14,12 @@
 #include "../Supervision/speed_profile.h"
 #include "../Time/clock.h"
 #include "../DMI/windows.h"
-bool overrideProcedure = false;
-distance override_start_distance;
-int64_t override_start_time;
-optional<distance> formerEoA;
-optional<distance> formerSRdist;
+#include "../Context/state.h"
+EVC_STATE bool overrideProcedure = false;
+EVC_STATE distance override_start_distance;
+EVC_STATE int64_t override_start_time;
+EVC_STATE optional<distance> formerEoA;
+EVC_STATE optional<distance> formerSRdist;
 void start_override()
 {
     if (V_est <= V_NVALLOWOVTRP && (((mode == Mode::FS || mode == Mode::OS || mode == Mode::LS || mode == Mode::SR || mode == Mode::UN || mode == Mode::PT || mode == Mode::SB || mode == Mode::SN) && train_data_valid) || mode == Mode::SH)) {
@@ -52,8 +53,8 @@ void start_override()
         trigger_condition(37);
     }
 }
-bool stopsr_received=false;
-bool stopsh_received=false;
+EVC_STATE bool stopsr_received=false;
+EVC_STATE bool stopsh_received=false;
 void update_override()
 {
     if (overrideProcedure) {
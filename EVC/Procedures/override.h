@@ -9,8 +9,9 @@
 #pragma once
 #include "../optional.h"
 #include "../Position/distance.h"
-extern bool overrideProcedure;
-extern optional<distance> formerEoA;
+#include "../Context/state.h"
+extern EVC_STATE bool overrideProcedure;
+extern EVC_STATE optional<distance> formerEoA;
 void start_override();
 void update_override();
 void override_stopsr();
@@ -16,11 +16,12 @@
 #include "../Packets/radio.h"
 #include "stored_information.h"
 #include "../TrainSubsystems/train_interface.h"
-som_step som_status = S0;
-som_step prev_status = S0;
-bool som_active;
-bool ongoing_mission;
-bool status_changed;
+#include "../Context/state.h"
+EVC_STATE som_step som_status = S0;
+EVC_STATE som_step prev_status = S0;
+EVC_STATE bool som_active;
+EVC_STATE bool ongoing_mission;
+EVC_STATE bool status_changed;
 void update_SoM()
 {
     som_step save_status = som_status;
@@ -38,7 +39,7 @@ void update_SoM()
                 if (mode == Mode::SB && (cab_active[0]^cab_active[1]) && (!supervising_rbc || (supervising_rbc->status != session_status::Establishing && supervising_rbc->status != session_status::Established)))
                     som_status = S1;
                 active_dialog = dialog_sequence::StartUp;
-                active_dialog_step = "S0";
+                active_dialog_step = dialog_step::S0;
             }
             break;
         case S1:
@@ -10,6 +10,7 @@
 #include "../Supervision/train_data.h"
 #include "mode_transition.h"
 #include "../Packets/radio.h"
+#include "../Context/state.h"
 enum som_step
 {
     S0,
@@ -49,8 +50,8 @@ enum som_step
     A39,
     A40
 };
-extern som_step som_status;
-extern bool som_active;
-extern bool ongoing_mission;
+extern EVC_STATE som_step som_status;
+extern EVC_STATE bool som_active;
+extern EVC_STATE bool ongoing_mission;
 void update_SoM();
 void start_pressed();
\ No newline at end of file
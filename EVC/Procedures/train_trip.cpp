@@ -12,8 +12,9 @@
 #include "../STM/stm.h"
 #include "../language/language.h"
 #include <string>
-bool trip_acknowledged = false;
-bool trip_exit_acknowledged = false;
+#include "../Context/state.h"
+EVC_STATE bool trip_acknowledged = false;
+EVC_STATE bool trip_exit_acknowledged = false;
 void train_trip(int reason)
 {
     std::string str;
@@ -8,6 +8,7 @@
  */
 #pragma once
 #include "../DMI/text_message.h"
-extern bool trip_exit_acknowledged;
+#include "../Context/state.h"
+extern EVC_STATE bool trip_exit_acknowledged;
 void train_trip(int reason);
 void update_trip();
\ No newline at end of file
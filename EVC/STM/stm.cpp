@@ -7,6 +7,7 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 #include "stm.h"
+#include "stm_bus.h"
 #include "../Supervision/speed_profile.h"
 #include "../Procedures/override.h"
 #include "../Packets/messages.h"
@@ -31,11 +32,12 @@
 #include "../DMI/windows.h"
 #include "../TrainSubsystems/train_interface.h"
 #include <orts/client.h>
-std::map<int, stm_object*> installed_stms;
-std::map<int, int> ntc_to_stm;
-std::map<int, std::vector<stm_object*>> ntc_to_stm_lookup_table;
-bool stm_control_EB = false;
-bool ntc_unavailable_msg = false;
+#include "../Context/state.h"
+EVC_STATE std::map<int, stm_object*> installed_stms;
+EVC_STATE std::map<int, int> ntc_to_stm;
+EVC_STATE std::map<int, std::vector<stm_object*>> ntc_to_stm_lookup_table;
+EVC_STATE bool stm_control_EB = false;
+EVC_STATE bool ntc_unavailable_msg = false;
 extern ORserver::POSIXclient *s_client;
 struct stm_transition
 {
@@ -56,7 +58,7 @@ struct stm_transition
 
     }
 };
-static std::map<int, std::vector<stm_transition>> ordered_transitions;
+EVC_STATE static std::map<int, std::vector<stm_transition>> ordered_transitions;
 void stm_object::trigger_condition(std::string change) {
     auto &available = ordered_transitions[(int)state];
     for (auto &t : available) {
@@ -374,10 +376,12 @@ void stm_object::report_received(stm_state newstate)
 }
 void stm_object::send_message(stm_message *msg)
 {
+    if (s_client == nullptr)
+        return;
     msg->NID_STM.rawdata = nid_stm;
     bit_manipulator w;
     msg->write_to(w);
-    s_client->WriteLine("noretain(stm::command_etcs="+w.to_base64()+")");
+    stm_bus_send(nid_stm, w.to_base64());
 }
 void send_failed_msg(stm_object *stm)
 {
@@ -432,8 +436,25 @@ std::string get_ntc_name(int nid_ntc)
         return it->second;
     return "NTC "+std::to_string(nid_ntc);
 }
-static Mode prev_mode;
-static bool prev_override;
+EVC_STATE static Mode prev_mode;
+EVC_STATE static bool prev_override;
+/*
+ * Messages sent by update_stm_control carry a single packet. They are
+ * built once and refilled before each send.
+ */
+template<typename T>
+struct single_packet_message
+{
+    stm_message msg;
+    std::shared_ptr<T> packet = std::make_shared<T>();
+    single_packet_message()
+    {
+        msg.packets.push_back(packet);
+    }
+};
+EVC_STATE static single_packet_message<ETCSStatusData> status_message;
+EVC_STATE static single_packet_message<STMOverrideStatus> override_message;
+EVC_STATE static single_packet_message<STMDataEntryFlag> data_entry_flag_message;
 void update_stm_control()
 {
     if (level != Level::NTC)
@@ -441,25 +462,19 @@ void update_stm_control()
     if (mode != prev_mode) {
         if(mode == Mode::NP/* || mode == Mode::SB*/)
             ntc_to_stm.clear();
-        stm_message msg;
-        auto *stat = new ETCSStatusData();
-        stat->M_LEVEL.set_value(level);
-        stat->NID_NTC.rawdata = nid_ntc;
-        stat->M_MODESTM.set_value(mode);
-        msg.packets.push_back(std::shared_ptr<ETCS_packet>(stat));
+        auto &stat = *status_message.packet;
+        stat.M_LEVEL.set_value(level);
+        stat.NID_NTC.rawdata = nid_ntc;
+        stat.M_MODESTM.set_value(mode);
         for (auto kvp : installed_stms) {
-            kvp.second->send_message(&msg);
+            kvp.second->send_message(&status_message.msg);
         }
     }
     prev_mode = mode;
     if (prev_override != overrideProcedure) {
+        override_message.packet->Q_OVR_STATUS.rawdata = overrideProcedure;
         for (auto kvp : installed_stms) {
-            auto *stm = kvp.second;
-            stm_message msg;
-            auto *ov = new STMOverrideStatus();
-            ov->Q_OVR_STATUS.rawdata = overrideProcedure;
-			msg.packets.push_back(std::shared_ptr<ETCS_packet>(ov));
-			stm->send_message(&msg);
+            kvp.second->send_message(&override_message.msg);
         }
     }
     prev_override = overrideProcedure;
@@ -473,11 +488,8 @@ void update_stm_control()
 			if (entry_timer)
 				stm->trigger_condition("O16");
 			stm->data_entry = stm_object::data_entry_state::Inactive;
-			stm_message msg;
-			auto *flag = new STMDataEntryFlag();
-			msg.packets.push_back(std::shared_ptr<ETCS_packet>(flag));
-			flag->M_DATAENTRYFLAG.rawdata = M_DATAENTRYFLAG_t::Stop;
-			stm->send_message(&msg);
+			data_entry_flag_message.packet->M_DATAENTRYFLAG.rawdata = M_DATAENTRYFLAG_t::Stop;
+			stm->send_message(&data_entry_flag_message.msg);
 		}
 	}
 
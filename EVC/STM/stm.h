@@ -118,7 +118,7 @@ void handle_stm_message(const stm_message &msg);
 void stm_send_train_data();
 stm_object *get_stm(int nid_ntc);
 std::string get_ntc_name(int nid_ntc);
-extern std::map<int, stm_object*> installed_stms;
-extern std::map<int, int> ntc_to_stm;
-extern std::map<int, std::vector<stm_object*>> ntc_to_stm_lookup_table;
-extern bool stm_control_EB;
\ No newline at end of file
+extern EVC_STATE std::map<int, stm_object*> installed_stms;
+extern EVC_STATE std::map<int, int> ntc_to_stm;
+extern EVC_STATE std::map<int, std::vector<stm_object*>> ntc_to_stm_lookup_table;
+extern EVC_STATE bool stm_control_EB;
\ No newline at end of file
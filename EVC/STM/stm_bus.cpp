@@ -0,0 +1,119 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "stm_bus.h"
+#include "stm.h"
+#include "../Packets/io/base64.h"
+#include "../Packets/STM/message.h"
+#include "../DMI/dmi.h"
+#include "../Time/clock.h"
+#include <orts/client.h>
+#include <nlohmann/json.hpp>
+#include <vector>
+extern ORserver::POSIXclient *s_client;
+EVC_STATE std::map<int, stm_channel> stm_channels;
+void stm_bus_receive(const std::string &frame)
+{
+    // NID_STM is the first byte, in the first four base64 characters
+    std::string header = base64_decode(frame.substr(0, 4));
+    if (header.empty())
+        return;
+    stm_channel &channel = stm_channels[(unsigned char)header[0]];
+    channel.inbound.push_back({frame, get_microseconds()});
+    channel.counters.received++;
+    if (channel.inbound.size() > channel.counters.max_inbound_depth)
+        channel.counters.max_inbound_depth = channel.inbound.size();
+}
+void stm_bus_send(int nid_stm, const std::string &frame)
+{
+    if (s_client == nullptr)
+        return;
+    stm_channel &channel = stm_channels[nid_stm];
+    channel.outbound.push_back({frame, get_microseconds()});
+    if (channel.outbound.size() > channel.counters.max_outbound_depth)
+        channel.counters.max_outbound_depth = channel.outbound.size();
+}
+static bool is_priority_message(const stm_message &msg)
+{
+    for (auto &pack : msg.packets) {
+        int nid_packet = (unsigned char)pack->NID_PACKET.rawdata;
+        if (nid_packet == 128 || nid_packet == 129 || nid_packet == 130)
+            return true;
+    }
+    return false;
+}
+static void handle_frame(stm_channel &channel, const stm_frame &frame, const stm_message &msg, int64_t now)
+{
+    handle_stm_message(msg);
+    channel.counters.last_latency = now - frame.time;
+    if (channel.counters.last_latency > channel.counters.max_latency)
+        channel.counters.max_latency = channel.counters.last_latency;
+}
+void process_stm_bus_input()
+{
+    struct pending_frame
+    {
+        stm_channel *channel;
+        stm_frame frame;
+        stm_message msg;
+        bool handled;
+    };
+    std::vector<pending_frame> pending;
+    int64_t now = get_microseconds();
+    for (auto &kvp : stm_channels) {
+        stm_channel &channel = kvp.second;
+        while (!channel.inbound.empty()) {
+            stm_frame frame = std::move(channel.inbound.front());
+            channel.inbound.pop_front();
+            bit_manipulator r(frame.data);
+            stm_message msg(r);
+            if (is_priority_message(msg)) {
+                channel.counters.received_priority++;
+                handle_frame(channel, frame, msg, now);
+                pending.push_back({&channel, std::move(frame), stm_message(), true});
+            } else {
+                pending.push_back({&channel, std::move(frame), std::move(msg), false});
+            }
+        }
+    }
+    for (auto &p : pending) {
+        if (!p.handled)
+            handle_frame(*p.channel, p.frame, p.msg, now);
+    }
+    for (auto &p : pending) {
+        send_command("stmData", p.frame.data);
+    }
+}
+void flush_stm_bus_output()
+{
+    for (auto &kvp : stm_channels) {
+        stm_channel &channel = kvp.second;
+        while (!channel.outbound.empty()) {
+            if (s_client != nullptr)
+                s_client->WriteLine("noretain(stm::command_etcs="+channel.outbound.front().data+")");
+            channel.outbound.pop_front();
+            channel.counters.sent++;
+        }
+    }
+}
+std::string stm_bus_statistics()
+{
+    nlohmann::json j = nlohmann::json::object();
+    for (auto &kvp : stm_channels) {
+        const stm_bus_counters &c = kvp.second.counters;
+        nlohmann::json &cj = j[std::to_string(kvp.first)];
+        cj["Received"] = c.received;
+        cj["ReceivedPriority"] = c.received_priority;
+        cj["Sent"] = c.sent;
+        cj["MaxInboundDepth"] = c.max_inbound_depth;
+        cj["MaxOutboundDepth"] = c.max_outbound_depth;
+        cj["LastLatency"] = c.last_latency;
+        cj["MaxLatency"] = c.max_latency;
+    }
+    return j.dump();
+}
@@ -0,0 +1,56 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <deque>
+#include <map>
+#include <string>
+#include <cstdint>
+#include "../Context/state.h"
+/*
+ * STM frames, base64 encoded as carried by the simulator, and the time
+ * in microseconds when they were queued.
+ */
+struct stm_frame
+{
+    std::string data;
+    int64_t time;
+};
+struct stm_bus_counters
+{
+    uint64_t received = 0;
+    uint64_t received_priority = 0;
+    uint64_t sent = 0;
+    size_t max_inbound_depth = 0;
+    size_t max_outbound_depth = 0;
+    int64_t last_latency = 0;
+    int64_t max_latency = 0;
+};
+struct stm_channel
+{
+    std::deque<stm_frame> inbound;
+    std::deque<stm_frame> outbound;
+    stm_bus_counters counters;
+};
+/*
+ * Frames are only queued when received or sent. Inbound frames are
+ * handled at the start of the cycle, those carrying brake or train
+ * commands (packets 128, 129 and 130) before any other, and then
+ * forwarded to the DMI unchanged. Outbound frames are written at the end
+ * of the cycle.
+ */
+extern EVC_STATE std::map<int, stm_channel> stm_channels;
+void stm_bus_receive(const std::string &frame);
+void stm_bus_send(int nid_stm, const std::string &frame);
+void process_stm_bus_input();
+void flush_stm_bus_output();
+/*
+ * Counters of every channel as JSON, keyed by NID_STM. Latencies are in
+ * microseconds.
+ */
+std::string stm_bus_statistics();
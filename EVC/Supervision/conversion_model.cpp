@@ -16,7 +16,8 @@
 #include <map>
 #include <utility>
 #include <cmath>
-acceleration get_A_gradient(std::map<distance, double> gradient, double default_gradient)
+#include "../Context/state.h"
+acceleration get_A_gradient(const gradient_profile &gradient, double default_gradient)
 {
     acceleration A_gradient;
     A_gradient.dist_step.insert(distance(std::numeric_limits<double>::lowest(), 0, 0));
@@ -44,21 +45,21 @@ acceleration get_A_gradient(std::map<distance, double> gradient, double default_
     }
     return A_gradient;
 }
-double T_brake_emergency_cm0;
-double T_brake_emergency_cmt;
-double T_brake_service_cm0;
-double T_brake_service_cmt;
-acceleration A_brake_emergency;
-acceleration A_brake_service;
-std::map<distance,std::pair<int,int>> active_combination;
-bool slippery_rail_driver;
-std::map<int,std::map<double, double>> A_brake_emergency_combination;
-std::map<int,std::map<double, double>> A_brake_service_combination;
-std::map<int,std::map<double,std::map<double, double>>> A_brake_normal_service_combination;
-std::map<int,std::map<double,std::map<double,double>>> Kdry_rst_combination;
-std::map<int,std::map<double, double>> Kwet_rst_combination;
-std::map<int,double> T_brake_service_combination;
-std::map<int,double> T_brake_emergency_combination;
+EVC_STATE double T_brake_emergency_cm0;
+EVC_STATE double T_brake_emergency_cmt;
+EVC_STATE double T_brake_service_cm0;
+EVC_STATE double T_brake_service_cmt;
+EVC_STATE acceleration A_brake_emergency;
+EVC_STATE acceleration A_brake_service;
+EVC_STATE std::map<distance,std::pair<int,int>> active_combination;
+EVC_STATE bool slippery_rail_driver;
+EVC_STATE std::map<int,std::map<double, double>> A_brake_emergency_combination;
+EVC_STATE std::map<int,std::map<double, double>> A_brake_service_combination;
+EVC_STATE std::map<int,std::map<double,std::map<double, double>>> A_brake_normal_service_combination;
+EVC_STATE std::map<int,std::map<double,std::map<double,double>>> Kdry_rst_combination;
+EVC_STATE std::map<int,std::map<double, double>> Kwet_rst_combination;
+EVC_STATE std::map<int,double> T_brake_service_combination;
+EVC_STATE std::map<int,double> T_brake_emergency_combination;
 void reset()
 {
     A_brake_emergency_combination.clear();
@@ -143,7 +144,7 @@ double Kwet_rst(double V, distance d)
 {
     return (--Kwet_rst_combination[(--active_combination.upper_bound(d))->second.second].upper_bound(V))->second;
 }
-std::map<double,double> Kn[2];
+EVC_STATE std::map<double,double> Kn[2];
 void set_brake_model(json &traindata)
 {
     reset();
@@ -243,9 +244,9 @@ void set_brake_model(json &traindata)
     }
     update_brake_contributions();
 }
-std::map<double, double> Kv_int;
-std::map<double, double> Kr_int;
-double Kt_int;
+EVC_STATE std::map<double, double> Kv_int;
+EVC_STATE std::map<double, double> Kr_int;
+EVC_STATE double Kt_int;
 acceleration conversion_acceleration(double lambda_0)
 {
     double l1 = lambda_0;
@@ -360,7 +361,7 @@ void set_conversion_correction_values()
     Kr_int = NV_KRINT;
     Kt_int = M_NVKTINT;
 }
-bool conversion_model_used = false;
+EVC_STATE bool conversion_model_used = false;
 void set_conversion_model()
 {
     if (brake_percentage >= 30 && brake_percentage <= 250 && V_train <= 200/3.6 && L_TRAIN < (brake_position == PassengerP ? 900 : 1500)) {
@@ -9,7 +9,9 @@
 #pragma once
 #include <map>
 #include "acceleration.h"
+#include "../Utils/position_ring.h"
 #include <nlohmann/json.hpp>
+#include "../Context/state.h"
 #define REGENERATIVE_AVAILABLE 0
 #define EDDY_AVAILABLE 1
 #define EP_AVAILABLE 2
@@ -17,22 +19,26 @@
 using json = nlohmann::json;
 void set_brake_model(json &traindata);
 void set_conversion_model();
-acceleration get_A_gradient(std::map<distance, double> gradient, double default_gradient);
-extern double T_brake_emergency_cm0;
-extern double T_brake_emergency_cmt;
-extern double T_brake_service_cm0;
-extern double T_brake_service_cmt;
+/*
+ * Gradient values, in per unit, indexed by the location where they start.
+ */
+typedef position_ring<std::pair<distance,double>, position_key_less> gradient_profile;
+acceleration get_A_gradient(const gradient_profile &gradient, double default_gradient);
+extern EVC_STATE double T_brake_emergency_cm0;
+extern EVC_STATE double T_brake_emergency_cmt;
+extern EVC_STATE double T_brake_service_cm0;
+extern EVC_STATE double T_brake_service_cmt;
 double get_T_brake_emergency(distance d);
 double get_T_brake_service(distance d);
 acceleration get_A_brake_emergency(bool use_active_combination=true);
 acceleration get_A_brake_service(bool use_active_combination=true);
 acceleration get_A_brake_normal_service(acceleration A_brake_service);
-extern double Kt_int;
-extern std::map<double, double> Kv_int;
-extern std::map<double, double> Kr_int;
-extern std::map<double,double> Kn[2];
-extern bool conversion_model_used;
+extern EVC_STATE double Kt_int;
+extern EVC_STATE std::map<double, double> Kv_int;
+extern EVC_STATE std::map<double, double> Kr_int;
+extern EVC_STATE std::map<double,double> Kn[2];
+extern EVC_STATE bool conversion_model_used;
 double Kdry_rst(double V, double EBCL, distance d);
 double Kwet_rst(double V, distance d);
-extern std::map<distance,std::pair<int,int>> active_combination;
-extern bool slippery_rail_driver;
\ No newline at end of file
+extern EVC_STATE std::map<distance,std::pair<int,int>> active_combination;
+extern EVC_STATE bool slippery_rail_driver;
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <chrono>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include "curve_calc.h"
 #include "conversion_model.h"
 distance distance_curve(const acceleration &a, const distance &dref, double vref, double vel)
 {
@@ -108,3 +110,150 @@ double speed_curve(const acceleration &a, const distance &dref, double vref, dis
     }
     return sqrt(v02);
 }
+braking_curve::braking_curve(const acceleration &a, const distance &dref, double vref) : vref(vref)
+{
+    if (a.speed_step.empty() || vref<*a.speed_step.begin() || a.dist_step.empty() || dref<*a.dist_step.begin())
+        return;
+    // Same walk as speed_curve towards decreasing distances, recording
+    // every change of deceleration instead of stopping at a given point
+    auto v = --a.speed_step.upper_bound(vref);
+    auto d = --a.dist_step.upper_bound(dref);
+    auto vnext = next(v);
+    double pos = 0;
+    double v02 = vref*vref;
+    for (;;) {
+        double A = a(*v,*d);
+        offset.push_back(pos);
+        v2.push_back(v02);
+        dec.push_back(A);
+        if (A <= 0)
+            monotonic = false;
+        bool vend = vnext == a.speed_step.end();
+        bool dend = d->get() <= std::numeric_limits<double>::lowest() || d->get() >= std::numeric_limits<double>::max();
+        double vv2 = vend ? 1e9 : (*vnext)*(*vnext);
+        double dstep = dend ? 0 : dref-*d;
+        double vd2 = dend ? 1e9 : 2*A*(dstep-pos)+v02;
+        if (vv2 >= 1e9 && vd2 >= 1e9)
+            break;
+        if (vv2<vd2) {
+            if (A <= 0)
+                break;
+            pos += (vv2-v02)/(2*A);
+            v02 = vv2;
+            v++;
+            vnext++;
+        } else {
+            v02 = vd2;
+            pos = dstep;
+            if (d == a.dist_step.begin())
+                break;
+            d--;
+        }
+    }
+    // Walk past dref towards increasing distances until the speed reaches
+    // zero, as speed_curve does for points beyond the reference. These
+    // segments get negative offsets and are placed before the others.
+    std::vector<double> foffset, fv2, fdec;
+    v = --a.speed_step.upper_bound(vref);
+    d = --a.dist_step.upper_bound(dref);
+    auto dnext = next(d);
+    pos = 0;
+    v02 = vref*vref;
+    while (v02 > 0) {
+        double A = a(*v,*d);
+        if (A <= 0)
+            break;
+        bool dend = dnext == a.dist_step.end() || dnext->get() >= std::numeric_limits<double>::max();
+        double vv2 = (*v)*(*v);
+        double dstep = dend ? 0 : dref-*dnext;
+        double vd2 = dend ? -1 : 2*A*(dstep-pos)+v02;
+        if (vv2 >= vd2) {
+            pos += (vv2-v02)/(2*A);
+            v02 = vv2;
+        } else {
+            pos = dstep;
+            v02 = vd2;
+        }
+        foffset.push_back(pos);
+        fv2.push_back(v02);
+        fdec.push_back(A);
+        if (vv2 >= vd2) {
+            if (v == a.speed_step.begin())
+                break;
+            v--;
+        } else {
+            d++;
+            dnext++;
+        }
+    }
+    offset.insert(offset.begin(), foffset.rbegin(), foffset.rend());
+    v2.insert(v2.begin(), fv2.rbegin(), fv2.rend());
+    dec.insert(dec.begin(), fdec.rbegin(), fdec.rend());
+}
+int braking_curve::segment(double off, int hint) const
+{
+    int n = offset.size();
+    if (hint < 0 || hint >= n || off < offset[hint])
+        return std::max((int)(std::upper_bound(offset.begin(), offset.end(), off) - offset.begin()) - 1, 0);
+    while (hint+1 < n && offset[hint+1] <= off)
+        hint++;
+    return hint;
+}
+double braking_curve::speed(double off) const
+{
+    if (!valid())
+        return 0;
+    int i = segment(off);
+    return std::sqrt(std::max(v2[i]+2*dec[i]*(off-offset[i]), 0.0));
+}
+double braking_curve::offset_at(double vel) const
+{
+    if (!valid())
+        return std::numeric_limits<double>::lowest();
+    double vel2 = vel*vel;
+    int n = v2.size();
+    int i;
+    if (monotonic) {
+        i = std::max((int)(std::upper_bound(v2.begin(), v2.end(), vel2) - v2.begin()) - 1, 0);
+    } else {
+        for (i=0; i+1<n && v2[i+1] <= vel2; i++);
+    }
+    if (dec[i] <= 0)
+        return i+1<n ? offset[i+1] : std::numeric_limits<double>::max();
+    return offset[i] + (vel2-v2[i])/(2*dec[i]);
+}
+void speed_curve(const braking_curve &c, const double *offsets, double *speeds, int n)
+{
+    if (!c.valid()) {
+        std::fill(speeds, speeds+n, 0.0);
+        return;
+    }
+    // Segment lookup is done first, so that the evaluation loop works on
+    // contiguous arrays without branches. This file is built without
+    // errno for math functions, which lets the compiler vectorize sqrt
+    const int chunk = 64;
+    double o[chunk];
+    double b[chunk];
+    double s[chunk];
+    int seg = 0;
+    for (int start=0; start<n; start+=chunk) {
+        int m = std::min(chunk, n-start);
+        for (int i=0; i<m; i++) {
+            seg = c.segment(offsets[start+i], seg);
+            o[i] = c.offset[seg];
+            b[i] = c.v2[seg];
+            s[i] = 2*c.dec[seg];
+        }
+        const double *off = offsets+start;
+        double *out = speeds+start;
+        for (int i=0; i<m; i++) {
+            double x = b[i]+s[i]*(off[i]-o[i]);
+            out[i] = std::sqrt(x > 0 ? x : 0.0);
+        }
+    }
+}
+void distance_curve(const braking_curve &c, const double *speeds, double *offsets, int n)
+{
+    for (int i=0; i<n; i++)
+        offsets[i] = c.offset_at(speeds[i]);
+}
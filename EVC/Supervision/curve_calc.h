@@ -7,6 +7,34 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 #pragma once
+#include <vector>
 #include "../Position/distance.h"
+#include "acceleration.h"
 distance distance_curve(const acceleration &a, const distance &dref, double vref, double vel);
 double speed_curve(const acceleration &a, const distance &dref, double vref, distance dist);
+/*
+ * Braking curve through (dref, vref), flattened into segments of constant
+ * deceleration. Offsets are measured backwards from dref; negative ones
+ * lie beyond dref and are covered until the speed reaches zero.
+ * Once built, evaluating the curve needs no walk over the acceleration
+ * steps, which makes it suitable for searches and batch evaluation.
+ */
+struct braking_curve
+{
+    double vref;
+    std::vector<double> offset;
+    std::vector<double> v2;
+    std::vector<double> dec;
+    bool monotonic = true;
+    braking_curve(const acceleration &a, const distance &dref, double vref);
+    bool valid() const { return !offset.empty(); }
+    int segment(double off, int hint=0) const;
+    double speed(double off) const;
+    double offset_at(double vel) const;
+};
+/*
+ * Batch versions of speed_curve and distance_curve. Queries sorted in
+ * ascending order are resolved with a single pass over the segments.
+ */
+void speed_curve(const braking_curve &c, const double *offsets, double *speeds, int n);
+void distance_curve(const braking_curve &c, const double *speeds, double *offsets, int n);
@@ -9,7 +9,8 @@
 #include "../Procedures/mode_transition.h"
 #include "../Procedures/stored_information.h"
 #include "../MA/movement_authority.h"
-std::map<int, optional<distance>> emergency_stops;
+#include "../Context/state.h"
+EVC_STATE std::map<int, optional<distance>> emergency_stops;
 void handle_unconditional_emergency_stop(int id)
 {
     trigger_condition(20);
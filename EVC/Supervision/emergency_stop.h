@@ -10,7 +10,8 @@
 #include "../Position/distance.h"
 #include "../optional.h"
 #include <map>
-extern std::map<int, optional<distance>> emergency_stops;
+#include "../Context/state.h"
+extern EVC_STATE std::map<int, optional<distance>> emergency_stops;
 void handle_unconditional_emergency_stop(int id);
 int handle_conditional_emergency_stop(int id, distance location);
 void revoke_emergency_stop(int id);
\ No newline at end of file
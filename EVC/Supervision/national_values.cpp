@@ -12,55 +12,56 @@
 #define TO_MPS(kph) kph/3.6
 #include <limits>
 #include <fstream>
-bool Q_NVDRIVER_ADHES;
+#include "../Context/state.h"
+EVC_STATE bool Q_NVDRIVER_ADHES;
 
-double V_NVSHUNT;
-double V_NVSTFF;
-double V_NVONSIGHT;
-double V_NVLIMSUPERV;
-double V_NVUNFIT;
-double V_NVREL;
+EVC_STATE double V_NVSHUNT;
+EVC_STATE double V_NVSTFF;
+EVC_STATE double V_NVONSIGHT;
+EVC_STATE double V_NVLIMSUPERV;
+EVC_STATE double V_NVUNFIT;
+EVC_STATE double V_NVREL;
 
-double D_NVROLL;
+EVC_STATE double D_NVROLL;
 
-bool Q_NVSBTSMPERM;
-bool Q_NVEMRRLS;
-bool Q_NVGUIPERM;
-bool Q_NVSBFBPERM;
-bool Q_NVINHSMICPERM;
+EVC_STATE bool Q_NVSBTSMPERM;
+EVC_STATE bool Q_NVEMRRLS;
+EVC_STATE bool Q_NVGUIPERM;
+EVC_STATE bool Q_NVSBFBPERM;
+EVC_STATE bool Q_NVINHSMICPERM;
 
-double V_NVALLOWOVTRP;
-double V_NVSUPOVTRP;
+EVC_STATE double V_NVALLOWOVTRP;
+EVC_STATE double V_NVSUPOVTRP;
 
-double D_NVOVTRP;
+EVC_STATE double D_NVOVTRP;
 
-double T_NVOVTRP;
+EVC_STATE double T_NVOVTRP;
 
-int M_NVDERUN;
-int M_NVCONTACT;
+EVC_STATE int M_NVDERUN;
+EVC_STATE int M_NVCONTACT;
 
-double T_NVCONTACT;
+EVC_STATE double T_NVCONTACT;
 
-double D_NVPOTRP;
+EVC_STATE double D_NVPOTRP;
 
-double D_NVSTFF;
+EVC_STATE double D_NVSTFF;
 
-double Q_NVLOCACC;
+EVC_STATE double Q_NVLOCACC;
 
-int M_NVAVADH;
+EVC_STATE int M_NVAVADH;
 
-double M_NVEBCL;
+EVC_STATE double M_NVEBCL;
 
-std::map<double,double> NV_KRINT;
-std::map<double,double> NV_KVINT_freight;
-std::map<double,kvint_pass_step> NV_KVINT_pass;
-double M_NVKTINT;
+EVC_STATE std::map<double,double> NV_KRINT;
+EVC_STATE std::map<double,double> NV_KVINT_freight;
+EVC_STATE std::map<double,kvint_pass_step> NV_KVINT_pass;
+EVC_STATE double M_NVKTINT;
 
-double A_NVMAXREDADH1;
-double A_NVMAXREDADH2;
-double A_NVMAXREDADH3;
+EVC_STATE double A_NVMAXREDADH1;
+EVC_STATE double A_NVMAXREDADH2;
+EVC_STATE double A_NVMAXREDADH3;
 
-std::set<int> NV_NID_Cs;
+EVC_STATE std::set<int> NV_NID_Cs;
 void nv_changed()
 {
     /*set_conversion_correction_values();
@@ -212,7 +213,7 @@ struct StoredNationalValueSet
     distance first_applicable;
     NationalValues nv;
 };
-optional<StoredNationalValueSet> not_yet_applicable_nv;
+EVC_STATE optional<StoredNationalValueSet> not_yet_applicable_nv;
 void national_values_received(NationalValues nv, distance reference)
 {
     not_yet_applicable_nv = {};
@@ -11,44 +11,45 @@
 #include <map>
 #include "../Packets/3.h"
 #include "../Position/distance.h"
-extern bool Q_NVDRIVER_ADHES;
+#include "../Context/state.h"
+extern EVC_STATE bool Q_NVDRIVER_ADHES;
 
-extern double V_NVSHUNT;
-extern double V_NVSTFF;
-extern double V_NVONSIGHT;
-extern double V_NVLIMSUPERV;
-extern double V_NVUNFIT;
-extern double V_NVREL;
+extern EVC_STATE double V_NVSHUNT;
+extern EVC_STATE double V_NVSTFF;
+extern EVC_STATE double V_NVONSIGHT;
+extern EVC_STATE double V_NVLIMSUPERV;
+extern EVC_STATE double V_NVUNFIT;
+extern EVC_STATE double V_NVREL;
 
-extern double D_NVROLL;
+extern EVC_STATE double D_NVROLL;
 
-extern bool Q_NVSBTSMPERM;
-extern bool Q_NVEMRRLS;
-extern bool Q_NVGUIPERM;
-extern bool Q_NVSBFBPERM;
-extern bool Q_NVINHSMICPERM;
+extern EVC_STATE bool Q_NVSBTSMPERM;
+extern EVC_STATE bool Q_NVEMRRLS;
+extern EVC_STATE bool Q_NVGUIPERM;
+extern EVC_STATE bool Q_NVSBFBPERM;
+extern EVC_STATE bool Q_NVINHSMICPERM;
 
-extern double V_NVALLOWOVTRP;
-extern double V_NVSUPOVTRP;
+extern EVC_STATE double V_NVALLOWOVTRP;
+extern EVC_STATE double V_NVSUPOVTRP;
 
-extern double D_NVOVTRP;
+extern EVC_STATE double D_NVOVTRP;
 
-extern double T_NVOVTRP;
+extern EVC_STATE double T_NVOVTRP;
 
-extern int M_NVDERUN;
-extern int M_NVCONTACT;
+extern EVC_STATE int M_NVDERUN;
+extern EVC_STATE int M_NVCONTACT;
 
-extern double T_NVCONTACT;
+extern EVC_STATE double T_NVCONTACT;
 
-extern double D_NVPOTRP;
+extern EVC_STATE double D_NVPOTRP;
 
-extern double D_NVSTFF;
+extern EVC_STATE double D_NVSTFF;
 
-extern double Q_NVLOCACC;
+extern EVC_STATE double Q_NVLOCACC;
 
-extern int M_NVAVADH;
+extern EVC_STATE int M_NVAVADH;
 
-extern double M_NVEBCL;
+extern EVC_STATE double M_NVEBCL;
 
 struct kvint_pass_step
 {
@@ -57,16 +58,16 @@ struct kvint_pass_step
     double A_NVP12;
     double A_NVP23;
 };
-extern std::map<double,double> NV_KRINT;
-extern std::map<double,double> NV_KVINT_freight;
-extern std::map<double,kvint_pass_step> NV_KVINT_pass;
-extern double M_NVKTINT;
+extern EVC_STATE std::map<double,double> NV_KRINT;
+extern EVC_STATE std::map<double,double> NV_KVINT_freight;
+extern EVC_STATE std::map<double,kvint_pass_step> NV_KVINT_pass;
+extern EVC_STATE double M_NVKTINT;
 
-extern double A_NVMAXREDADH1;
-extern double A_NVMAXREDADH2;
-extern double A_NVMAXREDADH3;
+extern EVC_STATE double A_NVMAXREDADH1;
+extern EVC_STATE double A_NVMAXREDADH2;
+extern EVC_STATE double A_NVMAXREDADH3;
 
-extern std::set<int> NV_NID_Cs; 
+extern EVC_STATE std::set<int> NV_NID_Cs; 
 
 void setup_national_values();
 void national_values_received(NationalValues nv, distance reference);
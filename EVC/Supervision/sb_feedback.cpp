@@ -8,7 +8,8 @@
  */
 #include "sb_feedback.h"
 #include "targets.h"
-extern target MRDT;
+#include "../Context/state.h"
+extern EVC_STATE target MRDT;
 target prevMRDT;
 double T_bs1_prev;
 const double k1 = 2.0;
@@ -20,7 +21,7 @@ bool Q_displaylocked_SBI = false;
 bool Q_displaylocked_P = false;
 bool Q_Tbslocked;
 double T_bs_feedback;
-extern MonitoringStatus monitoring;
+extern EVC_STATE MonitoringStatus monitoring;
 double p0;
 double p1;
 double p2;
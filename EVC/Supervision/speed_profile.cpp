@@ -14,23 +14,146 @@
 #include "fixed_values.h"
 #include "national_values.h"
 #include "../LX/level_crossing.h"
+#include "../Position/linking.h"
 #include <vector>
 #include <map>
 #include <cmath>
-std::map<distance,double> MRSP;
-std::set<speed_restriction> SSP;
-std::list<TSR> TSRs;
-optional<speed_restriction> train_speed;
-optional<speed_restriction> SR_speed;
-optional<speed_restriction> SH_speed;
-optional<speed_restriction> UN_speed;
-optional<speed_restriction> OS_speed;
-optional<speed_restriction> LS_speed;
-optional<speed_restriction> override_speed;
-optional<speed_restriction> STM_system_speed;
-optional<speed_restriction> STM_max_speed;
-std::map<distance, double> gradient;
-int default_gradient_tsr;
+#include <algorithm>
+#include "../Context/state.h"
+EVC_STATE std::map<distance,double> MRSP;
+EVC_STATE position_ring<speed_restriction> SSP;
+EVC_STATE position_ring<TSR, TSR_position_less> TSRs;
+EVC_STATE optional<speed_restriction> train_speed;
+EVC_STATE optional<speed_restriction> SR_speed;
+EVC_STATE optional<speed_restriction> SH_speed;
+EVC_STATE optional<speed_restriction> UN_speed;
+EVC_STATE optional<speed_restriction> OS_speed;
+EVC_STATE optional<speed_restriction> LS_speed;
+EVC_STATE optional<speed_restriction> override_speed;
+EVC_STATE optional<speed_restriction> STM_system_speed;
+EVC_STATE optional<speed_restriction> STM_max_speed;
+EVC_STATE gradient_profile gradient;
+EVC_STATE int default_gradient_tsr;
+/*
+ * Flat view of the MRSP for range queries. Entries point at the keys of
+ * the MRSP map, which follow distance relocations, and a sparse table
+ * gives the lowest speed of any run of consecutive segments. Relocations
+ * move every key with the same reference alike, so whether they share
+ * one still holds, but the reference itself is read from the keys.
+ */
+struct mrsp_index
+{
+    std::vector<const distance*> starts;
+    std::vector<std::vector<double>> min_speed;
+    bool single_reference;
+    int orientation;
+    uint64_t version = 0;
+};
+EVC_STATE mrsp_index MRSP_index;
+struct ceiling_speed_cache
+{
+    uint64_t version = 0;
+    uint64_t relocations;
+    double estfront;
+    double locacc;
+    double nvlocacc;
+    int orientation;
+    double value;
+};
+EVC_STATE ceiling_speed_cache ceiling_cache;
+static void build_MRSP_index()
+{
+    mrsp_index &idx = MRSP_index;
+    idx.version++;
+    idx.starts.clear();
+    idx.single_reference = true;
+    idx.orientation = 0;
+    std::vector<double> speeds;
+    for (auto &kvp : MRSP) {
+        const distance &d = kvp.first;
+        if (!idx.starts.empty() && d.get_reference() != idx.starts[0]->get_reference())
+            idx.single_reference = false;
+        if (d.get_orientation() != 0)
+            idx.orientation = d.get_orientation();
+        idx.starts.push_back(&d);
+        speeds.push_back(kvp.second);
+    }
+    idx.min_speed.clear();
+    idx.min_speed.push_back(std::move(speeds));
+    size_t n = idx.starts.size();
+    for (size_t len = 2; len <= n; len *= 2) {
+        const std::vector<double> &prev = idx.min_speed.back();
+        std::vector<double> level(n - len + 1);
+        for (size_t i = 0; i + len <= n; i++)
+            level[i] = std::min(prev[i], prev[i + len/2]);
+        idx.min_speed.push_back(std::move(level));
+    }
+}
+static double MRSP_range_min(size_t first, size_t last)
+{
+    if (first >= last)
+        return 1000;
+    int k = 0;
+    while (((size_t)2 << k) <= last - first)
+        k++;
+    const std::vector<double> &level = MRSP_index.min_speed[k];
+    return std::min(level[first], level[last - ((size_t)1 << k)]);
+}
+static size_t MRSP_upper_bound(const distance &d)
+{
+    auto &starts = MRSP_index.starts;
+    return std::upper_bound(starts.begin(), starts.end(), &d, [](const distance *a, const distance *b) { return *a < *b; }) - starts.begin();
+}
+static size_t MRSP_lower_bound(const distance &d)
+{
+    auto &starts = MRSP_index.starts;
+    return std::lower_bound(starts.begin(), starts.end(), &d, [](const distance *a, const distance *b) { return *a < *b; }) - starts.begin();
+}
+double get_MRSP_min_speed(const distance &min, const distance &max)
+{
+    size_t first = MRSP_upper_bound(min);
+    if (first > 0)
+        first--;
+    return MRSP_range_min(first, MRSP_upper_bound(max));
+}
+double get_ceiling_speed()
+{
+    double locacc = lrbgs.empty() ? Q_NVLOCACC : lrbgs.back().locacc;
+    ceiling_speed_cache &cache = ceiling_cache;
+    if (cache.version == MRSP_index.version && cache.relocations == distance::relocation_count() && cache.estfront == d_estfront.get()
+        && cache.locacc == locacc && cache.nvlocacc == Q_NVLOCACC && cache.orientation == odometer_orientation)
+        return cache.value;
+    double V_MRSP = 1000;
+    if (MRSP_index.single_reference && !MRSP_index.starts.empty()) {
+        // The safe front end window is the same for every segment: those
+        // starting inside it, and the one it starts in, are in force
+        double reference = MRSP_index.starts[0]->get_reference();
+        distance min = d_minsafefront(MRSP_index.orientation, reference);
+        distance max = d_maxsafefront(MRSP_index.orientation, reference);
+        size_t first = MRSP_upper_bound(min);
+        if (first > 0 && *MRSP_index.starts[first-1] < min)
+            first--;
+        V_MRSP = MRSP_range_min(first, MRSP_lower_bound(max));
+    } else {
+        for (auto it = MRSP.begin(); it!=MRSP.end(); ++it) {
+            const distance &d = it->first;
+            distance min = d_minsafefront(d);
+            distance max = d_maxsafefront(d);
+            auto next = it;
+            ++next;
+            if ((max>d && min<d) || (min>d && (next==MRSP.end() || min<next->first)))
+                V_MRSP = std::min(it->second, V_MRSP);
+        }
+    }
+    cache.version = MRSP_index.version;
+    cache.relocations = distance::relocation_count();
+    cache.estfront = d_estfront.get();
+    cache.locacc = locacc;
+    cache.nvlocacc = Q_NVLOCACC;
+    cache.orientation = odometer_orientation;
+    cache.value = V_MRSP;
+    return V_MRSP;
+}
 void delete_back_info()
 {
     const distance mindist = d_minsafefront(odometer_orientation, 0)-L_TRAIN-D_keep_information; //For unlinked balise groups, change this, losing efficiency
@@ -38,15 +161,17 @@ void delete_back_info()
         auto prev = it;
         --prev;
         if (prev->get_end()<mindist) {
-            SSP.erase(SSP.begin(), it);
+            SSP.pop_front(it);
             break;
         }
     }
     {
         auto it = gradient.upper_bound(mindist);
         if (it != gradient.begin())
-            gradient.erase(gradient.begin(), --it);
+            gradient.pop_front(--it);
     }
+    // Restrictions are sorted by start, not by end, so any of them may
+    // have been left behind
     TSRs.remove_if([mindist](const TSR &t) {
         return t.restriction.get_end()<mindist;
     });
@@ -56,7 +181,7 @@ void delete_back_info()
 }
 void delete_SSP(distance d)
 {
-    SSP.erase(SSP.lower_bound(speed_restriction(0,d,d,false)), SSP.end());
+    SSP.truncate(SSP.lower_bound(speed_restriction(0,d,d,false)));
 }
 void delete_SSP()
 {
@@ -66,8 +191,11 @@ void delete_gradient(distance d)
 {
     auto it = gradient.upper_bound(d);
     if (it != gradient.end()) {
-        gradient.erase(it, gradient.end());
-        gradient[d] = 255;
+        gradient.truncate(it);
+        if (!gradient.empty() && gradient.back().first == d)
+            gradient.back().second = 255;
+        else
+            gradient.push_back({d, 255});
     }
     target::recalculate_all_decelerations();
 }
@@ -78,7 +206,7 @@ void delete_gradient()
 }
 void delete_TSR(distance d)
 {
-    std::remove_if(TSRs.begin(), TSRs.end(), [d](const TSR& t) {return d < t.restriction.get_start();});
+    TSRs.remove_if([d](const TSR& t) {return d < t.restriction.get_start();});
 }
 void delete_TSR()
 {
@@ -133,6 +261,7 @@ void recalculate_MRSP()
     if (mode == Mode::FS || mode == Mode::OS || mode == Mode::LS)
         restrictions.insert(signal_speeds.begin(), signal_speeds.end());
     if (restrictions.empty()) {
+        build_MRSP_index();
         set_supervised_targets();
         return;
     }
@@ -150,13 +279,18 @@ void recalculate_MRSP()
         if (MRSP.size()==0 || (--MRSP.upper_bound(*it))->second!=spd)
             MRSP[*it] = spd;
     }
+    build_MRSP_index();
     calculate_perturbation_location();
     set_supervised_targets();
 }
-std::map<distance,double> &get_MRSP()
+const std::map<distance,double> &get_MRSP()
 {
     return MRSP;
 }
+uint64_t get_MRSP_version()
+{
+    return MRSP_index.version;
+}
 void update_SSP(std::vector<SSP_element> nSSP)
 {
     std::set<speed_restriction> rest;
@@ -167,32 +301,32 @@ void update_SSP(std::vector<SSP_element> nSSP)
         distance end = next==nSSP.end() ? distance(std::numeric_limits<double>::max(), 0, 0) : next->start;
         rest.insert(speed_restriction(it->get_speed(cant_deficiency,other_train_categories), it->start, end, it->compensate_train_length));
     }
-    auto it_start = SSP.lower_bound(*rest.begin());
-    SSP.erase(it_start, SSP.end());
+    SSP.truncate(SSP.lower_bound(*rest.begin()));
     if (!SSP.empty() && !rest.empty()) {
         auto it = --SSP.end();
         distance end = it->get_uncompensated_end();
         if (end > rest.begin()->get_start()) {
             speed_restriction r = speed_restriction(it->get_speed(), it->get_start(), rest.begin()->get_start(), it->is_compensated());
-            SSP.erase(it);
+            SSP.truncate(it);
             SSP.insert(r);
         }
     }
-    SSP.insert(rest.begin(), rest.end());
+    for (auto &r : rest)
+        SSP.insert(r);
     recalculate_MRSP();
 }
-std::set<speed_restriction> &get_SSP()
+position_ring<speed_restriction> &get_SSP()
 {
     return SSP;
 }
 void update_gradient(std::map<distance, double> grad)
 {
-    auto it_start = gradient.lower_bound(grad.begin()->first);
-    gradient.erase(it_start, gradient.end());
-    gradient.insert(grad.begin(), grad.end());
+    gradient.truncate(gradient.lower_bound(grad.begin()->first));
+    for (auto &kvp : grad)
+        gradient.push_back(kvp);
     target::recalculate_all_decelerations();
 }
-const std::map<distance, double> &get_gradient()
+const gradient_profile &get_gradient()
 {
     return gradient;
 }
@@ -202,24 +336,18 @@ void set_train_max_speed(double vel)
     train_speed = speed_restriction(V_train, ::distance(std::numeric_limits<double>::lowest(), 0, 0), ::distance(std::numeric_limits<double>::max(), 0, 0), false);
     recalculate_MRSP();
 }
-bool inhibit_revocable_tsr;
+EVC_STATE bool inhibit_revocable_tsr;
 void insert_TSR(TSR rest)
 {
     revoke_TSR(rest.id);
-    TSRs.push_back(rest);
+    TSRs.insert(rest);
     recalculate_MRSP();
 }
 void revoke_TSR(int id_tsr)
 {
-    std::list<std::list<TSR>::iterator> revocable;
-    for (auto it=TSRs.begin(); it!=TSRs.end(); ++it) {
-        if (it->id == id_tsr && it->revocable) {
-            revocable.push_back(it);
-        }
-    }
-    for (auto it : revocable) {
-        TSRs.erase(it);
-    }
+    TSRs.remove_if([id_tsr](const TSR &t) {
+        return t.id == id_tsr && t.revocable;
+    });
     recalculate_MRSP();
 }
 speed_restriction get_PBD_restriction(double d_PBD, distance start, distance end, bool EB, double g)
@@ -16,6 +16,9 @@
 #include "../SSP/ssp.h"
 #include "fixed_values.h"
 #include "train_data.h"
+#include "conversion_model.h"
+#include "../Utils/position_ring.h"
+#include "../Context/state.h"
 void recalculate_MRSP();
 void delete_track_info();
 void delete_track_info(distance from);
@@ -25,7 +28,20 @@ void delete_gradient();
 void delete_gradient(distance from);
 void delete_TSR();
 void delete_TSR(distance from);
-std::map<distance,double> &get_MRSP();
+const std::map<distance,double> &get_MRSP();
+/*
+ * Changes whenever the MRSP is recalculated.
+ */
+uint64_t get_MRSP_version();
+/*
+ * Lowest MRSP speed between two locations, in O(log n).
+ */
+double get_MRSP_min_speed(const distance &min, const distance &max);
+/*
+ * Lowest MRSP speed over the current safe front end window. The result is
+ * cached until the train moves or the MRSP changes.
+ */
+double get_ceiling_speed();
 inline double dV_ebi(double vel)
 {
     return std::max(dV_ebi_min, std::min(dV_ebi_min*(dV_ebi_max - dV_ebi_min)/(V_ebi_max-V_ebi_min)*(vel-V_ebi_min), dV_ebi_max));
@@ -68,26 +84,33 @@ public:
 };
 void set_train_max_speed(double vel);
 void update_SSP(std::vector<SSP_element> nSSP);
-std::set<speed_restriction> &get_SSP();
+position_ring<speed_restriction> &get_SSP();
 void update_gradient(std::map<distance, double> grad);
-const std::map<distance, double> &get_gradient();
-extern int default_gradient_tsr;
+const gradient_profile &get_gradient();
+extern EVC_STATE int default_gradient_tsr;
 struct TSR
 {
     int id;
     bool revocable;
     speed_restriction restriction;
 };
+struct TSR_position_less
+{
+    bool operator()(const TSR &a, const TSR &b) const
+    {
+        return a.restriction.get_start() < b.restriction.get_start();
+    }
+};
 void insert_TSR(TSR rest);
 void revoke_TSR(int id_tsr);
-extern bool inhibit_revocable_tsr;
-extern std::list<TSR> TSRs;
-extern optional<speed_restriction> SR_speed;
-extern optional<speed_restriction> SH_speed;
-extern optional<speed_restriction> UN_speed;
-extern optional<speed_restriction> OS_speed;
-extern optional<speed_restriction> LS_speed;
-extern optional<speed_restriction> STM_system_speed;
-extern optional<speed_restriction> STM_max_speed;
-extern optional<speed_restriction> override_speed;
+extern EVC_STATE bool inhibit_revocable_tsr;
+extern EVC_STATE position_ring<TSR, TSR_position_less> TSRs;
+extern EVC_STATE optional<speed_restriction> SR_speed;
+extern EVC_STATE optional<speed_restriction> SH_speed;
+extern EVC_STATE optional<speed_restriction> UN_speed;
+extern EVC_STATE optional<speed_restriction> OS_speed;
+extern EVC_STATE optional<speed_restriction> LS_speed;
+extern EVC_STATE optional<speed_restriction> STM_system_speed;
+extern EVC_STATE optional<speed_restriction> STM_max_speed;
+extern EVC_STATE optional<speed_restriction> override_speed;
 speed_restriction get_PBD_restriction(double d_PBD, distance start, distance end, bool EB, double g);
@@ -20,63 +20,47 @@
 #include "../TrainSubsystems/brake.h"
 #include "../TrainSubsystems/train_interface.h"
 #include "../TrainSubsystems/power.h"
+#include "../Utils/parallel.h"
 #include <iostream>
 #include <cmath>
-double V_est=0;
-double V_ura = 0;
-double A_est = 0;
-double V_perm;
-double V_target;
-double V_sbi;
-double D_target;
-double TTI = 20;
-double TTP;
-bool EB=false;
-bool SB=false;
-bool TCO=false;
-std::string driver_id;
-bool driver_id_valid=false;
-int train_running_number;
-bool train_running_number_valid;
-MonitoringStatus monitoring = CSM;
-SupervisionStatus supervision = NoS;
-target MRDT;
-const target *RSMtarget;
-distance d_startRSM;
-const target *indication_target;
-double indication_distance;
-double V_release = 0;
-double T_brake_service;
-double T_brake_emergency;
-double T_bs;
-double T_bs1;
-double T_bs2;
-double T_be;
+#include "../Context/state.h"
+EVC_STATE double V_est=0;
+EVC_STATE double V_ura = 0;
+EVC_STATE double A_est = 0;
+EVC_STATE double V_perm;
+EVC_STATE double V_target;
+EVC_STATE double V_sbi;
+EVC_STATE double D_target;
+EVC_STATE double TTI = 20;
+EVC_STATE double TTP;
+EVC_STATE bool EB=false;
+EVC_STATE bool SB=false;
+EVC_STATE bool TCO=false;
+EVC_STATE std::string driver_id;
+EVC_STATE bool driver_id_valid=false;
+EVC_STATE int train_running_number;
+EVC_STATE bool train_running_number_valid;
+EVC_STATE MonitoringStatus monitoring = CSM;
+EVC_STATE SupervisionStatus supervision = NoS;
+EVC_STATE target MRDT;
+EVC_STATE const target *RSMtarget;
+EVC_STATE distance d_startRSM;
+EVC_STATE const target *indication_target;
+EVC_STATE double indication_distance;
+EVC_STATE double V_release = 0;
+EVC_STATE double T_brake_service;
+EVC_STATE double T_brake_emergency;
+EVC_STATE double T_bs;
+EVC_STATE double T_bs1;
+EVC_STATE double T_bs2;
+EVC_STATE double T_be;
 double calc_ceiling_limit()
 {
-    std::map<distance,double> MRSP = get_MRSP();
-    double V_MRSP = 1000;
-    for (auto it = MRSP.begin(); it!=MRSP.end(); ++it) {
-        distance d = it->first;
-        distance min = d_minsafefront(d);
-        distance max = d_maxsafefront(d);
-        auto next = it;
-        ++next;
-        if ((max>d && min<d) || (min>d && (next==MRSP.end() || min<next->first)))
-            V_MRSP = std::min(it->second, V_MRSP);
-    }
-    return V_MRSP;
+    return get_ceiling_speed();
 }
 double calc_ceiling_limit(distance min, distance max)
 {
-    std::map<distance,double> MRSP = get_MRSP();
-    auto it1 = --MRSP.upper_bound(min);
-    auto it2 = MRSP.upper_bound(max);
-    double V_MRSP = 1000;
-    for (auto it = it1; it!=it2; ++it) {
-        V_MRSP = std::min(it->second, V_MRSP);
-    }
-    return V_MRSP;
+    return get_MRSP_min_speed(min, max);
 }
 distance get_d_startRSM(double V_release)
 {
@@ -149,15 +133,24 @@ double calculate_V_release()
         t->calculate_times();
         double V_target = t->get_target_speed();
         double V_releaset = V_target;
-        double V_test = V_target;
-        while (V_test <= V_release) {
-            double V_delta0rsob = Q_NVINHSMICPERM ? 0 : std::max(0.007*V_release, V_ura);
-            double D_bec = (V_test+V_delta0rsob)*(t->T_traction+t->T_berem);
-            if (d_tripEoA+D_bec<=t->get_distance_curve(V_target) && std::abs(V_test-(t->get_speed_curve(d_tripEoA+D_bec)-V_delta0rsob))<=(1.0/3.6)) {
-                V_releaset = V_test;
+        double V_delta0rsob = Q_NVINHSMICPERM ? 0 : std::max(0.007*V_release, V_ura);
+        // All tested speeds are evaluated on the target curve in one pass
+        distance d_target = t->get_target_position();
+        double limit = d_target-t->get_distance_curve(V_target);
+        double start = d_target-d_tripEoA;
+        std::vector<double> V_tests;
+        std::vector<double> offsets;
+        for (double V_test = V_target; V_test <= V_release; V_test += 1.0/3.6) {
+            V_tests.push_back(V_test);
+            offsets.push_back(start-(V_test+V_delta0rsob)*(t->T_traction+t->T_berem));
+        }
+        std::vector<double> speeds(offsets.size());
+        speed_curve(t->get_braking_curve(), offsets.data(), speeds.data(), speeds.size());
+        for (int i=0; i<V_tests.size(); i++) {
+            if (offsets[i] >= limit && std::abs(V_tests[i]-(speeds[i]-V_delta0rsob))<=(1.0/3.6)) {
+                V_releaset = V_tests[i];
                 break;
             }
-            V_test += 1.0/3.6;
         }
         V_release = std::min(V_release, V_releaset);
     }
@@ -207,14 +200,14 @@ void update_monitor_transitions(bool suptargchang, const std::list<target> &supe
 }
 #include <chrono>
 #include <iostream>
-optional<float> standstill_position;
-bool standstill_applied;
-optional<float> rollaway_position;
-bool rollaway_applied;
-optional<float> rmp_position;
-bool rmp_applied;
-optional<distance> pt_position;
-bool pt_applied;
+EVC_STATE optional<float> standstill_position;
+EVC_STATE bool standstill_applied;
+EVC_STATE optional<float> rollaway_position;
+EVC_STATE bool rollaway_applied;
+EVC_STATE optional<float> rmp_position;
+EVC_STATE bool rmp_applied;
+EVC_STATE optional<distance> pt_position;
+EVC_STATE bool pt_applied;
 void update_supervision()
 {
     if (mode == Mode::TR) {
@@ -317,13 +310,19 @@ void update_supervision()
     const target *tEoA1;
     const target *tSvL1;
     const std::list<target> &supervised_targets = get_supervised_targets();
+    std::vector<const target*> curve_targets;
     for (auto it=supervised_targets.begin(); it!=supervised_targets.end(); ++it) {
-        it->calculate_curves();
+        curve_targets.push_back(&*it);
         if (it->type == target_class::SvL)
             tSvL1 = &(*it);
         if (it->type == target_class::EoA)
             tEoA1 = &(*it);
     }
+    // Each target only writes its own curves, so they can be computed
+    // concurrently
+    parallel_for(curve_targets.size(), [&curve_targets](int i) {
+        curve_targets[i]->calculate_curves();
+    });
     if (EoA && SvL && (mode == Mode::FS || mode == Mode::OS || mode == Mode::LS)) {
         if (V_release != 0)
             d_startRSM = get_d_startRSM(V_release);
@@ -9,25 +9,26 @@
 #pragma once
 #include <string>
 #include "common.h"
+#include "../Context/state.h"
 const char Mode_str[][3] = {"FS","LS","OS","SR","SH","UN","PS","SL","SB","TR","PT","SF","IS","NP","NL","SN","RV"};
-extern Level level;
-extern int nid_ntc;
-extern bool level_valid;
-extern std::string driver_id;
-extern bool driver_id_valid;
-extern int train_running_number;
-extern bool train_running_number_valid;
-extern Mode mode;
-extern double V_est;
-extern double V_ura;
-extern double A_est;
-extern double V_perm;
-extern double V_target;
-extern double V_sbi;
-extern double D_target;
-extern double V_release;
-extern double T_bs1;
-extern double T_bs2;
+extern EVC_STATE Level level;
+extern EVC_STATE int nid_ntc;
+extern EVC_STATE bool level_valid;
+extern EVC_STATE std::string driver_id;
+extern EVC_STATE bool driver_id_valid;
+extern EVC_STATE int train_running_number;
+extern EVC_STATE bool train_running_number_valid;
+extern EVC_STATE Mode mode;
+extern EVC_STATE double V_est;
+extern EVC_STATE double V_ura;
+extern EVC_STATE double A_est;
+extern EVC_STATE double V_perm;
+extern EVC_STATE double V_target;
+extern EVC_STATE double V_sbi;
+extern EVC_STATE double D_target;
+extern EVC_STATE double V_release;
+extern EVC_STATE double T_bs1;
+extern EVC_STATE double T_bs2;
 double calc_ceiling_limit();
 void update_supervision();
 double calculate_V_release();
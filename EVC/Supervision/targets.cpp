@@ -19,7 +19,10 @@
 #include "../MA/movement_authority.h"
 #include "../TrainSubsystems/train_interface.h"
 #include <set>
-std::list<PBD_target> PBDs;
+#include <cmath>
+#include "../Context/state.h"
+EVC_STATE position_ring<PBD_target, PBD_position_less> PBDs;
+EVC_STATE unsigned target::deceleration_version = 0;
 target::target() : is_valid(false), type(target_class::MRSP) {};
 target::target(distance dist, double speed, target_class type) : d_target(dist), V_target(speed), is_valid(true), type(type)
 {
@@ -44,6 +47,12 @@ distance target::get_distance_curve(double velocity) const
             std::cout<<diff<<std::endl;
         return a;
     }*/
+    const braking_curve &c = get_braking_curve();
+    if (c.valid() && velocity >= c.vref) {
+        double offset = c.offset_at(velocity);
+        if (offset < std::numeric_limits<double>::max())
+            return d_target - offset;
+    }
     if (is_EBD_based) {
         if (type == target_class::SvL || type == target_class::SR_distance || type == target_class::PBD)
             return distance_curve(A_safe, d_target, 0, velocity);
@@ -55,6 +64,9 @@ distance target::get_distance_curve(double velocity) const
 }
 double target::get_speed_curve(distance dist) const
 {
+    const braking_curve &c = get_braking_curve();
+    if (c.valid() && dist <= d_target)
+        return c.speed(d_target - dist);
     if (is_EBD_based) {
         if (type == target_class::SvL || type == target_class::SR_distance || type == target_class::PBD)
             return speed_curve(A_safe, d_target, 0, dist);
@@ -64,6 +76,42 @@ double target::get_speed_curve(distance dist) const
         return speed_curve(A_expected, d_target, 0, dist);
     }
 }
+void target::invalidate_curves() const
+{
+    curve.reset();
+    gui_curve[0].reset();
+    gui_curve[1].reset();
+    curves_version = deceleration_version;
+}
+const braking_curve &target::get_braking_curve() const
+{
+    if (curves_version != deceleration_version)
+        invalidate_curves();
+    if (curve == nullptr) {
+        if (is_EBD_based) {
+            if (type == target_class::SvL || type == target_class::SR_distance || type == target_class::PBD)
+                curve = std::make_shared<braking_curve>(A_safe, d_target, 0);
+            else
+                curve = std::make_shared<braking_curve>(A_safe, d_target, V_target+dV_ebi(V_target));
+        } else {
+            curve = std::make_shared<braking_curve>(A_expected, d_target, 0);
+        }
+    }
+    return *curve;
+}
+const braking_curve &target::get_gui_curve(int index, const distance &guifoot) const
+{
+    // The foot of the GUI curve moves with the brake times, so the
+    // cached curve is only reused while it starts at the same point
+    if (curves_version != deceleration_version)
+        invalidate_curves();
+    std::shared_ptr<const braking_curve> &c = gui_curve[index];
+    if (c == nullptr || gui_foot[index] != guifoot || gui_foot[index].get_orientation() != guifoot.get_orientation()) {
+        c = std::make_shared<braking_curve>(A_normal_service, guifoot, V_target);
+        gui_foot[index] = guifoot;
+    }
+    return *c;
+}
 distance target::get_distance_gui_curve(double velocity) const
 {
     distance guifoot;
@@ -74,6 +122,12 @@ distance target::get_distance_gui_curve(double velocity) const
         distance debi = get_distance_curve(V_target+V_delta0t)-(V_target+V_delta0t)*(T_berem+T_traction);
         guifoot = debi-V_target*(T_driver+T_bs2);
     }
+    const braking_curve &c = get_gui_curve(0, guifoot);
+    if (c.valid() && velocity >= V_target) {
+        double offset = c.offset_at(velocity);
+        if (offset < std::numeric_limits<double>::max())
+            return guifoot - offset;
+    }
     return distance_curve(A_normal_service, guifoot, V_target, velocity);
 }
 double target::get_speed_gui_curve(distance dist) const
@@ -86,6 +140,9 @@ double target::get_speed_gui_curve(distance dist) const
         distance debi = get_distance_curve(V_target+V_delta0t)-(V_target+V_delta0t)*(T_berem+T_traction);
         guifoot = debi-V_target*(T_driver+T_bs2);
     }
+    const braking_curve &c = get_gui_curve(1, guifoot);
+    if (c.valid() && dist <= guifoot)
+        return c.speed(guifoot - dist);
     return speed_curve(A_normal_service, guifoot, V_target, dist);
 }
 void target::calculate_times() const
@@ -165,22 +222,22 @@ void target::calculate_curves(double V_est, double A_est, double V_delta) const
         }
     }
 }
-optional<distance> EoA;
-optional<distance> SvL;
-optional<distance> SR_dist;
-optional<double> D_STFF_rbc;
-optional<std::pair<distance,double>> LoA;
-double V_releaseSvL=0;
-static std::list<target> supervised_targets;
-bool changed = false;
+EVC_STATE optional<distance> EoA;
+EVC_STATE optional<distance> SvL;
+EVC_STATE optional<distance> SR_dist;
+EVC_STATE optional<double> D_STFF_rbc;
+EVC_STATE optional<std::pair<distance,double>> LoA;
+EVC_STATE double V_releaseSvL=0;
+EVC_STATE static std::list<target> supervised_targets;
+EVC_STATE bool changed = false;
 void set_supervised_targets()
 {
     changed = true;
-    extern const target *indication_target;
+    extern EVC_STATE const target *indication_target;
     indication_target = nullptr;
     supervised_targets.clear();
     if (mode != Mode::SR && mode != Mode::UN && mode != Mode::FS && mode != Mode::OS && mode != Mode::LS) return;
-    std::map<distance, double> MRSP = get_MRSP();
+    const std::map<distance, double> &MRSP = get_MRSP();
     if (!MRSP.empty()) {
         auto minMRSP = MRSP.begin();
         auto prev = minMRSP;
@@ -235,8 +292,9 @@ void target::calculate_decelerations()
 {
     calculate_decelerations(get_gradient());
 }
-void target::calculate_decelerations(const std::map<distance,double> &gradient)
+void target::calculate_decelerations(const gradient_profile &gradient)
 {
+    invalidate_curves();
     std::map<distance,bool> redadh;
     redadh[distance(std::numeric_limits<double>::lowest(), 0, 0)] = false;
     acceleration A_gradient = get_A_gradient(gradient, default_gradient);
@@ -296,11 +354,14 @@ void target::calculate_decelerations(const std::map<distance,double> &gradient)
 }
 void target::recalculate_all_decelerations()
 {
+    // Curves of targets not in these lists (copies kept elsewhere) are
+    // rebuilt on their next use
+    deceleration_version++;
     std::set<target*> targets;
     for (auto &t : supervised_targets) {
         targets.insert(&t);
     }
-    extern std::map<track_condition*, std::vector<target>> track_condition_targets; 
+    extern EVC_STATE std::map<track_condition*, std::vector<target>> track_condition_targets; 
     for (auto &kvp : track_condition_targets) {
         for (auto &t : kvp.second)
             targets.insert(&t);
@@ -314,45 +375,71 @@ void target::recalculate_all_decelerations()
     }
     calculate_perturbation_location();
 }
+/*
+ * Lowest speed of the 0.8 km/h grid up to 500 km/h for which the tested
+ * speed matches the curve speed at the point where braking would start.
+ * Both the tested speed and the distance travelled before braking grow
+ * with speed, so the mismatch is monotonic and the first grid point
+ * within tolerance is bracketed by bisection. If that point is not a
+ * match, no higher one can be, and the speed is zero.
+ */
+template<typename T>
+static double find_PBD_speed(const braking_curve &curve, T &&offset_at)
+{
+    const double step = 0.8/3.6;
+    const int steps = (int)std::ceil((500/3.6)/step);
+    double V_delta0PBD = Q_NVINHSMICPERM ? 0 : 0;
+    auto matched = [&](int k, double &mismatch) {
+        double v_tested = 0;
+        double offset = offset_at(k*step, v_tested);
+        if (offset < 0)
+            return false;
+        mismatch = v_tested-(curve.speed(offset)-V_delta0PBD);
+        return true;
+    };
+    int lo = 0;
+    int hi = steps;
+    while (lo < hi) {
+        int mid = (lo+hi)/2;
+        double mismatch;
+        if (!matched(mid, mismatch) || mismatch >= -1/3.6)
+            hi = mid;
+        else
+            lo = mid+1;
+    }
+    double mismatch;
+    if (lo < steps && matched(lo, mismatch) && std::abs(mismatch) <= 1/3.6)
+        return lo*step;
+    return 0;
+}
 void PBD_target::calculate_restriction()
 {
     calculate_times();
-    float V_PBD = 0;
-    distance doffset = start + L_antenna_front;
-    for (double v_pbd = 0; v_pbd<500/3.6; v_pbd+=0.8/3.6) {
-        if (is_EBD_based) {
-            float V_delta0PBD = Q_NVINHSMICPERM ? 0 : 0;
-            float Dbec = (v_pbd + dV_ebi(v_pbd) + V_delta0PBD)*(T_traction + T_berem);
-            distance d1 = doffset + Dbec;
-            if (d1 <= d_target && abs(v_pbd+dV_ebi(v_pbd)-(speed_curve(A_safe, d_target, 0, d1)-V_delta0PBD))<=1/3.6) {
-                V_PBD = v_pbd;
-                break;
-            }
-        } else {
-            float V_delta0PBD = Q_NVINHSMICPERM ? 0 : 0;
-            float Dbec = (v_pbd + dV_sbi(v_pbd) + V_delta0PBD)*(T_traction + T_berem);
-            distance d1 = doffset + Dbec + (v_pbd + dV_sbi(v_pbd))*T_bs2;
-            if (d1 <= d_target && abs(v_pbd+dV_sbi(v_pbd)-(speed_curve(A_safe, d_target, 0, d1)-V_delta0PBD))<=1/3.6) {
-                V_PBD = v_pbd;
-                break;
-            }
-        }
-    }
-    if (!is_EBD_based) {
-        float V_PBD_SB = 0;
-        for (double v_pbd = 0; v_pbd<500/3.6; v_pbd+=0.8/3.6) {
-            distance d1 = doffset + (v_pbd + dV_sbi(v_pbd))*T_bs1;
-            if (d1 <= d_target && abs(v_pbd+dV_sbi(v_pbd)-(speed_curve(A_expected, d_target, 0, d1)))<=1/3.6) {
-                V_PBD_SB = v_pbd;
-                break;
-            }
-        }
+    double V_PBD = 0;
+    // Offsets are measured backwards from the target
+    double doffset = d_target - (start + L_antenna_front);
+    braking_curve safe(A_safe, d_target, 0);
+    if (is_EBD_based) {
+        V_PBD = find_PBD_speed(safe, [&](double v_pbd, double &v_tested) {
+            v_tested = v_pbd+dV_ebi(v_pbd);
+            return doffset - v_tested*(T_traction + T_berem);
+        });
+    } else {
+        V_PBD = find_PBD_speed(safe, [&](double v_pbd, double &v_tested) {
+            v_tested = v_pbd+dV_sbi(v_pbd);
+            return doffset - v_tested*(T_traction + T_berem) - v_tested*T_bs2;
+        });
+        braking_curve expected(A_expected, d_target, 0);
+        double V_PBD_SB = find_PBD_speed(expected, [&](double v_pbd, double &v_tested) {
+            v_tested = v_pbd+dV_sbi(v_pbd);
+            return doffset - v_tested*T_bs1;
+        });
         if (V_PBD > V_PBD_SB)
             V_PBD = V_PBD_SB;
     }
     restriction = speed_restriction(((int)(V_PBD*3.6/5))*5/3.6, start, end, false);
 }
-optional<distance> reset_pbd;
+EVC_STATE optional<distance> reset_pbd;
 void load_PBD(PermittedBrakingDistanceInformation &pbd, distance ref)
 {
     if (pbd.Q_TRACKINIT == Q_TRACKINIT_t::InitialState) {
@@ -361,14 +448,14 @@ void load_PBD(PermittedBrakingDistanceInformation &pbd, distance ref)
     }
     reset_pbd = {};
     distance start = ref+pbd.element.D_PBDSR.get_value(pbd.Q_SCALE);
-    PBDs.remove_if([start](const PBD_target &t) {return t.start < start;});
+    PBDs.pop_front(PBDs.lower_bound(start));
     std::vector<PBD_element> elements;
     elements.push_back(pbd.element);
     elements.insert(elements.end(), pbd.elements.begin(), pbd.elements.end());
     for (auto &e : elements) {
         ref += e.D_PBDSR.get_value(pbd.Q_SCALE);
         double grad = (e.Q_GDIR == Q_GDIR_t::Uphill ? 0.001 : -0.001)*e.G_PBDSR;
-        PBDs.push_back(PBD_target(ref, ref+e.L_PBDSR.get_value(pbd.Q_SCALE), e.D_PBD.get_value(pbd.Q_SCALE), e.Q_PBDSR == Q_PBDSR_t::EBIntervention, grad));
+        PBDs.insert(PBD_target(ref, ref+e.L_PBDSR.get_value(pbd.Q_SCALE), e.D_PBD.get_value(pbd.Q_SCALE), e.Q_PBDSR == Q_PBDSR_t::EBIntervention, grad));
     }
     recalculate_MRSP();
 }
\ No newline at end of file
@@ -10,11 +10,14 @@
 #include <set>
 #include <vector>
 #include <list>
+#include <memory>
 #include "../optional.h"
 #include "acceleration.h"
 #include "../Position/distance.h"
 #include "supervision.h"
 #include "conversion_model.h"
+#include "curve_calc.h"
+#include "../Context/state.h"
 enum struct target_class
 {
     EoA,
@@ -31,6 +34,16 @@ protected:
     double V_target;
     bool is_valid;
     bool use_brake_combination = true;
+    /*
+     * Flattened braking curves, built on first use and kept until the
+     * decelerations change. Copies of a target share them.
+     */
+    mutable std::shared_ptr<const braking_curve> curve;
+    mutable std::shared_ptr<const braking_curve> gui_curve[2];
+    mutable distance gui_foot[2];
+    mutable unsigned curves_version = 0;
+    const braking_curve &get_gui_curve(int index, const distance &guifoot) const;
+    void invalidate_curves() const;
 public:
     target_class type;
     bool is_EBD_based;
@@ -42,6 +55,7 @@ public:
     distance get_target_position() const { return d_target; }
     virtual distance get_distance_curve (double velocity) const;
     double get_speed_curve(distance dist) const;
+    const braking_curve &get_braking_curve() const;
     distance get_distance_gui_curve(double velocity) const;
     double get_speed_gui_curve(distance dist) const;
     mutable distance d_EBI;
@@ -69,7 +83,7 @@ public:
     void calculate_times() const;
     void calculate_curves(double V_est=::V_est, double A_est=::A_est, double V_delta=::V_ura) const;
     virtual void calculate_decelerations();
-    void calculate_decelerations(const std::map<distance,double> &gradient);
+    void calculate_decelerations(const gradient_profile &gradient);
     bool operator< (const target &t) const
     {
         if (!is_valid)
@@ -91,13 +105,14 @@ public:
         return V_target == t.V_target && std::abs(d_target-t.d_target)<1.1f && (int)type==(int)t.type;
     }
     static void recalculate_all_decelerations();
+    static EVC_STATE unsigned deceleration_version;
 };
-extern optional<distance> EoA;
-extern optional<distance> SvL;
-extern optional<distance> SR_dist;
-extern optional<double> D_STFF_rbc;
-extern optional<std::pair<distance,double>> LoA;
-extern double V_releaseSvL;
+extern EVC_STATE optional<distance> EoA;
+extern EVC_STATE optional<distance> SvL;
+extern EVC_STATE optional<distance> SR_dist;
+extern EVC_STATE optional<double> D_STFF_rbc;
+extern EVC_STATE optional<std::pair<distance,double>> LoA;
+extern EVC_STATE double V_releaseSvL;
 void set_supervised_targets();
 const std::list<target> &get_supervised_targets();
 bool supervised_targets_changed();
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "targets.h"
 #include "speed_profile.h"
 #include "../Packets/52.h"
+#include "../Context/state.h"
 class PBD_target : public target
 {
     public:
@@ -26,11 +27,16 @@ class PBD_target : public target
     }
     void calculate_decelerations() override
     {
-        std::map<distance,double> gradient;
+        gradient_profile gradient;
         target::calculate_decelerations(gradient);
         calculate_restriction();
     }
     void calculate_restriction();
 };
-extern std::list<PBD_target> PBDs;
+struct PBD_position_less
+{
+    bool operator()(const PBD_target &a, const PBD_target &b) const { return a.start < b.start; }
+    bool operator()(const PBD_target &a, const distance &b) const { return a.start < b; }
+};
+extern EVC_STATE position_ring<PBD_target, PBD_position_less> PBDs;
 void load_PBD(PermittedBrakingDistanceInformation &pbd, distance ref);
\ No newline at end of file
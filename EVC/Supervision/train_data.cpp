@@ -13,6 +13,7 @@
 #include "../TrainSubsystems/brake.h"
 #include <fstream>
 #include <list>
+#include "../Context/state.h"
 using json = nlohmann::json;
 enum Electrifications
 {
@@ -28,21 +29,21 @@ struct traction_type
     Electrifications electrification;
     int additional_info;
 };
-double A_ebmax;
-double L_TRAIN=0;
-double T_traction_cutoff = 0.1;
-double M_rotating_nom;
-double V_train = 0;
-bool Q_airtight = false;
-int axle_number=12;
-int brake_percentage=0;
-int cant_deficiency=0;
-std::set<int> other_train_categories;
-brake_position_types brake_position = PassengerP;
-bool train_data_valid = false;
-std::string special_train_data;
-std::list<traction_type> traction_systems;
-std::string traindata_file = "traindata.txt";
+EVC_STATE double A_ebmax;
+EVC_STATE double L_TRAIN=0;
+EVC_STATE double T_traction_cutoff = 0.1;
+EVC_STATE double M_rotating_nom;
+EVC_STATE double V_train = 0;
+EVC_STATE bool Q_airtight = false;
+EVC_STATE int axle_number=12;
+EVC_STATE int brake_percentage=0;
+EVC_STATE int cant_deficiency=0;
+EVC_STATE std::set<int> other_train_categories;
+EVC_STATE brake_position_types brake_position = PassengerP;
+EVC_STATE bool train_data_valid = false;
+EVC_STATE std::string special_train_data;
+EVC_STATE std::list<traction_type> traction_systems;
+EVC_STATE std::string traindata_file = "traindata.txt";
 void set_train_data(std::string spec)
 {
     if (special_train_data != spec) {
@@ -10,26 +10,27 @@
 #include <set>
 #include "../antenna.h"
 #include <string>
+#include "../Context/state.h"
 enum brake_position_types
 {
     FreightP,
     FreightG,
     PassengerP,
 };
-extern brake_position_types brake_position;
-extern double A_ebmax;
-extern double L_TRAIN;
-extern double T_brake_emergency;
-extern double T_brake_service; 
-extern double T_traction_cutoff;
-extern double M_rotating_nom;
-extern double V_train;
-extern bool Q_airtight;
-extern int axle_number;
-extern int brake_percentage;
-extern int cant_deficiency;
-extern std::set<int> other_train_categories;
-extern std::string special_train_data;
-extern bool train_data_valid;
-extern std::string traindata_file;
+extern EVC_STATE brake_position_types brake_position;
+extern EVC_STATE double A_ebmax;
+extern EVC_STATE double L_TRAIN;
+extern EVC_STATE double T_brake_emergency;
+extern EVC_STATE double T_brake_service; 
+extern EVC_STATE double T_traction_cutoff;
+extern EVC_STATE double M_rotating_nom;
+extern EVC_STATE double V_train;
+extern EVC_STATE bool Q_airtight;
+extern EVC_STATE int axle_number;
+extern EVC_STATE int brake_percentage;
+extern EVC_STATE int cant_deficiency;
+extern EVC_STATE std::set<int> other_train_categories;
+extern EVC_STATE std::string special_train_data;
+extern EVC_STATE bool train_data_valid;
+extern EVC_STATE std::string traindata_file;
 void set_train_data(std::string spec);
\ No newline at end of file
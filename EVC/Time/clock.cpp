@@ -11,4 +11,9 @@ int64_t get_milliseconds()
 {
     return (std::chrono::duration_cast<std::chrono::milliseconds>
         (std::chrono::system_clock::now().time_since_epoch())).count();
-}
\ No newline at end of file
+}
+int64_t get_microseconds()
+{
+    return (std::chrono::duration_cast<std::chrono::microseconds>
+        (std::chrono::steady_clock::now().time_since_epoch())).count();
+}
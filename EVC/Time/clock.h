@@ -8,4 +8,8 @@
  */
 #pragma once
 #include <chrono>
-int64_t get_milliseconds();
\ No newline at end of file
+int64_t get_milliseconds();
+/*
+ * Monotonic time, for measuring intervals between inputs.
+ */
+int64_t get_microseconds();
\ No newline at end of file
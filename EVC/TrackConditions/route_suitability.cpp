@@ -12,8 +12,9 @@
 #include "../Supervision/train_data.h"
 #include "../DMI/text_message.h"
 #include "../language/language.h"
-optional<distance> restore_route_suitability;
-std::map<int, distance> route_suitability;
+#include "../Context/state.h"
+EVC_STATE optional<distance> restore_route_suitability;
+EVC_STATE std::map<int, distance> route_suitability;
 void load_route_suitability(RouteSuitabilityData &data, distance ref)
 {
     if (data.Q_TRACKINIT == Q_TRACKINIT_t::InitialState) {
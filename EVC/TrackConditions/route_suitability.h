@@ -10,5 +10,6 @@
 #include "../Position/distance.h"
 #include "../Packets/70.h"
 #include <map>
-extern std::map<int, distance> route_suitability;
+#include "../Context/state.h"
+extern EVC_STATE std::map<int, distance> route_suitability;
 void load_route_suitability(RouteSuitabilityData &data, distance d);
\ No newline at end of file
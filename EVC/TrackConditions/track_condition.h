@@ -18,6 +18,7 @@
 #include <functional>
 #include <list>
 #include <memory>
+#include "../Context/state.h"
 enum struct TrackConditions
 {
     PowerLessSectionLowerPantograph,
@@ -137,8 +138,8 @@ struct track_condition_platforms : track_condition
     bool left_side;
     bool right_side;
 };
-extern std::list<std::shared_ptr<track_condition>> track_conditions;
-extern optional<distance> restore_initial_states_various;
+extern EVC_STATE std::list<std::shared_ptr<track_condition>> track_conditions;
+extern EVC_STATE optional<distance> restore_initial_states_various;
 void update_track_conditions();
 void update_brake_contributions();
 void load_track_condition_bigmetal(TrackConditionBigMetalMasses cond, distance ref);
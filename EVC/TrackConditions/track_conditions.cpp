@@ -13,13 +13,15 @@
 #include "../TrainSubsystems/power.h"
 #include "../TrainSubsystems/train_interface.h"
 #include "../Supervision/conversion_model.h"
-std::list<std::shared_ptr<track_condition>> track_conditions;
-optional<distance> restore_initial_states_various;
-optional<distance> restore_initial_states_platforms;
-std::set<distance> brake_change;
-std::map<track_condition*, std::vector<target>> track_condition_targets; 
+#include "../Utils/parallel.h"
+#include "../Context/state.h"
+EVC_STATE std::list<std::shared_ptr<track_condition>> track_conditions;
+EVC_STATE optional<distance> restore_initial_states_various;
+EVC_STATE optional<distance> restore_initial_states_platforms;
+EVC_STATE std::set<distance> brake_change;
+EVC_STATE std::map<track_condition*, std::vector<target>> track_condition_targets; 
 void add_condition();
-bool ep_available = true;
+EVC_STATE bool ep_available = true;
 void update_brake_contributions()
 {
     std::map<distance, std::pair<int,int>> active;
@@ -95,6 +97,14 @@ void update_track_conditions()
     neutral_section_info = {{},{}};
     lower_pantograph_info = {{},{}};
     air_tightness_info = {{},{}};
+    std::vector<target*> known_targets;
+    for (auto &kvp : track_condition_targets) {
+        for (auto &t : kvp.second)
+            known_targets.push_back(&t);
+    }
+    parallel_for(known_targets.size(), [&known_targets](int i) {
+        known_targets[i]->calculate_curves();
+    });
     for (auto it = track_conditions.begin(); it != track_conditions.end();) {
         track_condition *c = it->get();
         double end = c->get_end_distance_to_train();
@@ -118,13 +128,13 @@ void update_track_conditions()
                 std::vector<target> l;
                 l.push_back(target(c->start, 0, target_class::EoA));
                 l.push_back(target(c->end + L_TRAIN, 0, target_class::EoA));
+                l[0].calculate_curves();
+                l[1].calculate_curves();
                 track_condition_targets[c] = l;
             }
             std::vector<target> &l = track_condition_targets[c];
             target &SBId = l[0];
             target &SBIg = l[1];
-            SBId.calculate_curves();
-            SBIg.calculate_curves();
             distance max = d_maxsafefront(c->start);
             distance min = d_minsafefront(c->start);
             if (max<SBId.d_SBI1 || min > SBIg.d_SBI1) {
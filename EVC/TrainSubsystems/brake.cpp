@@ -16,11 +16,12 @@
 #include "../Euroradio/session.h"
 #include "../STM/stm.h"
 #include "../language/language.h"
-extern bool SB;
-extern bool EB;
-bool brake_acknowledgeable;
-bool brake_acknowledged;
-std::list<brake_command_information> brake_conditions;
+#include "../Context/state.h"
+extern EVC_STATE bool SB;
+extern EVC_STATE bool EB;
+EVC_STATE bool brake_acknowledgeable;
+EVC_STATE bool brake_acknowledged;
+EVC_STATE std::list<brake_command_information> brake_conditions;
 void trigger_brake_reason(int reason)
 {
     for (auto cond : brake_conditions) {
@@ -42,10 +43,10 @@ void trigger_brake_reason(int reason)
             return false;
         }});
     } else if (reason == 1) {
-        extern bool standstill_applied;
-        extern bool rollaway_applied;
-        extern bool rmp_applied;
-        extern bool pt_applied;
+        extern EVC_STATE bool standstill_applied;
+        extern EVC_STATE bool rollaway_applied;
+        extern EVC_STATE bool rmp_applied;
+        extern EVC_STATE bool pt_applied;
         text_message msg(get_text("Runaway movement"), true, false, 2, [](text_message &msg){return !standstill_applied && !rollaway_applied && !rmp_applied && !pt_applied;});
         text_message *m = &add_message(msg);
         brake_conditions.push_back({reason, m, [](brake_command_information &i) {
@@ -98,8 +99,8 @@ void trigger_brake_reason(int reason)
         }});
     }
 }
-static bool prevEB;
-static bool prevSB;
+EVC_STATE static bool prevEB;
+EVC_STATE static bool prevSB;
 void handle_brake_command()
 {
     if (mode == Mode::IS)
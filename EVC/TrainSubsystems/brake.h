@@ -8,13 +8,14 @@
  */
 #pragma once
 #include "../DMI/text_message.h"
-extern bool brake_acknowledgeable;
-extern bool brake_acknowledged;
+#include "../Context/state.h"
+extern EVC_STATE bool brake_acknowledgeable;
+extern EVC_STATE bool brake_acknowledged;
 struct brake_command_information
 {
     int reason;
     text_message *msg;
     std::function<bool(brake_command_information &i)> revoke;
 };
-extern std::list<brake_command_information> brake_conditions;
+extern EVC_STATE std::list<brake_command_information> brake_conditions;
 void trigger_brake_reason(int reason);
\ No newline at end of file
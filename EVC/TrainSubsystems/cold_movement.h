@@ -7,10 +7,11 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 #pragma once
+#include "../Context/state.h"
 enum ColdMovement
 {
     NoColdMovement,
     ColdMovement,
     ColdMovementUnknown
 };
-extern int cold_movement_status;
\ No newline at end of file
+extern EVC_STATE int cold_movement_status;
\ No newline at end of file
@@ -6,8 +6,9 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
-bool main_power_on_available=true;
-bool main_power_off_available=true;
-bool raise_pantograph_available=false;
-bool lower_pantograph_available=true;
-bool traction_cutoff_available=true;
\ No newline at end of file
+#include "../Context/state.h"
+EVC_STATE bool main_power_on_available=true;
+EVC_STATE bool main_power_off_available=true;
+EVC_STATE bool raise_pantograph_available=false;
+EVC_STATE bool lower_pantograph_available=true;
+EVC_STATE bool traction_cutoff_available=true;
\ No newline at end of file
@@ -8,9 +8,10 @@
  */
 #include "../Position/distance.h"
 #include "../optional.h"
-extern bool main_power_on_available;
-extern bool main_power_off_available;
-extern bool raise_pantograph_available;
-extern bool lower_pantograph_available;
-extern bool traction_cutoff_available;
+#include "../Context/state.h"
+extern EVC_STATE bool main_power_on_available;
+extern EVC_STATE bool main_power_off_available;
+extern EVC_STATE bool raise_pantograph_available;
+extern EVC_STATE bool lower_pantograph_available;
+extern EVC_STATE bool traction_cutoff_available;
 void update_power_status();
\ No newline at end of file
@@ -10,32 +10,33 @@
 #include "../TrackConditions/track_condition.h"
 #include "train_interface.h"
 #include "../STM/stm.h"
-bool cab_active[2] = {true, false};
-bool sl_signal;
-bool ps_signal;
-bool nl_signal;
-bool isolated;
-bool SB_command;
-bool EB_command;
-double brake_pressure;
-int reverser_direction;
-track_condition_profile_external regenerative_inhibition;
-track_condition_profile_external magnetic_inhibition;
-track_condition_profile_external eddy_eb_inhibition;
-track_condition_profile_external eddy_sb_inhibition;
-track_condition_profile_external neutral_section_info;
-track_condition_profile_external lower_pantograph_info;
-track_condition_profile_external air_tightness_info;
-bool regenerative_inhibition_stm;
-bool magnetic_inhibition_stm;
-bool eddy_eb_inhibition_stm;
-bool eddy_sb_inhibition_stm;
-bool neutral_section_stm;
-bool lower_pantograph_stm;
-bool air_tightness_stm;
-bool traction_cutoff_status;
-bool additional_brake_active;
-extern bool TCO;
+#include "../Context/state.h"
+EVC_STATE bool cab_active[2] = {true, false};
+EVC_STATE bool sl_signal;
+EVC_STATE bool ps_signal;
+EVC_STATE bool nl_signal;
+EVC_STATE bool isolated;
+EVC_STATE bool SB_command;
+EVC_STATE bool EB_command;
+EVC_STATE double brake_pressure;
+EVC_STATE int reverser_direction;
+EVC_STATE track_condition_profile_external regenerative_inhibition;
+EVC_STATE track_condition_profile_external magnetic_inhibition;
+EVC_STATE track_condition_profile_external eddy_eb_inhibition;
+EVC_STATE track_condition_profile_external eddy_sb_inhibition;
+EVC_STATE track_condition_profile_external neutral_section_info;
+EVC_STATE track_condition_profile_external lower_pantograph_info;
+EVC_STATE track_condition_profile_external air_tightness_info;
+EVC_STATE bool regenerative_inhibition_stm;
+EVC_STATE bool magnetic_inhibition_stm;
+EVC_STATE bool eddy_eb_inhibition_stm;
+EVC_STATE bool eddy_sb_inhibition_stm;
+EVC_STATE bool neutral_section_stm;
+EVC_STATE bool lower_pantograph_stm;
+EVC_STATE bool air_tightness_stm;
+EVC_STATE bool traction_cutoff_status;
+EVC_STATE bool additional_brake_active;
+extern EVC_STATE bool TCO;
 void update_train_interface()
 {
     traction_cutoff_status = !TCO;
@@ -8,35 +8,36 @@
  */
 #pragma once
 #include "../optional.h"
-extern bool sl_signal;
-extern bool ps_signal;
-extern bool nl_signal;
-extern bool isolated;
-extern bool SB_command;
-extern double brake_pressure;
-extern bool EB_command;
+#include "../Context/state.h"
+extern EVC_STATE bool sl_signal;
+extern EVC_STATE bool ps_signal;
+extern EVC_STATE bool nl_signal;
+extern EVC_STATE bool isolated;
+extern EVC_STATE bool SB_command;
+extern EVC_STATE double brake_pressure;
+extern EVC_STATE bool EB_command;
 struct track_condition_profile_external
 {
     optional<double> start;
     optional<double> end;
 };
-extern track_condition_profile_external regenerative_inhibition;
-extern track_condition_profile_external magnetic_inhibition;
-extern track_condition_profile_external eddy_eb_inhibition;
-extern track_condition_profile_external eddy_sb_inhibition;
-extern track_condition_profile_external neutral_section_info;
-extern track_condition_profile_external lower_pantograph_info;
-extern track_condition_profile_external air_tightness_info;
-extern bool regenerative_inhibition_stm;
-extern bool magnetic_inhibition_stm;
-extern bool eddy_eb_inhibition_stm;
-extern bool eddy_sb_inhibition_stm;
-extern bool neutral_section_stm;
-extern bool lower_pantograph_stm;
-extern bool air_tightness_stm;
-extern bool traction_cutoff_status;
-extern bool cab_active[2];
-extern int reverser_direction;
+extern EVC_STATE track_condition_profile_external regenerative_inhibition;
+extern EVC_STATE track_condition_profile_external magnetic_inhibition;
+extern EVC_STATE track_condition_profile_external eddy_eb_inhibition;
+extern EVC_STATE track_condition_profile_external eddy_sb_inhibition;
+extern EVC_STATE track_condition_profile_external neutral_section_info;
+extern EVC_STATE track_condition_profile_external lower_pantograph_info;
+extern EVC_STATE track_condition_profile_external air_tightness_info;
+extern EVC_STATE bool regenerative_inhibition_stm;
+extern EVC_STATE bool magnetic_inhibition_stm;
+extern EVC_STATE bool eddy_eb_inhibition_stm;
+extern EVC_STATE bool eddy_sb_inhibition_stm;
+extern EVC_STATE bool neutral_section_stm;
+extern EVC_STATE bool lower_pantograph_stm;
+extern EVC_STATE bool air_tightness_stm;
+extern EVC_STATE bool traction_cutoff_status;
+extern EVC_STATE bool cab_active[2];
+extern EVC_STATE int reverser_direction;
 extern optional<double> set_speed;
-extern bool additional_brake_active;
+extern EVC_STATE bool additional_brake_active;
 void update_train_interface();
\ No newline at end of file
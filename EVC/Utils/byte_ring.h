@@ -0,0 +1,109 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <vector>
+#include <cstring>
+#include <cstddef>
+/*
+ * Growable circular byte buffer. Data is appended at the back and read
+ * from the front in at most two contiguous parts, so it can be written
+ * with a single scatter/gather call and partially consumed without moving
+ * the remaining bytes. Storage is only allocated when first needed and
+ * doubles up to a maximum capacity.
+ */
+class byte_ring
+{
+    std::vector<char> buffer;
+    size_t head = 0;
+    size_t count = 0;
+    size_t max_capacity;
+    void grow(size_t needed)
+    {
+        size_t capacity = buffer.empty() ? 4096 : buffer.size();
+        while (capacity < needed)
+            capacity *= 2;
+        std::vector<char> grown(capacity);
+        const char *part[2];
+        size_t len[2];
+        size_t n = read_parts(part, len);
+        size_t pos = 0;
+        for (size_t i=0; i<n; i++) {
+            memcpy(grown.data()+pos, part[i], len[i]);
+            pos += len[i];
+        }
+        buffer.swap(grown);
+        head = 0;
+    }
+public:
+    byte_ring(size_t max_capacity) : max_capacity(max_capacity) {}
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+    /*
+     * Makes room for n more bytes. Returns false if they would exceed the
+     * maximum capacity, in which case nothing must be appended.
+     */
+    bool reserve(size_t n)
+    {
+        if (count + n > max_capacity)
+            return false;
+        if (count + n > buffer.size())
+            grow(count + n);
+        return true;
+    }
+    /*
+     * Appends bytes for which room was reserved.
+     */
+    void append(const char *data, size_t n)
+    {
+        if (n == 0)
+            return;
+        size_t cap = buffer.size();
+        size_t tail = (head + count) % cap;
+        size_t first = n < cap - tail ? n : cap - tail;
+        memcpy(buffer.data()+tail, data, first);
+        memcpy(buffer.data(), data+first, n-first);
+        count += n;
+    }
+    /*
+     * Contiguous parts holding the stored bytes, in order. Returns the
+     * number of parts, at most two. Parts stay valid until the next
+     * modification.
+     */
+    size_t read_parts(const char **part, size_t *len) const
+    {
+        if (count == 0)
+            return 0;
+        size_t cap = buffer.size();
+        size_t first = count < cap - head ? count : cap - head;
+        if (part != nullptr) {
+            part[0] = buffer.data()+head;
+            len[0] = first;
+            part[1] = buffer.data();
+            len[1] = count-first;
+        }
+        return first == count ? 1 : 2;
+    }
+    /*
+     * Drops n bytes from the front.
+     */
+    void consume(size_t n)
+    {
+        if (n >= count) {
+            clear();
+            return;
+        }
+        head = (head + n) % buffer.size();
+        count -= n;
+    }
+};
@@ -0,0 +1,186 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <cstdint>
+#include <cstddef>
+/*
+ * Fixed capacity FIFO of up to N elements with an index by key. Elements
+ * are addressed by an ever increasing sequence number, so iterators stay
+ * valid when elements are added at the back or dropped from the front.
+ * When full, adding an element drops the oldest one; callers that cannot
+ * lose elements check capacity() first.
+ *
+ * Each element links to the previous element with the same key. A lookup
+ * is then a hash probe plus a walk over the repetitions of that key,
+ * which in practice are none. Nothing is allocated after construction.
+ */
+template<typename T, size_t N, typename Key, typename KeyOf, typename Hash>
+class indexed_ring
+{
+    static_assert(N > 0 && (N & (N-1)) == 0, "indexed_ring capacity must be a power of two");
+    static const size_t slots = 4*N;
+    static const uint64_t none = UINT64_MAX;
+    struct entry
+    {
+        T value;
+        uint64_t prev_same;
+    };
+    struct slot
+    {
+        bool used;
+        Key key;
+        uint64_t seq;
+    };
+    entry items[N];
+    slot index[slots];
+    size_t used_slots = 0;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    slot &probe(const Key &key)
+    {
+        size_t i = (Hash()(key)*0x9E3779B97F4A7C15ULL >> 32) & (slots-1);
+        while (index[i].used && !(index[i].key == key))
+            i = (i+1) & (slots-1);
+        return index[i];
+    }
+    uint64_t latest(const Key &key)
+    {
+        slot &s = probe(key);
+        if (!s.used || s.seq == none || s.seq < head)
+            return none;
+        return s.seq;
+    }
+    void set_latest(const Key &key, uint64_t seq)
+    {
+        slot &s = probe(key);
+        if (!s.used) {
+            s.used = true;
+            s.key = key;
+            used_slots++;
+        }
+        s.seq = seq;
+    }
+    void rebuild()
+    {
+        // Keys of elements no longer stored only go away here
+        for (size_t i=0; i<slots; i++)
+            index[i].used = false;
+        used_slots = 0;
+        for (uint64_t seq=head; seq<tail; seq++)
+            set_latest(KeyOf()(items[seq%N].value), seq);
+    }
+public:
+    class iterator
+    {
+        indexed_ring *ring;
+        uint64_t seq;
+        friend class indexed_ring;
+        public:
+        iterator() : ring(nullptr), seq(0) {}
+        iterator(indexed_ring *ring, uint64_t seq) : ring(ring), seq(seq) {}
+        T &operator*() const { return ring->items[seq%N].value; }
+        T *operator->() const { return &ring->items[seq%N].value; }
+        iterator &operator++() { seq++; return *this; }
+        iterator &operator--() { seq--; return *this; }
+        iterator operator++(int) { iterator it = *this; seq++; return it; }
+        iterator operator--(int) { iterator it = *this; seq--; return it; }
+        bool operator==(const iterator &o) const { return seq == o.seq; }
+        bool operator!=(const iterator &o) const { return seq != o.seq; }
+        bool operator<(const iterator &o) const { return seq < o.seq; }
+    };
+    indexed_ring()
+    {
+        for (size_t i=0; i<slots; i++)
+            index[i].used = false;
+    }
+    indexed_ring(const indexed_ring &) = delete;
+    indexed_ring &operator=(const indexed_ring &) = delete;
+    iterator begin() { return iterator(this, head); }
+    iterator end() { return iterator(this, tail); }
+    static constexpr size_t capacity() { return N; }
+    size_t size() const { return tail-head; }
+    bool empty() const { return head == tail; }
+    T &front() { return items[head%N].value; }
+    T &back() { return items[(tail-1)%N].value; }
+    void clear()
+    {
+        head = tail;
+        rebuild();
+    }
+    void push_back(const T &value)
+    {
+        if (tail-head == N)
+            head++;
+        if (used_slots >= slots/2)
+            rebuild();
+        const Key &key = KeyOf()(value);
+        entry &e = items[tail%N];
+        e.value = value;
+        e.prev_same = latest(key);
+        set_latest(key, tail);
+        tail++;
+    }
+    void pop_front()
+    {
+        head++;
+    }
+    /*
+     * Drops every element before it.
+     */
+    void pop_front(iterator it)
+    {
+        if (it.seq > head)
+            head = it.seq > tail ? tail : it.seq;
+    }
+    /*
+     * Drops it and every element after it.
+     */
+    void truncate(iterator it)
+    {
+        if (it.seq < head)
+            it.seq = head;
+        while (tail > it.seq) {
+            tail--;
+            entry &e = items[tail%N];
+            set_latest(KeyOf()(e.value), e.prev_same);
+        }
+    }
+    /*
+     * Most recent element with the given key, or end().
+     */
+    iterator find_last(const Key &key)
+    {
+        uint64_t seq = latest(key);
+        return iterator(this, seq == none ? tail : seq);
+    }
+    /*
+     * Oldest element with the given key at or after from, or end().
+     */
+    iterator find_first(const Key &key, iterator from)
+    {
+        uint64_t found = tail;
+        for (uint64_t seq = latest(key); seq != none && seq >= head && seq >= from.seq; seq = items[seq%N].prev_same)
+            found = seq;
+        return iterator(this, found);
+    }
+    iterator find_first(const Key &key)
+    {
+        return find_first(key, begin());
+    }
+    /*
+     * Previous element with the same key as it, or end().
+     */
+    iterator find_previous(iterator it)
+    {
+        uint64_t seq = items[it.seq%N].prev_same;
+        if (seq == none || seq < head)
+            return end();
+        return iterator(this, seq);
+    }
+};
@@ -0,0 +1,97 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "parallel.h"
+#include "../Position/distance.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#ifndef EVC_MULTI_TRAIN
+// Below this size waking the helpers costs more than the work itself
+static const int min_parallel = 4;
+static const int max_helpers = 3;
+struct parallel_pool
+{
+    std::mutex mtx;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    const std::function<void(int)> *job = nullptr;
+    int size = 0;
+    std::atomic<int> next{0};
+    int generation = 0;
+    int helpers = 0;
+    int active = 0;
+    void work()
+    {
+        for (;;) {
+            int i = next.fetch_add(1);
+            if (i >= size)
+                break;
+            (*job)(i);
+        }
+    }
+    void helper()
+    {
+        distance::disable_registration();
+        int seen = 0;
+        std::unique_lock<std::mutex> lck(mtx);
+        for (;;) {
+            start_cv.wait(lck, [&]{return generation != seen;});
+            seen = generation;
+            lck.unlock();
+            work();
+            lck.lock();
+            if (--active == 0)
+                done_cv.notify_one();
+        }
+    }
+};
+static parallel_pool *get_pool()
+{
+    // Never destroyed: helpers stay blocked until the process exits
+    static parallel_pool *pool = []() {
+        parallel_pool *p = new parallel_pool();
+        int hw = std::thread::hardware_concurrency();
+        p->helpers = std::max(std::min(hw-1, max_helpers), 0);
+        for (int i=0; i<p->helpers; i++)
+            std::thread(&parallel_pool::helper, p).detach();
+        return p;
+    }();
+    return pool;
+}
+void parallel_for(int n, const std::function<void(int)> &f)
+{
+    parallel_pool *pool = n >= min_parallel ? get_pool() : nullptr;
+    if (pool == nullptr || pool->helpers == 0) {
+        for (int i=0; i<n; i++)
+            f(i);
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lck(pool->mtx);
+        pool->job = &f;
+        pool->size = n;
+        pool->next = 0;
+        pool->active = pool->helpers;
+        pool->generation++;
+    }
+    pool->start_cv.notify_all();
+    pool->work();
+    std::unique_lock<std::mutex> lck(pool->mtx);
+    pool->done_cv.wait(lck, [pool]{return pool->active == 0;});
+    pool->job = nullptr;
+}
+#else
+void parallel_for(int n, const std::function<void(int)> &f)
+{
+    for (int i=0; i<n; i++)
+        f(i);
+}
+#endif
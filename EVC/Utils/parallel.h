@@ -0,0 +1,23 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <functional>
+/*
+ * Calls f(i) for every i in [0, n) and returns when all calls have
+ * finished. Calls are shared between the calling thread and a small pool
+ * of persistent threads, so f must only write to data owned by index i.
+ * Results therefore do not depend on the number of threads.
+ *
+ * Helper threads do not register distances for relocation, so any
+ * distance created inside f must be destroyed before f returns.
+ *
+ * In multi-train builds the state of a train is only visible from its own
+ * thread, so everything runs sequentially on the calling thread.
+ */
+void parallel_for(int n, const std::function<void(int)> &f);
@@ -0,0 +1,123 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+/*
+ * Track description elements, kept contiguous and sorted by position.
+ * Dropping the elements behind the train only moves the start index, and
+ * the storage is compacted once the dropped part outgrows the live one.
+ * New data replaces everything from a position onwards after a binary
+ * search. Iterators are invalidated by any modification.
+ */
+template<typename T, typename Less = std::less<T>>
+class position_ring
+{
+    std::vector<T> items;
+    size_t first = 0;
+    void compact()
+    {
+        if (first == items.size()) {
+            items.clear();
+            first = 0;
+        } else if (first > 16 && first*2 > items.size()) {
+            items.erase(items.begin(), items.begin()+first);
+            first = 0;
+        }
+    }
+public:
+    typedef typename std::vector<T>::iterator iterator;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    iterator begin() { return items.begin()+first; }
+    iterator end() { return items.end(); }
+    const_iterator begin() const { return items.begin()+first; }
+    const_iterator end() const { return items.end(); }
+    bool empty() const { return first == items.size(); }
+    size_t size() const { return items.size()-first; }
+    T &front() { return items[first]; }
+    T &back() { return items.back(); }
+    const T &front() const { return items[first]; }
+    const T &back() const { return items.back(); }
+    void clear()
+    {
+        items.clear();
+        first = 0;
+    }
+    template<typename K>
+    iterator lower_bound(const K &k) { return std::lower_bound(begin(), end(), k, Less()); }
+    template<typename K>
+    iterator upper_bound(const K &k) { return std::upper_bound(begin(), end(), k, Less()); }
+    template<typename K>
+    const_iterator lower_bound(const K &k) const { return std::lower_bound(begin(), end(), k, Less()); }
+    template<typename K>
+    const_iterator upper_bound(const K &k) const { return std::upper_bound(begin(), end(), k, Less()); }
+    /*
+     * Drops every element before it.
+     */
+    void pop_front(iterator it)
+    {
+        first = it-items.begin();
+        compact();
+    }
+    /*
+     * Drops it and every element after it.
+     */
+    void truncate(iterator it)
+    {
+        items.erase(it, items.end());
+        compact();
+    }
+    iterator erase(iterator it)
+    {
+        if (it == begin()) {
+            first++;
+            compact();
+            return begin();
+        }
+        return items.erase(it);
+    }
+    template<typename Pred>
+    void remove_if(Pred pred)
+    {
+        items.erase(std::remove_if(begin(), end(), pred), items.end());
+        compact();
+    }
+    /*
+     * Appends an element, which must not be lower than the last one.
+     */
+    void push_back(T value)
+    {
+        items.push_back(std::move(value));
+    }
+    /*
+     * Inserts an element after all those that are not greater.
+     */
+    iterator insert(T value)
+    {
+        auto it = std::upper_bound(begin(), end(), value, Less());
+        size_t index = it-items.begin();
+        items.insert(it, std::move(value));
+        return items.begin()+index;
+    }
+};
+/*
+ * Ordering of (position, value) pairs by position only, which allows
+ * looking them up by position.
+ */
+struct position_key_less
+{
+    template<typename K, typename V>
+    bool operator()(const std::pair<K,V> &a, const std::pair<K,V> &b) const { return a.first < b.first; }
+    template<typename K, typename V>
+    bool operator()(const std::pair<K,V> &a, const K &b) const { return a.first < b; }
+    template<typename K, typename V>
+    bool operator()(const K &a, const std::pair<K,V> &b) const { return a < b.first; }
+};
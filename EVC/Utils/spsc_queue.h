@@ -0,0 +1,72 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+/*
+ * Bounded lock-free queue for exactly one producer thread and one consumer
+ * thread. N must be a power of two.
+ */
+template<typename T, std::size_t N>
+class spsc_queue
+{
+    static_assert(N > 0 && (N & (N-1)) == 0, "spsc_queue capacity must be a power of two");
+    T buffer[N];
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+    template<typename U>
+    bool store(U &&value)
+    {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+            return false;
+        buffer[t & (N-1)] = std::forward<U>(value);
+        tail.store(t+1, std::memory_order_release);
+        return true;
+    }
+    public:
+    // The value is only moved from if it was queued, so a full queue can
+    // be retried with the same value
+    bool push(const T &value)
+    {
+        return store(value);
+    }
+    bool push(T &&value)
+    {
+        return store(std::move(value));
+    }
+    bool pop(T &value)
+    {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        value = std::move(buffer[h & (N-1)]);
+        buffer[h & (N-1)] = T();
+        head.store(h+1, std::memory_order_release);
+        return true;
+    }
+    bool full() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire) == N;
+    }
+    bool empty() const
+    {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+    std::size_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    void clear()
+    {
+        T value;
+        while (pop(value));
+    }
+};
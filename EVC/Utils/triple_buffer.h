@@ -0,0 +1,45 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <atomic>
+/*
+ * Lock-free hand over of the latest value from one writer thread to one
+ * reader thread. The writer fills write_buffer() and publishes it; the
+ * reader picks up the newest published value with update(). Neither side
+ * ever waits, and values published in between are skipped.
+ */
+template<typename T>
+class triple_buffer
+{
+    static const int fresh = 4;
+    T buffers[3];
+    int back = 0;
+    alignas(64) std::atomic<int> middle{1};
+    alignas(64) int front = 2;
+    public:
+    T &write_buffer()
+    {
+        return buffers[back];
+    }
+    void publish()
+    {
+        back = middle.exchange(back | fresh, std::memory_order_acq_rel) & 3;
+    }
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & fresh))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+    const T &read_buffer() const
+    {
+        return buffers[front];
+    }
+};
@@ -9,7 +9,8 @@
 #include "version.h"
 #include "../Supervision/supervision.h"
 #include "../Euroradio/session.h"
-int operated_version=33;
+#include "../Context/state.h"
+EVC_STATE int operated_version=33;
 std::set<int> supported_versions = {33, 17};
 bool is_version_supported(int version)
 {
@@ -6,4 +6,5 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
-double L_antenna_front=0; 
+#include "Context/state.h"
+EVC_STATE double L_antenna_front=0; 
@@ -8,6 +8,7 @@
  */
 #ifndef _ANTENNA_H
 #define _ANTENNA_H
-extern double L_antenna_front;
+#include "Context/state.h"
+extern EVC_STATE double L_antenna_front;
 void start_antenna_read();
 #endif
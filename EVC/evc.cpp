@@ -29,13 +29,13 @@
 #include "Supervision/conversion_model.h"
 #include "OR_interface/interface.h"
 #include "MA/movement_authority.h"
-#include "Procedures/procedures.h"
 #include "NationalFN/nationalfn.h"
 #include "TrackConditions/track_condition.h"
-#include "TrainSubsystems/subsystems.h"
 #include "LX/level_crossing.h"
 #include "STM/stm.h"
 #include "language/language.h"
+#include "Context/context.h"
+#include "OR_interface/shm_bridge.h"
 
 #include <signal.h>
 #ifdef __ANDROID__
@@ -162,8 +162,6 @@ void crash_handler(int sig)
 #endif
 
 
-std::mutex loop_mtx;
-std::condition_variable loop_notifier;
 void loop();
 void start();
 bool run;
@@ -201,48 +199,25 @@ extern "C" void Java_com_etcs_dmi_EVC_evcStop(JNIEnv *env, jobject thiz)
     run = false;
 }
 #endif
-bool started=false;
-int cold_movement_status;
 void start()
 {
-    cold_movement_status = ColdMovementUnknown;
     start_dmi();
     start_or_iface();
+    start_shm_bridge();
     start_logging();
     load_language();
-    setup_national_values();
-    load_vbcs();
-    initialize_mode_transitions();
-    setup_stm_control();
-    set_message_filters();
-    initialize_national_functions();
-    started = true;
+    initialize_evc();
 }
-void update()
-{
-    update_odometer();
-    update_geographical_position();
-    update_track_comm();
-    update_national_values();
-    update_procedures();
-    update_stm_control();
-    update_supervision();
-    update_lx();
-    update_track_conditions();
-    update_messages();
-    update_national_functions();
-    update_train_subsystems();
-    update_dmi_windows();
-    update_track_ahead_free_request();
-}
-std::condition_variable evc_cv;
 void loop()
 {
     while(run)
     {
+        update_shm_inputs();
         std::unique_lock<std::mutex> lck(loop_mtx);
         auto prev = std::chrono::system_clock::now();
         update();
+        publish_or_outputs();
+        publish_shm_outputs();
         std::chrono::duration<double> diff = std::chrono::system_clock::now() - prev;
         int d = std::chrono::duration_cast<std::chrono::duration<int, std::micro>>(diff).count();
         /*if (d>500) std::cout<<d<<std::endl;*/
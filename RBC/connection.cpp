@@ -0,0 +1,201 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "connection.h"
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+int64_t rbc_clock()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+void set_packet_length(ETCS_packet &p)
+{
+    bit_manipulator w;
+    p.write_to(w);
+}
+static bool would_block()
+{
+#ifdef _WIN32
+    int err = WSAGetLastError();
+    return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == EINTR;
+#endif
+}
+static void set_nonblocking(int fd)
+{
+#ifdef _WIN32
+    u_long nonblock = 1;
+    ioctlsocket(fd, FIONBIO, &nonblock);
+#else
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char*)&nodelay, sizeof(nodelay));
+}
+void rbc_socket_init()
+{
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2,2), &wsa);
+#endif
+}
+int rbc_listen(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char*)&reuse, sizeof(reuse));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        rbc_connection(fd).close();
+        return -1;
+    }
+    if (listen(fd, 1024) < 0) {
+        perror("listen");
+        rbc_connection(fd).close();
+        return -1;
+    }
+    set_nonblocking(fd);
+    return fd;
+}
+int rbc_accept(int listen_fd)
+{
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0)
+        return -1;
+    set_nonblocking(fd);
+    return fd;
+}
+int rbc_connect(const std::string &host, int port)
+{
+    struct hostent *server = gethostbyname(host.c_str());
+    if (server == nullptr)
+        return -1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    set_nonblocking(fd);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    memcpy(&addr.sin_addr.s_addr, server->h_addr, server->h_length);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 && !would_block()) {
+        perror("connect");
+        rbc_connection(fd).close();
+        return -1;
+    }
+    return fd;
+}
+bool rbc_connect_finished(int fd)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+    return getsockopt(fd, SOL_SOCKET, SO_ERROR, (char*)&err, &len) == 0 && err == 0;
+}
+int rbc_poll(std::vector<struct pollfd> &fds, int timeout)
+{
+#ifdef _WIN32
+    return WSAPoll(fds.data(), fds.size(), timeout);
+#else
+    return poll(fds.data(), fds.size(), timeout);
+#endif
+}
+bool rbc_connection::receive()
+{
+    unsigned char buff[4096];
+    for (;;) {
+        int result = recv(fd, (char*)buff, sizeof(buff), 0);
+        if (result == 0 || (result < 0 && !would_block()))
+            return false;
+        if (result < 0)
+            return true;
+        bytes_received += result;
+        rx.insert(rx.end(), buff, buff + result);
+        if (result < (int)sizeof(buff))
+            return true;
+    }
+}
+bool rbc_connection::next_frame(std::vector<unsigned char> &frame)
+{
+    if (rx.size() - rx_start < 3) {
+        rx.erase(rx.begin(), rx.begin() + rx_start);
+        rx_start = 0;
+        return false;
+    }
+    const unsigned char *head = rx.data() + rx_start;
+    size_t size = (head[1]<<2)|(head[2]>>6);
+    if (size < 3 || rx.size() - rx_start < size) {
+        rx.erase(rx.begin(), rx.begin() + rx_start);
+        rx_start = 0;
+        return false;
+    }
+    frame.assign(head, head + size);
+    rx_start += size;
+    return true;
+}
+void rbc_connection::send(ETCS_message &msg)
+{
+    writer.bits.clear();
+    writer.log_entries.clear();
+    writer.position = 0;
+    msg.write_to(writer);
+    tx.insert(tx.end(), writer.bits.begin(), writer.bits.end());
+}
+bool rbc_connection::flush()
+{
+    while (tx_start < tx.size()) {
+#ifdef MSG_NOSIGNAL
+        int result = ::send(fd, (char*)tx.data() + tx_start, tx.size() - tx_start, MSG_NOSIGNAL);
+#else
+        int result = ::send(fd, (char*)tx.data() + tx_start, tx.size() - tx_start, 0);
+#endif
+        if (result < 0)
+            return would_block();
+        bytes_sent += result;
+        tx_start += result;
+    }
+    tx.clear();
+    tx_start = 0;
+    return true;
+}
+void rbc_connection::close()
+{
+    if (fd < 0)
+        return;
+#ifdef _WIN32
+    shutdown(fd, SD_BOTH);
+    closesocket(fd);
+#else
+    shutdown(fd, SHUT_RDWR);
+    ::close(fd);
+#endif
+    fd = -1;
+}
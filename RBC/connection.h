@@ -0,0 +1,56 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "../EVC/Packets/radio.h"
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+/*
+ * Non-blocking socket carrying Euroradio messages with the same framing
+ * as the EVC mobile terminal: each message is sent as is and delimited
+ * by the L_MESSAGE field of its 3-byte header.
+ */
+struct rbc_connection
+{
+    int fd;
+    std::vector<unsigned char> rx;
+    size_t rx_start = 0;
+    std::vector<unsigned char> tx;
+    size_t tx_start = 0;
+    bit_manipulator writer;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    rbc_connection(int fd) : fd(fd) {}
+    bool receive();
+    bool next_frame(std::vector<unsigned char> &frame);
+    void send(ETCS_message &msg);
+    bool flush();
+    bool pending_output() const
+    {
+        return tx_start < tx.size();
+    }
+    void close();
+};
+/*
+ * Mandatory packets are written through the message copy() rather than
+ * write_to(), so their length has to be computed beforehand.
+ */
+void set_packet_length(ETCS_packet &p);
+int64_t rbc_clock();
+void rbc_socket_init();
+int rbc_listen(int port);
+int rbc_accept(int listen_fd);
+int rbc_connect(const std::string &host, int port);
+bool rbc_connect_finished(int fd);
+int rbc_poll(std::vector<struct pollfd> &fds, int timeout);
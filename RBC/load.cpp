@@ -0,0 +1,275 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "load.h"
+#include "connection.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+struct latency_stats
+{
+    const char *name;
+    std::vector<int64_t> samples;
+    int timeouts = 0;
+    latency_stats(const char *name) : name(name) {}
+    void print()
+    {
+        if (samples.empty()) {
+            printf("%-16s %8d %8d\n", name, 0, timeouts);
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (int64_t s : samples)
+            sum += s;
+        auto percentile = [this](double p) {
+            return samples[std::min(samples.size()-1, (size_t)(p*samples.size()))]/1000.0;
+        };
+        printf("%-16s %8zu %8d %9.3f %9.3f %9.3f %9.3f %9.3f\n", name, samples.size(), timeouts,
+            samples.front()/1000.0, sum/samples.size()/1000.0, percentile(0.5), percentile(0.99), samples.back()/1000.0);
+    }
+};
+enum struct sim_phase
+{
+    Connecting,
+    Session,
+    TrainData,
+    StartOfMission,
+    Running,
+    Failed,
+};
+struct simulated_train
+{
+    int id;
+    rbc_connection conn;
+    sim_phase phase = sim_phase::Connecting;
+    int expected = -1;
+    int64_t request_time;
+    latency_stats *request_stats = nullptr;
+    int64_t start_time;
+    int64_t next_report;
+    bool ma_request_next = false;
+    uint32_t last_t_train = 0;
+    simulated_train(int id, int fd) : id(id), conn(fd) {}
+};
+static uint64_t messages_sent = 0;
+static uint64_t messages_received = 0;
+static void fill_message(simulated_train &t, euroradio_message_traintotrack &msg, bool position)
+{
+    int64_t now = rbc_clock();
+    msg.NID_ENGINE.rawdata = t.id+1;
+    uint32_t timestamp = now/10000;
+    if (timestamp <= t.last_t_train)
+        timestamp = t.last_t_train+1;
+    msg.T_TRAIN.rawdata = t.last_t_train = timestamp;
+    if (!position)
+        return;
+    auto r = std::make_shared<PositionReport>();
+    double speed = 20 + t.id%10;
+    double d = std::min(32766.0, speed*(now-t.start_time)/1e6);
+    r->NID_PACKET.rawdata = 0;
+    r->Q_SCALE = Q_SCALE_t::m1;
+    r->NID_LRBG.set_value({1, t.id%16383+1});
+    r->D_LRBG.set_value(d, r->Q_SCALE);
+    r->Q_DIRLRBG = Q_DIRLRBG_t::Nominal;
+    r->Q_DLRBG.rawdata = Q_DLRBG_t::Nominal;
+    r->L_DOUBTOVER.set_value(5 + d/100, r->Q_SCALE);
+    r->L_DOUBTUNDER.set_value(5 + d/100, r->Q_SCALE);
+    r->Q_LENGTH = Q_LENGTH_t::NoTrainIntegrityAvailable;
+    r->V_TRAIN.rawdata = speed*3.6/5;
+    r->Q_DIRTRAIN.rawdata = Q_DIRTRAIN_t::Nominal;
+    r->M_MODE.rawdata = 0;
+    r->M_LEVEL.set_value(Level::N2);
+    msg.PositionReport1BG = r;
+}
+static void send_request(simulated_train &t, euroradio_message_traintotrack &msg, int expected, latency_stats *stats)
+{
+    t.conn.send(msg);
+    messages_sent++;
+    t.expected = expected;
+    t.request_stats = stats;
+    t.request_time = rbc_clock();
+}
+static void send_train_data(simulated_train &t, latency_stats *stats)
+{
+    validated_train_data_message msg;
+    fill_message(t, msg, true);
+    auto &data = *msg.TrainData;
+    data.NC_CDTRAIN.rawdata = 0;
+    data.NC_TRAIN.rawdata = 0;
+    data.L_TRAIN.rawdata = 200;
+    data.V_MAXTRAIN.rawdata = 32;
+    data.M_LOADINGGAUGE.rawdata = 0;
+    data.M_AXLELOADCAT.rawdata = 0;
+    data.M_AIRTIGHT.rawdata = 0;
+    data.N_AXLE.rawdata = 40;
+    data.N_ITERtraction.rawdata = 0;
+    data.N_ITERntc.rawdata = 0;
+    set_packet_length(data);
+    send_request(t, msg, 8, stats);
+}
+static void send_ma_request(simulated_train &t, bool start, latency_stats *stats)
+{
+    MA_request msg;
+    fill_message(t, msg, true);
+    msg.Q_MARQSTREASON.rawdata = 1<<(start ? Q_MARQSTREASON_t::StartSelectedByDriverBit : Q_MARQSTREASON_t::TimeBeforePerturbationBit);
+    send_request(t, msg, 3, stats);
+}
+int run_load(const load_options &options)
+{
+    latency_stats session("session");
+    latency_stats train_data("train data");
+    latency_stats som("start of mission");
+    latency_stats ma("ma request");
+    latency_stats report("position report");
+    std::vector<std::unique_ptr<simulated_train>> trains;
+    int64_t start = rbc_clock();
+    for (int i=0; i<options.trains; i++) {
+        int fd = rbc_connect(options.address, options.port);
+        if (fd < 0) {
+            fprintf(stderr, "Cannot connect to %s:%d\n", options.address.c_str(), options.port);
+            return 1;
+        }
+        auto t = std::make_unique<simulated_train>(i, fd);
+        t->start_time = t->request_time = rbc_clock();
+        t->request_stats = &session;
+        trains.push_back(std::move(t));
+    }
+    int64_t end = start + (int64_t)(options.duration*1000000);
+    std::vector<struct pollfd> fds;
+    std::vector<unsigned char> frame;
+    int64_t now = start;
+    while (now < end) {
+        fds.clear();
+        for (auto &t : trains) {
+            short events = 0;
+            if (t->phase == sim_phase::Connecting)
+                events = POLLOUT;
+            else if (t->phase != sim_phase::Failed)
+                events = POLLIN | (t->conn.pending_output() ? POLLOUT : 0);
+            fds.push_back({(decltype(pollfd::fd))t->conn.fd, events, 0});
+        }
+        rbc_poll(fds, 5);
+        now = rbc_clock();
+        for (size_t i=0; i<trains.size(); i++) {
+            simulated_train &t = *trains[i];
+            short revents = fds[i].revents;
+            if (t.phase == sim_phase::Failed)
+                continue;
+            if (t.phase == sim_phase::Connecting) {
+                if (revents & (POLLOUT | POLLERR | POLLHUP)) {
+                    if (rbc_connect_finished(t.conn.fd)) {
+                        init_communication_session init;
+                        fill_message(t, init, false);
+                        t.conn.send(init);
+                        messages_sent++;
+                        t.expected = 32;
+                        t.phase = sim_phase::Session;
+                    } else {
+                        t.phase = sim_phase::Failed;
+                    }
+                }
+            } else if ((revents & (POLLIN | POLLERR | POLLHUP)) && !t.conn.receive()) {
+                t.phase = sim_phase::Failed;
+            }
+            while (t.phase != sim_phase::Failed && t.conn.next_frame(frame)) {
+                bit_manipulator r(std::move(frame));
+                auto msg = euroradio_message::build(r, 33);
+                messages_received++;
+                if (msg->M_ACK == M_ACK_t::AcknowledgementRequired) {
+                    acknowledgement_message ack;
+                    fill_message(t, ack, false);
+                    ack.T_TRAINack = msg->T_TRAIN;
+                    t.conn.send(ack);
+                    messages_sent++;
+                }
+                int nid = msg->NID_MESSAGE;
+                if (nid == 40) {
+                    t.phase = sim_phase::Failed;
+                    break;
+                }
+                if (nid != t.expected)
+                    continue;
+                t.request_stats->samples.push_back(now - t.request_time);
+                t.expected = -1;
+                if (t.phase == sim_phase::Session) {
+                    communication_session_established established;
+                    established.SupportedVersions->M_VERSION.rawdata = 33;
+                    established.SupportedVersions->N_ITER.rawdata = 0;
+                    established.optional_packets.push_back(established.SupportedVersions);
+                    fill_message(t, established, false);
+                    t.conn.send(established);
+                    messages_sent++;
+                    send_train_data(t, &train_data);
+                    t.phase = sim_phase::TrainData;
+                } else if (t.phase == sim_phase::TrainData) {
+                    SoM_position_report msg;
+                    fill_message(t, msg, true);
+                    msg.Q_STATUS.rawdata = Q_STATUS_t::Valid;
+                    send_request(t, msg, 41, &som);
+                    t.phase = sim_phase::StartOfMission;
+                } else if (t.phase == sim_phase::StartOfMission) {
+                    send_ma_request(t, true, &ma);
+                    t.phase = sim_phase::Running;
+                    t.next_report = now + options.report_interval*1000*(i+1)/trains.size();
+                }
+            }
+            if (t.phase == sim_phase::Failed)
+                continue;
+            if (t.expected >= 0 && now - t.request_time > options.timeout*1000) {
+                t.request_stats->timeouts++;
+                t.expected = -1;
+                if (t.phase != sim_phase::Running) {
+                    t.phase = sim_phase::Failed;
+                    continue;
+                }
+            }
+            if (t.phase == sim_phase::Running && t.expected < 0 && now >= t.next_report) {
+                if (t.ma_request_next) {
+                    send_ma_request(t, false, &ma);
+                } else {
+                    position_report msg;
+                    fill_message(t, msg, true);
+                    if (options.report_reply) {
+                        send_request(t, msg, 3, &report);
+                    } else {
+                        t.conn.send(msg);
+                        messages_sent++;
+                    }
+                }
+                t.ma_request_next = !t.ma_request_next;
+                t.next_report += options.report_interval*1000;
+            }
+            if (!t.conn.flush())
+                t.phase = sim_phase::Failed;
+        }
+    }
+    double elapsed = (now-start)/1e6;
+    int failed = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    for (auto &t : trains) {
+        if (t->phase != sim_phase::Running)
+            failed++;
+        bytes_sent += t->conn.bytes_sent;
+        bytes_received += t->conn.bytes_received;
+        t->conn.close();
+    }
+    printf("%d trains, %d not running after %.1f s\n", options.trains, failed, elapsed);
+    printf("sent %llu messages (%.1f/s, %llu bytes), received %llu messages (%.1f/s, %llu bytes)\n",
+        (unsigned long long)messages_sent, messages_sent/elapsed, (unsigned long long)bytes_sent,
+        (unsigned long long)messages_received, messages_received/elapsed, (unsigned long long)bytes_received);
+    printf("%-16s %8s %8s %9s %9s %9s %9s %9s\n", "exchange", "count", "timeout", "min ms", "avg ms", "p50 ms", "p99 ms", "max ms");
+    session.print();
+    train_data.print();
+    som.print();
+    ma.print();
+    if (options.report_reply)
+        report.print();
+    return failed > 0 ? 2 : 0;
+}
@@ -0,0 +1,28 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <string>
+#include <cstdint>
+struct load_options
+{
+    std::string address = "127.0.0.1";
+    int port = 5015;
+    int trains = 100;
+    double duration = 30;
+    int64_t report_interval = 1000;
+    int64_t timeout = 5000;
+    // Whether the RBC answers every position report with an MA. Otherwise
+    // position reports are sent without measuring their latency.
+    bool report_reply = true;
+};
+/*
+ * Drives many simulated trains against an RBC from a single thread and
+ * reports throughput and round trip latency per exchange.
+ */
+int run_load(const load_options &options);
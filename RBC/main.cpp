@@ -0,0 +1,105 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "server.h"
+#include "load.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <thread>
+/*
+ * Usage:
+ *   rbc [--port 5015] [--scenario scenario.json] [--quiet]
+ *       Serves trains on the given port following the scenario.
+ *   rbc --load 300 [--connect host:port [--report-reply]] [--duration 30] [--interval 1000]
+ *       Runs the given number of simulated trains. Without --connect an
+ *       internal RBC extending MAs on every position report is started,
+ *       whatever the scenario says. An external RBC only has its position
+ *       report latency measured with --report-reply, which states that it
+ *       answers every position report with an MA.
+ */
+std::set<int> supported_versions = {33, 17};
+static void usage()
+{
+    fprintf(stderr, "usage: rbc [--port P] [--scenario FILE] [--quiet]\n"
+        "       rbc --load N [--connect HOST:PORT [--report-reply]] [--port P] [--scenario FILE] [--duration S] [--interval MS]\n");
+}
+int main(int argc, char *argv[])
+{
+    int port = 5015;
+    std::string scenario_file;
+    bool verbose = true;
+    int load = 0;
+    std::string connect;
+    bool report_reply = false;
+    load_options options;
+    for (int i=1; i<argc; i++) {
+        bool has_value = i+1 < argc;
+        if (!strcmp(argv[i], "--port") && has_value) {
+            port = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--scenario") && has_value) {
+            scenario_file = argv[++i];
+        } else if (!strcmp(argv[i], "--quiet")) {
+            verbose = false;
+        } else if (!strcmp(argv[i], "--load") && has_value) {
+            load = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--connect") && has_value) {
+            connect = argv[++i];
+        } else if (!strcmp(argv[i], "--report-reply")) {
+            report_reply = true;
+        } else if (!strcmp(argv[i], "--duration") && has_value) {
+            options.duration = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--interval") && has_value) {
+            options.report_interval = atoi(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    rbc_socket_init();
+    rbc_scenario scenario;
+    if (!scenario_file.empty())
+        scenario = load_scenario(scenario_file);
+    // Position report latency is timed against the MA sent in reply
+    if (load > 0)
+        scenario.extend_on_report = true;
+    std::atomic<bool> stop(false);
+    if (load <= 0) {
+        rbc_server server(scenario, port, verbose);
+        if (server.listen_fd < 0)
+            return 1;
+        server.run(stop);
+        return 0;
+    }
+    options.trains = load;
+    options.port = port;
+    std::unique_ptr<rbc_server> server;
+    std::thread thr;
+    if (connect.empty()) {
+        server = std::make_unique<rbc_server>(scenario, port, false);
+        if (server->listen_fd < 0)
+            return 1;
+        thr = std::thread([&server, &stop]() {
+            server->run(stop);
+        });
+    } else {
+        size_t colon = connect.find(':');
+        options.address = connect.substr(0, colon);
+        if (colon != std::string::npos)
+            options.port = atoi(connect.substr(colon+1).c_str());
+        options.report_reply = report_reply;
+    }
+    int result = run_load(options);
+    if (server != nullptr) {
+        stop = true;
+        thr.join();
+        printf("internal rbc: %llu messages received, %llu sent\n", (unsigned long long)server->messages_received, (unsigned long long)server->messages_sent);
+    }
+    return result;
+}
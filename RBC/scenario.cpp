@@ -0,0 +1,101 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "scenario.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <algorithm>
+using json = nlohmann::json;
+static tsr_element load_tsr(json &j)
+{
+    tsr_element tsr;
+    tsr.id = j.value("id", 0);
+    tsr.distance = j["distance"];
+    tsr.length = j["length"];
+    tsr.speed = j["speed"];
+    tsr.front = j.value("front", true);
+    return tsr;
+}
+static handover_order load_handover(json &j)
+{
+    handover_order h;
+    h.distance = j["distance"];
+    h.nid_c = j.value("nid_c", 0);
+    h.nid_rbc = j.value("nid_rbc", 1);
+    h.address = j.value("address", "127.0.0.1");
+    h.port = j.value("port", 5015);
+    return h;
+}
+rbc_scenario load_scenario(const std::string &path)
+{
+    rbc_scenario s;
+    std::ifstream file(path);
+    json j;
+    file >> j;
+    s.version = j.value("version", s.version);
+    s.accept_train = j.value("accept_train", s.accept_train);
+    if (j.contains("ma")) {
+        json &ma = j["ma"];
+        s.ma_end = ma.value("end", s.ma_end);
+        s.ma_length = ma.value("length", s.ma_length);
+        s.extend_on_report = ma.value("extend_on_report", s.extend_on_report);
+        s.v_ema = ma.value("v_ema", s.v_ema);
+        s.ack_ma = ma.value("acknowledge", s.ack_ma);
+    }
+    if (j.contains("ssp")) {
+        s.ssp.clear();
+        for (json &e : j["ssp"])
+            s.ssp.push_back({e["distance"], e["speed"]});
+    }
+    if (j.contains("gradient")) {
+        s.gradients.clear();
+        for (json &e : j["gradient"])
+            s.gradients.push_back({e["distance"], e["value"]});
+    }
+    if (j.contains("tsr")) {
+        for (json &e : j["tsr"])
+            s.tsrs.push_back(load_tsr(e));
+    }
+    if (j.contains("events")) {
+        for (json &e : j["events"]) {
+            scenario_event ev;
+            ev.time = (int64_t)(e.value("time", 0.0)*1000000);
+            std::string type = e["type"];
+            if (type == "ma") {
+                ev.type = scenario_event_type::MovementAuthority;
+                ev.ma_end = e["end"];
+            } else if (type == "tsr") {
+                ev.type = scenario_event_type::TemporarySpeedRestriction;
+                ev.tsr = load_tsr(e);
+            } else if (type == "handover") {
+                ev.type = scenario_event_type::Handover;
+                ev.handover = load_handover(e);
+            } else if (type == "emergency_stop") {
+                ev.type = scenario_event_type::EmergencyStop;
+                ev.nid_em = e.value("id", 0);
+            } else if (type == "revoke_emergency_stop") {
+                ev.type = scenario_event_type::EmergencyStopRevocation;
+                ev.nid_em = e.value("id", 0);
+            } else {
+                continue;
+            }
+            s.events.push_back(ev);
+        }
+        std::stable_sort(s.events.begin(), s.events.end(), [](const scenario_event &a, const scenario_event &b) {
+            return a.time < b.time;
+        });
+    }
+    if (j.contains("handover")) {
+        scenario_event ev;
+        ev.type = scenario_event_type::Handover;
+        ev.time = 0;
+        ev.handover = load_handover(j["handover"]);
+        s.events.insert(s.events.begin(), ev);
+    }
+    return s;
+}
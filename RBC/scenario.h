@@ -0,0 +1,75 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+/*
+ * Scripted trackside behaviour. All distances are in metres along the
+ * track, measured from the first balise group reported by each train,
+ * and speeds are in km/h.
+ */
+struct speed_element
+{
+    double distance;
+    double speed;
+};
+struct gradient_element
+{
+    double distance;
+    int gradient;
+};
+struct tsr_element
+{
+    int id;
+    double distance;
+    double length;
+    double speed;
+    bool front;
+};
+struct handover_order
+{
+    double distance;
+    int nid_c;
+    int nid_rbc;
+    std::string address;
+    int port;
+};
+enum struct scenario_event_type
+{
+    MovementAuthority,
+    TemporarySpeedRestriction,
+    Handover,
+    EmergencyStop,
+    EmergencyStopRevocation,
+};
+struct scenario_event
+{
+    scenario_event_type type;
+    int64_t time;
+    double ma_end;
+    tsr_element tsr;
+    handover_order handover;
+    int nid_em;
+};
+struct rbc_scenario
+{
+    int version = 33;
+    bool accept_train = true;
+    bool ack_ma = false;
+    double ma_end = 2000;
+    double ma_length = 2000;
+    bool extend_on_report = false;
+    double v_ema = 0;
+    std::vector<speed_element> ssp = {{0, 160}};
+    std::vector<gradient_element> gradients = {{0, 0}};
+    std::vector<tsr_element> tsrs;
+    std::vector<scenario_event> events;
+};
+rbc_scenario load_scenario(const std::string &path);
@@ -0,0 +1,372 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#include "server.h"
+#include "../EVC/Packets/21.h"
+#include "../EVC/Packets/27.h"
+#include "../EVC/Packets/65.h"
+#include "../EVC/Packets/131.h"
+#ifndef _WIN32
+#include <arpa/inet.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+static int speed_value(double kmh)
+{
+    return std::max(0, std::min(120, (int)std::round(kmh/5)));
+}
+static uint32_t distance_scale(double max_distance)
+{
+    return max_distance > 32767 ? Q_SCALE_t::m10 : Q_SCALE_t::m1;
+}
+static uint32_t distance_value(double d, uint32_t scale)
+{
+    if (scale == Q_SCALE_t::m10)
+        d /= 10;
+    return std::max(0, std::min(32767, (int)std::round(d)));
+}
+static std::shared_ptr<InternationalSSP> build_ssp(const std::vector<speed_element> &ssp, double ref, double end, uint32_t q_dir)
+{
+    auto p = std::make_shared<InternationalSSP>();
+    p->NID_PACKET.rawdata = 27;
+    p->Q_DIR.rawdata = q_dir;
+    p->Q_SCALE.rawdata = distance_scale(end-ref);
+    std::vector<SSP_element_packet> elements;
+    double prev = ref;
+    for (size_t i=0; i<ssp.size(); i++) {
+        if (i+1 < ssp.size() && ssp[i+1].distance <= ref)
+            continue;
+        double start = std::max(ssp[i].distance, ref);
+        if (start >= end)
+            break;
+        SSP_element_packet e;
+        e.D_STATIC.rawdata = distance_value(start-prev, p->Q_SCALE);
+        e.V_STATIC.rawdata = speed_value(ssp[i].speed);
+        e.Q_FRONT.rawdata = Q_FRONT_t::TrainLengthDelay;
+        e.N_ITER.rawdata = 0;
+        elements.push_back(e);
+        prev = start;
+    }
+    SSP_element_packet eop;
+    eop.D_STATIC.rawdata = distance_value(end-prev, p->Q_SCALE);
+    eop.V_STATIC.rawdata = V_STATIC_t::EndOfProfile;
+    eop.Q_FRONT.rawdata = Q_FRONT_t::TrainLengthDelay;
+    eop.N_ITER.rawdata = 0;
+    elements.push_back(eop);
+    p->element = elements[0];
+    p->elements.assign(elements.begin()+1, elements.end());
+    p->N_ITER.rawdata = p->elements.size();
+    return p;
+}
+static std::shared_ptr<GradientProfile> build_gradient(const std::vector<gradient_element> &gradients, double ref, double end, uint32_t q_dir)
+{
+    auto p = std::make_shared<GradientProfile>();
+    p->NID_PACKET.rawdata = 21;
+    p->Q_DIR.rawdata = q_dir;
+    p->Q_SCALE.rawdata = distance_scale(end-ref);
+    std::vector<GradientElement> elements;
+    double prev = ref;
+    for (size_t i=0; i<gradients.size(); i++) {
+        if (i+1 < gradients.size() && gradients[i+1].distance <= ref)
+            continue;
+        double start = std::max(gradients[i].distance, ref);
+        if (start >= end)
+            break;
+        GradientElement e;
+        e.D_GRADIENT.rawdata = distance_value(start-prev, p->Q_SCALE);
+        e.Q_GDIR.rawdata = gradients[i].gradient < 0 ? Q_GDIR_t::Downhill : Q_GDIR_t::Uphill;
+        e.G_A.rawdata = std::min(254, std::abs(gradients[i].gradient));
+        elements.push_back(e);
+        prev = start;
+    }
+    GradientElement eog;
+    eog.D_GRADIENT.rawdata = distance_value(end-prev, p->Q_SCALE);
+    eog.Q_GDIR.rawdata = Q_GDIR_t::Uphill;
+    eog.G_A.rawdata = G_A_t::EndOfGradient;
+    elements.push_back(eog);
+    p->element = elements[0];
+    p->elements.assign(elements.begin()+1, elements.end());
+    p->N_ITER.rawdata = p->elements.size();
+    return p;
+}
+static std::shared_ptr<TemporarySpeedRestriction> build_tsr(const tsr_element &tsr, double ref, uint32_t q_dir)
+{
+    double start = std::max(tsr.distance, ref);
+    double end = tsr.distance + tsr.length;
+    if (end <= ref)
+        return nullptr;
+    auto p = std::make_shared<TemporarySpeedRestriction>();
+    p->NID_PACKET.rawdata = 65;
+    p->Q_DIR.rawdata = q_dir;
+    p->Q_SCALE.rawdata = distance_scale(end-ref);
+    p->NID_TSR.rawdata = tsr.id;
+    p->D_TSR.rawdata = distance_value(start-ref, p->Q_SCALE);
+    p->L_TSR.rawdata = distance_value(end-start, p->Q_SCALE);
+    p->Q_FRONT.rawdata = tsr.front ? Q_FRONT_t::NoTrainLengthDelay : Q_FRONT_t::TrainLengthDelay;
+    p->V_TSR.rawdata = speed_value(tsr.speed);
+    return p;
+}
+/*
+ * NID_RADIO is a BCD number, padded with F. The mobile terminal dials
+ * the decimal value as (IPv4 address << 16) | TCP port.
+ */
+static uint64_t radio_number(const std::string &address, int port)
+{
+    uint64_t number = ((uint64_t)ntohl(inet_addr(address.c_str()))<<16) | (port & 0xffff);
+    std::string digits = std::to_string(number);
+    uint64_t bcd = 0;
+    for (int i=0; i<16; i++)
+        bcd = (bcd<<4) | (i < (int)digits.size() ? digits[i]-'0' : 15);
+    return bcd;
+}
+rbc_server::rbc_server(const rbc_scenario &scenario, int port, bool verbose) : scenario(scenario), verbose(verbose)
+{
+    listen_fd = rbc_listen(port);
+}
+void rbc_server::send(rbc_train &t, euroradio_message &msg)
+{
+    msg.T_TRAIN.rawdata = t.t_train;
+    msg.NID_LRBG.rawdata = t.position_known ? t.lrbg : NID_LRBG_t::Unknown;
+    t.conn.send(msg);
+    messages_sent++;
+    if (verbose)
+        std::cout<<"RBC: train "<<t.nid_engine<<" <- message "<<msg.NID_MESSAGE.rawdata<<std::endl;
+}
+void rbc_server::update_position(rbc_train &t, PositionReport &report)
+{
+    if (report.NID_LRBG == NID_LRBG_t::Unknown || report.D_LRBG == D_LRBG_t::Unknown)
+        return;
+    double d = report.D_LRBG.get_value(report.Q_SCALE);
+    if (report.Q_DLRBG != Q_DLRBG_t::Unknown && report.Q_DIRTRAIN != Q_DIRTRAIN_t::Unknown && report.Q_DLRBG != report.Q_DIRTRAIN)
+        d = -d;
+    int64_t now = rbc_clock();
+    auto it = t.balise_positions.find(report.NID_LRBG);
+    if (it == t.balise_positions.end()) {
+        double estimated = t.position_known ? t.front + t.speed*(now-t.report_time)/1e6 : d;
+        it = t.balise_positions.insert({report.NID_LRBG, estimated - d}).first;
+    }
+    t.lrbg = report.NID_LRBG;
+    t.q_dir = report.Q_DIRTRAIN == Q_DIRTRAIN_t::Reverse ? Q_DIR_t::Reverse : Q_DIR_t::Nominal;
+    t.front = it->second + d;
+    t.speed = report.V_TRAIN.get_value();
+    t.report_time = now;
+    t.position_known = true;
+}
+void rbc_server::send_ma(rbc_train &t)
+{
+    if (!t.position_known)
+        return;
+    if (t.ma_end < 0)
+        t.ma_end = scenario.ma_end;
+    if (scenario.extend_on_report)
+        t.ma_end = std::max(t.ma_end, t.front + scenario.ma_length);
+    double ref = t.balise_positions[t.lrbg];
+    double end = std::max(t.ma_end, ref+1);
+    MA_message ma;
+    ma.NID_MESSAGE.rawdata = 3;
+    ma.M_ACK.rawdata = scenario.ack_ma ? M_ACK_t::AcknowledgementRequired : M_ACK_t::NoAcknowledgement;
+    auto &p = *ma.MA;
+    p.NID_PACKET.rawdata = 15;
+    p.Q_DIR.rawdata = t.q_dir;
+    p.Q_SCALE.rawdata = distance_scale(end-ref);
+    p.V_EMA.rawdata = speed_value(scenario.v_ema);
+    p.T_EMA.rawdata = T_EMA_t::NoTimeout;
+    p.N_ITER.rawdata = 0;
+    p.L_ENDSECTION.rawdata = distance_value(end-ref, p.Q_SCALE);
+    p.Q_SECTIONTIMER.rawdata = 0;
+    p.Q_ENDTIMER.rawdata = 0;
+    p.Q_DANGERPOINT.rawdata = 0;
+    p.Q_OVERLAP.rawdata = 0;
+    set_packet_length(p);
+    ma.optional_packets.push_back(build_ssp(scenario.ssp, ref, end, t.q_dir));
+    ma.optional_packets.push_back(build_gradient(scenario.gradients, ref, end, t.q_dir));
+    for (auto &tsr : scenario.tsrs) {
+        auto p = build_tsr(tsr, ref, t.q_dir);
+        if (p != nullptr)
+            ma.optional_packets.push_back(p);
+    }
+    send(t, ma);
+}
+void rbc_server::send_tsr(rbc_train &t, const tsr_element &tsr)
+{
+    auto p = build_tsr(tsr, t.balise_positions[t.lrbg], t.q_dir);
+    if (p == nullptr)
+        return;
+    euroradio_message msg;
+    msg.NID_MESSAGE.rawdata = 24;
+    msg.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+    msg.optional_packets.push_back(p);
+    send(t, msg);
+}
+void rbc_server::send_handover(rbc_train &t, const handover_order &order)
+{
+    double ref = t.balise_positions[t.lrbg];
+    auto p = std::make_shared<RBCTransitionOrder>();
+    p->NID_PACKET.rawdata = 131;
+    p->Q_DIR.rawdata = t.q_dir;
+    p->Q_SCALE.rawdata = distance_scale(order.distance-ref);
+    p->D_RBCTR.rawdata = distance_value(order.distance-ref, p->Q_SCALE);
+    p->NID_C.rawdata = order.nid_c;
+    p->NID_RBC.rawdata = order.nid_rbc;
+    p->NID_RADIO.rawdata = radio_number(order.address, order.port);
+    p->Q_SLEEPSESSION.rawdata = Q_SLEEPSESSION_t::IgnoreOrder;
+    euroradio_message msg;
+    msg.NID_MESSAGE.rawdata = 24;
+    msg.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+    msg.optional_packets.push_back(p);
+    send(t, msg);
+}
+void rbc_server::run_events(rbc_train &t)
+{
+    if (!t.accepted || t.closing)
+        return;
+    int64_t elapsed = rbc_clock() - t.accepted_time;
+    while (t.next_event < scenario.events.size()) {
+        scenario_event &ev = scenario.events[t.next_event];
+        if (ev.time > elapsed)
+            break;
+        bool located = ev.type == scenario_event_type::EmergencyStop || ev.type == scenario_event_type::EmergencyStopRevocation;
+        if (!located && !t.position_known)
+            break;
+        t.next_event++;
+        switch (ev.type) {
+            case scenario_event_type::MovementAuthority:
+                t.ma_end = ev.ma_end;
+                send_ma(t);
+                break;
+            case scenario_event_type::TemporarySpeedRestriction:
+                send_tsr(t, ev.tsr);
+                break;
+            case scenario_event_type::Handover:
+                send_handover(t, ev.handover);
+                break;
+            case scenario_event_type::EmergencyStop: {
+                unconditional_emergency_stop msg;
+                msg.NID_MESSAGE.rawdata = 16;
+                msg.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+                msg.NID_EM.rawdata = ev.nid_em;
+                send(t, msg);
+                break;
+            }
+            case scenario_event_type::EmergencyStopRevocation: {
+                emergency_stop_revocation msg;
+                msg.NID_MESSAGE.rawdata = 18;
+                msg.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+                msg.NID_EM.rawdata = ev.nid_em;
+                send(t, msg);
+                break;
+            }
+        }
+    }
+}
+void rbc_server::handle_message(rbc_train &t, euroradio_message_traintotrack &msg)
+{
+    messages_received++;
+    if (verbose)
+        std::cout<<"RBC: train "<<msg.NID_ENGINE.rawdata<<" -> message "<<msg.NID_MESSAGE.rawdata<<std::endl;
+    if (!msg.valid || msg.readerror)
+        return;
+    t.nid_engine = msg.NID_ENGINE;
+    t.t_train = msg.T_TRAIN;
+    if (msg.PositionReport1BG)
+        update_position(t, **msg.PositionReport1BG);
+    switch (msg.NID_MESSAGE.rawdata) {
+        case 155: {
+            RBC_version ver;
+            ver.NID_MESSAGE.rawdata = 32;
+            ver.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+            ver.M_VERSION.rawdata = scenario.version;
+            send(t, ver);
+            break;
+        }
+        case 129: {
+            train_data_acknowledgement ack;
+            ack.NID_MESSAGE.rawdata = 8;
+            ack.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+            ack.T_TRAINack = msg.T_TRAIN;
+            send(t, ack);
+            break;
+        }
+        case 157: {
+            euroradio_message reply;
+            reply.NID_MESSAGE.rawdata = scenario.accept_train ? 41 : 40;
+            reply.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+            send(t, reply);
+            if (scenario.accept_train && !t.accepted) {
+                t.accepted = true;
+                t.accepted_time = rbc_clock();
+            }
+            break;
+        }
+        case 132:
+            send_ma(t);
+            break;
+        case 136:
+            if (scenario.extend_on_report)
+                send_ma(t);
+            break;
+        case 156: {
+            euroradio_message reply;
+            reply.NID_MESSAGE.rawdata = 39;
+            reply.M_ACK.rawdata = M_ACK_t::NoAcknowledgement;
+            send(t, reply);
+            t.closing = true;
+            break;
+        }
+        default:
+            break;
+    }
+}
+void rbc_server::run(const std::atomic<bool> &stop)
+{
+    if (listen_fd < 0)
+        return;
+    std::vector<struct pollfd> fds;
+    std::vector<unsigned char> frame;
+    while (!stop) {
+        fds.clear();
+        fds.push_back({(decltype(pollfd::fd))listen_fd, POLLIN, 0});
+        for (auto &t : trains)
+            fds.push_back({(decltype(pollfd::fd))t->conn.fd, (short)(POLLIN | (t->conn.pending_output() ? POLLOUT : 0)), 0});
+        rbc_poll(fds, 10);
+        for (size_t i=0; i+1<fds.size(); i++) {
+            rbc_train &t = *trains[i];
+            if ((fds[i+1].revents & (POLLIN | POLLERR | POLLHUP)) && !t.conn.receive()) {
+                t.conn.close();
+                continue;
+            }
+            while (t.conn.next_frame(frame)) {
+                bit_manipulator r(std::move(frame));
+                auto msg = euroradio_message_traintotrack::build(r);
+                handle_message(t, *msg);
+            }
+        }
+        for (auto &t : trains) {
+            if (t->conn.fd < 0)
+                continue;
+            run_events(*t);
+            if (!t->conn.flush() || (t->closing && !t->conn.pending_output()))
+                t->conn.close();
+        }
+        trains.erase(std::remove_if(trains.begin(), trains.end(), [this](const std::unique_ptr<rbc_train> &t) {
+            if (t->conn.fd < 0 && verbose)
+                std::cout<<"RBC: train "<<t->nid_engine<<" disconnected"<<std::endl;
+            return t->conn.fd < 0;
+        }), trains.end());
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = rbc_accept(listen_fd)) >= 0)
+                trains.push_back(std::make_unique<rbc_train>(fd));
+        }
+    }
+    for (auto &t : trains)
+        t->conn.close();
+    trains.clear();
+    rbc_connection(listen_fd).close();
+}
@@ -0,0 +1,61 @@
+/*
+ * European Train Control System
+ * Copyright (C) 2019-2023  César Benito <cesarbema2009@hotmail.com>
+ * 
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+#pragma once
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+#include "connection.h"
+#include "scenario.h"
+/*
+ * Trackside view of one train. The RBC has no track database: balise
+ * groups are placed on a single line the first time a train reports them,
+ * and every distance sent back is referred to the train's current LRBG.
+ */
+struct rbc_train
+{
+    rbc_connection conn;
+    uint32_t nid_engine = 0;
+    uint32_t t_train = 0;
+    uint32_t lrbg;
+    uint32_t q_dir = Q_DIR_t::Nominal;
+    std::map<uint32_t, double> balise_positions;
+    bool position_known = false;
+    double front = 0;
+    double speed = 0;
+    int64_t report_time = 0;
+    double ma_end = -1;
+    bool accepted = false;
+    int64_t accepted_time = 0;
+    size_t next_event = 0;
+    bool closing = false;
+    rbc_train(int fd) : conn(fd)
+    {
+        lrbg = NID_LRBG_t::Unknown;
+    }
+};
+struct rbc_server
+{
+    rbc_scenario scenario;
+    int listen_fd;
+    bool verbose;
+    std::vector<std::unique_ptr<rbc_train>> trains;
+    uint64_t messages_received = 0;
+    uint64_t messages_sent = 0;
+    rbc_server(const rbc_scenario &scenario, int port, bool verbose);
+    void run(const std::atomic<bool> &stop);
+    private:
+    void handle_message(rbc_train &t, euroradio_message_traintotrack &msg);
+    void update_position(rbc_train &t, PositionReport &report);
+    void run_events(rbc_train &t);
+    void send(rbc_train &t, euroradio_message &msg);
+    void send_ma(rbc_train &t);
+    void send_tsr(rbc_train &t, const tsr_element &tsr);
+    void send_handover(rbc_train &t, const handover_order &order);
+};